@@ -6,6 +6,7 @@ set(XEditor.Dir.SRC editor/src/)
 file(GLOB_RECURSE XEditor.File.Qt.GUI_HDR ${XEditor.Dir.SRC}widgets/*.hpp ${XEditor.Dir.SRC}windows/*.hpp)
 
 file(GLOB_RECURSE XEditor.File.Qt.SRC ${XEditor.Dir.SRC}*.cpp ${XEditor.Dir.SRC}.c)
+list(FILTER XEditor.File.Qt.SRC EXCLUDE REGEX "${XEditor.Dir.SRC}headertool/(cli|benchmark|test)/.*")
 
 qt5_wrap_cpp(XEditor.File.Qt.WRAP_CPP ${XEditor.File.Qt.GUI_HDR})
 
@@ -15,5 +16,14 @@ else ()
     add_executable(xeditor ${XEditor.File.Qt.SRC} ${XEditor.File.Qt.WRAP_CPP})
 endif ()
 
-target_include_directories(xeditor PUBLIC ${Engine.Dir.INCLUDE} ${XEditor.Dir.INCLUDE} ${XEditor.Dir.SRC})
+# Embed the header tool runtime headers which the editor copies into new projects
+set(XEditor.Dir.GENERATED ${CMAKE_CURRENT_BINARY_DIR}/generated/)
+file(READ ${XEditor.Dir.SRC}headertool/headertoolruntime.hpp TEMPLATE_HEADERTOOL_RUNTIME)
+file(READ ${XEditor.Dir.SRC}headertool/variabletype.hpp TEMPLATE_VARIABLE_TYPE)
+set_property(DIRECTORY APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS
+        ${XEditor.Dir.SRC}headertool/headertoolruntime.hpp
+        ${XEditor.Dir.SRC}headertool/variabletype.hpp)
+configure_file(cmake/templateheaders.hpp.in ${XEditor.Dir.GENERATED}project/templateheaders.hpp @ONLY)
+
+target_include_directories(xeditor PUBLIC ${Engine.Dir.INCLUDE} ${XEditor.Dir.INCLUDE} ${XEditor.Dir.SRC} ${XEditor.Dir.GENERATED})
 target_link_libraries(xeditor xengine-static Threads::Threads Qt5::Core Qt5::Widgets)
\ No newline at end of file
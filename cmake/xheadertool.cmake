@@ -0,0 +1,28 @@
+set(XHeaderTool.Dir.SRC editor/src/)
+
+# The header tool sources without the executables in the subdirectories
+file(GLOB XHeaderTool.File.SRC ${XHeaderTool.Dir.SRC}headertool/*.cpp)
+
+add_library(xheadertool-static STATIC ${XHeaderTool.File.SRC})
+target_include_directories(xheadertool-static PUBLIC ${XHeaderTool.Dir.SRC})
+target_link_libraries(xheadertool-static Threads::Threads)
+
+add_executable(xheadertool ${XHeaderTool.Dir.SRC}headertool/cli/main.cpp)
+target_link_libraries(xheadertool xheadertool-static)
+
+if (XEDITOR_BUILD_BENCHMARKS)
+    file(GLOB_RECURSE XHeaderTool.File.BENCHMARK_SRC ${XHeaderTool.Dir.SRC}headertool/benchmark/*.cpp)
+    add_executable(xheadertool-benchmark ${XHeaderTool.File.BENCHMARK_SRC})
+    target_link_libraries(xheadertool-benchmark xheadertool-static)
+endif ()
+
+if (XEDITOR_BUILD_TESTS)
+    enable_testing()
+    file(GLOB XHeaderTool.File.TEST_SRC ${XHeaderTool.Dir.SRC}headertool/test/*.cpp)
+    foreach (TEST_FILE ${XHeaderTool.File.TEST_SRC})
+        get_filename_component(TEST_NAME ${TEST_FILE} NAME_WE)
+        add_executable(xheadertool-${TEST_NAME} ${TEST_FILE})
+        target_link_libraries(xheadertool-${TEST_NAME} xheadertool-static)
+        add_test(NAME ${TEST_NAME} COMMAND xheadertool-${TEST_NAME})
+    endforeach ()
+endif ()
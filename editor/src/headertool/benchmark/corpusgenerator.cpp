@@ -0,0 +1,145 @@
+/**
+ *  xEditor - Editor and tools for creating games
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "headertool/benchmark/corpusgenerator.hpp"
+
+#include "headertool/headergenerator.hpp"
+
+#include "io/fileutil.hpp"
+
+namespace xng {
+    static const char *PRIMITIVE_TYPES[] = {"int", "float", "double", "bool", "std::string", "xng::Vector3f",
+                                            "xng::EntityName", "xng::ResourceHandle<xng::Texture>"};
+
+    static const char *COMMENT_WORDS[] = {"the", "component", "value", "is", "used", "by", "system", "when",
+                                          "update", "render", "entity", "scene", "default", "(", ")", "<", ">",
+                                          "{", "}", "=", ";", "XVARIABLE", "XCOMPONENT"};
+
+    CorpusGenerator::CorpusGenerator(Settings settings)
+            : settings(settings) {}
+
+    std::string CorpusGenerator::fileName(size_t index) {
+        return "component" + std::to_string(index) + ".hpp";
+    }
+
+    void CorpusGenerator::appendComment(std::string &output) {
+        std::uniform_real_distribution<double> chance(0, 1);
+        if (chance(random) >= settings.commentDensity) {
+            return;
+        }
+
+        // Comments contain macro names and brackets so that the tokenizer cannot skip them cheaply
+        std::uniform_int_distribution<size_t> wordCount(4, 16);
+        std::uniform_int_distribution<size_t> word(0, std::size(COMMENT_WORDS) - 1);
+        auto multiLine = chance(random) < 0.3;
+        output += multiLine ? "    /*" : "    //";
+        for (auto i = wordCount(random); i > 0; i--) {
+            output += " ";
+            output += COMMENT_WORDS[word(random)];
+            if (multiLine && i % 5 == 0) {
+                output += "\n     *";
+            }
+        }
+        output += multiLine ? " */\n" : "\n";
+    }
+
+    void CorpusGenerator::appendType(std::string &output, size_t depth) {
+        std::uniform_int_distribution<size_t> primitive(0, std::size(PRIMITIVE_TYPES) - 1);
+        std::uniform_int_distribution<size_t> nesting(0, depth);
+        if (depth == 0 || nesting(random) == 0) {
+            output += PRIMITIVE_TYPES[primitive(random)];
+            return;
+        }
+        if (random() % 2 == 0) {
+            output += "std::vector<";
+            appendType(output, depth - 1);
+        } else {
+            output += "std::map<std::string, ";
+            appendType(output, depth - 1);
+        }
+        output += ">";
+    }
+
+    std::string CorpusGenerator::generateFile(size_t index) {
+        random.seed(settings.seed + static_cast<uint32_t>(index));
+
+        auto guard = "CORPUS_COMPONENT" + std::to_string(index) + "_HPP";
+
+        std::string ret;
+        ret += "#ifndef " + guard + "\n";
+        ret += "#define " + guard + "\n\n";
+        ret += "#include \"xng/xng.hpp\"\n";
+        ret += "#include \"" + HeaderGenerator::generatedHeaderFileName(fileName(index)).string() + "\"\n\n";
+
+        for (auto component = 0u; component < settings.componentsPerFile; component++) {
+            auto typeName = "Component" + std::to_string(index) + "_" + std::to_string(component);
+
+            appendComment(ret);
+            ret += "XCOMPONENT(Category=\"Benchmark/Corpus" + std::to_string(index % 16) + "\")\n";
+            ret += "struct " + typeName + " : public xng::Component {\n";
+
+            for (auto member = 0u; member < settings.membersPerComponent; member++) {
+                auto name = "member" + std::to_string(member);
+
+                appendComment(ret);
+                switch (member % 4) {
+                    case 0:
+                        ret += "    XVARIABLE()\n";
+                        break;
+                    case 1:
+                        ret += "    XVARIABLE(Name=\"" + name + "\", Description=\"The \\\"" + name + "\\\" value\")\n";
+                        break;
+                    case 2:
+                        ret += "    XVARIABLE(Minimum=-5, Maximum=" + std::to_string(member * 10) + ")\n";
+                        break;
+                    default:
+                        break; // Members without XVARIABLE are not part of the metadata
+                }
+
+                appendComment(ret);
+                ret += "    ";
+                appendType(ret, settings.templateDepth);
+                ret += " " + name;
+                if (member % 3 == 0) {
+                    ret += " = {}";
+                }
+                ret += ";\n\n";
+            }
+
+            appendComment(ret);
+            ret += "    XGENERATED_OPERATORS()\n";
+            ret += "};\n\n";
+        }
+
+        ret += "#endif //" + guard + "\n";
+
+        return ret;
+    }
+
+    size_t CorpusGenerator::writeCorpus(const std::filesystem::path &directory) {
+        std::filesystem::create_directories(directory);
+        size_t ret = 0;
+        for (auto i = 0u; i < settings.fileCount; i++) {
+            auto source = generateFile(i);
+            FileUtil::writeIfChanged(directory / fileName(i), source);
+            ret += source.size();
+        }
+        return ret;
+    }
+}
@@ -0,0 +1,72 @@
+/**
+ *  xEditor - Editor and tools for creating games
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XENGINE_CORPUSGENERATOR_HPP
+#define XENGINE_CORPUSGENERATOR_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <random>
+#include <string>
+
+namespace xng {
+    /**
+     * Generates synthetic component headers for benchmarking the header tool.
+     *
+     * The output only depends on the settings, so that results of different runs are comparable.
+     */
+    class CorpusGenerator {
+    public:
+        struct Settings {
+            size_t fileCount = 1000;
+            size_t componentsPerFile = 2;
+            size_t membersPerComponent = 8;
+            size_t templateDepth = 1; // The maximum nesting depth of member template arguments
+            double commentDensity = 0.25; // The probability of a comment before each generated line
+            uint32_t seed = 1;
+        };
+
+        explicit CorpusGenerator(Settings settings);
+
+        /**
+         * @param index The index of the file in the corpus
+         * @return The source of the header file at index
+         */
+        std::string generateFile(size_t index);
+
+        /**
+         * Write the headers of the corpus to the directory, the directory is created if it does not exist.
+         *
+         * @return The total number of bytes written
+         */
+        size_t writeCorpus(const std::filesystem::path &directory);
+
+        static std::string fileName(size_t index);
+
+    private:
+        void appendComment(std::string &output);
+
+        void appendType(std::string &output, size_t depth);
+
+        Settings settings;
+        std::mt19937 random;
+    };
+}
+
+#endif //XENGINE_CORPUSGENERATOR_HPP
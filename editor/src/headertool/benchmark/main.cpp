@@ -0,0 +1,332 @@
+/**
+ *  xEditor - Editor and tools for creating games
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+#include "headertool/benchmark/corpusgenerator.hpp"
+#include "headertool/headergenerator.hpp"
+#include "headertool/headerparser.hpp"
+#include "headertool/headerscanner.hpp"
+#include "headertool/mappedfile.hpp"
+#include "headertool/tokenizer.hpp"
+
+static std::atomic<size_t> allocationCount = 0;
+static std::atomic<size_t> allocationBytes = 0;
+
+void *operator new(size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocationBytes.fetch_add(size, std::memory_order_relaxed);
+    if (auto *ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+static volatile size_t checksumSink = 0; // Prevents the page touching loop of the read stage from being optimized out
+
+static const char *USAGE = R"###(Usage: xheadertool-benchmark [options]
+
+Generates a synthetic header corpus and measures each stage of the header tool.
+
+Options:
+  --files <count>       The number of generated headers (default 1000)
+  --components <count>  The number of components per header (default 2)
+  --members <count>     The number of members per component (default 8)
+  --depth <count>       The maximum template nesting depth of member types (default 1)
+  --comments <ratio>    The probability of a comment before each line (default 0.25)
+  --seed <value>        The seed of the corpus generator (default 1)
+  --dir <path>          The directory to write the corpus to (default <temp>/xheadertool-benchmark)
+  -h, --help            Print this message
+)###";
+
+/**
+ * Reset the peak resident set size so that the peak of the next stage can be measured.
+ *
+ * Only supported on linux, on other platforms the reported peak is the peak of the process.
+ */
+static void resetPeakRss() {
+#ifdef __linux__
+    std::ofstream fs("/proc/self/clear_refs");
+    fs << "5";
+#endif
+}
+
+/**
+ * @return The peak resident set size in bytes since the last resetPeakRss or 0 if unsupported
+ */
+static size_t getPeakRss() {
+#ifdef __linux__
+    std::ifstream fs("/proc/self/status");
+    std::string line;
+    while (std::getline(fs, line)) {
+        if (line.rfind("VmHWM:", 0) == 0) {
+            return std::stoull(line.substr(6)) * 1024;
+        }
+    }
+    return 0;
+#elif defined(__APPLE__)
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+#elif !defined(_WIN32)
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss * 1024;
+#else
+    return 0;
+#endif
+}
+
+struct StageResult {
+    std::string name;
+    double seconds = 0;
+    size_t files = 0;
+    size_t items = 0; // The number of stage specific units processed, eg. tokens
+    std::string itemName;
+    size_t allocations = 0;
+    size_t allocatedBytes = 0;
+    size_t peakRss = 0;
+};
+
+/**
+ * Accumulates the time and the allocations of a measured section of a stage.
+ */
+class Section {
+public:
+    explicit Section(StageResult &result)
+            : result(result),
+              allocationsBegin(allocationCount),
+              bytesBegin(allocationBytes),
+              begin(std::chrono::steady_clock::now()) {}
+
+    ~Section() {
+        result.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        result.allocations += allocationCount - allocationsBegin;
+        result.allocatedBytes += allocationBytes - bytesBegin;
+    }
+
+private:
+    StageResult &result;
+    size_t allocationsBegin;
+    size_t bytesBegin;
+    std::chrono::steady_clock::time_point begin;
+};
+
+/**
+ * Run a stage, only the work inside the sections created by the stage is measured
+ * so that preparation work such as tokenizing the input of the parser is excluded.
+ */
+static StageResult measure(const std::string &name,
+                           const std::string &itemName,
+                           size_t files,
+                           const std::function<void(StageResult &result)> &stage) {
+    StageResult ret;
+    ret.name = name;
+    ret.itemName = itemName;
+    ret.files = files;
+
+    resetPeakRss();
+    stage(ret);
+    ret.peakRss = getPeakRss();
+
+    return ret;
+}
+
+static void printResults(const std::vector<StageResult> &results) {
+    std::printf("%-12s %12s %14s %24s %12s %12s %12s\n",
+                "Stage", "Total ms", "us/file", "Throughput", "Allocs", "Alloc MiB", "Peak RSS MiB");
+    for (auto &result: results) {
+        auto throughput = std::to_string(static_cast<size_t>(result.items / result.seconds))
+                          + " " + result.itemName + "/s";
+        std::printf("%-12s %12.2f %14.2f %24s %12zu %12.2f %12.2f\n",
+                    result.name.c_str(),
+                    result.seconds * 1000,
+                    result.seconds * 1000000 / static_cast<double>(result.files),
+                    throughput.c_str(),
+                    result.allocations,
+                    static_cast<double>(result.allocatedBytes) / (1024 * 1024),
+                    static_cast<double>(result.peakRss) / (1024 * 1024));
+    }
+}
+
+int main(int argc, char *argv[]) {
+    xng::CorpusGenerator::Settings settings;
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "xheadertool-benchmark";
+
+    for (auto i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                throw std::runtime_error("Missing value for option " + arg);
+            }
+            return argv[++i];
+        };
+        try {
+            if (arg == "-h" || arg == "--help") {
+                std::cout << USAGE;
+                return 0;
+            } else if (arg == "--files") {
+                settings.fileCount = std::stoul(value());
+            } else if (arg == "--components") {
+                settings.componentsPerFile = std::stoul(value());
+            } else if (arg == "--members") {
+                settings.membersPerComponent = std::stoul(value());
+            } else if (arg == "--depth") {
+                settings.templateDepth = std::stoul(value());
+            } else if (arg == "--comments") {
+                settings.commentDensity = std::stod(value());
+            } else if (arg == "--seed") {
+                settings.seed = std::stoul(value());
+            } else if (arg == "--dir") {
+                directory = value();
+            } else {
+                throw std::runtime_error("Unknown option " + arg);
+            }
+        } catch (const std::exception &e) {
+            std::cerr << "xheadertool-benchmark: " << e.what() << "\n" << USAGE;
+            return 2;
+        }
+    }
+
+    try {
+        std::cout << "Generating " << settings.fileCount << " files in " << directory.string() << "\n";
+
+        // Remove the output of previous runs so that the cold scan parses every file
+        std::filesystem::remove_all(directory);
+
+        xng::CorpusGenerator generator(settings);
+        auto corpusBytes = generator.writeCorpus(directory);
+
+        std::vector<std::filesystem::path> files;
+        for (auto i = 0u; i < settings.fileCount; i++) {
+            files.emplace_back(directory / xng::CorpusGenerator::fileName(i));
+        }
+
+        std::vector<StageResult> results;
+
+        std::vector<xng::MappedFile> mappedFiles;
+        results.emplace_back(measure("read", "KiB", files.size(),
+                                     [&](StageResult &result) {
+                                         Section section(result);
+                                         mappedFiles.reserve(files.size());
+                                         size_t checksum = 0;
+                                         for (auto &file: files) {
+                                             auto &mappedFile = mappedFiles.emplace_back(file);
+                                             // Touch the pages so that the mapping cost is included
+                                             for (auto c: mappedFile.view()) {
+                                                 checksum += static_cast<unsigned char>(c);
+                                             }
+                                         }
+                                         checksumSink = checksum;
+                                         result.items = corpusBytes / 1024;
+                                     }));
+
+        xng::Tokenizer tokenizer;
+        std::vector<xng::CompactToken> tokens;
+        results.emplace_back(measure("tokenize", "tokens", files.size(),
+                                     [&](StageResult &result) {
+                                         Section section(result);
+                                         for (auto &mappedFile: mappedFiles) {
+                                             tokenizer.tokenize(mappedFile.view(), tokens);
+                                             result.items += tokens.size();
+                                         }
+                                     }));
+
+        xng::HeaderParser parser;
+        std::vector<std::vector<xng::ComponentMetadata>> metadata(files.size());
+        results.emplace_back(measure("parse", "components", files.size(),
+                                     [&](StageResult &result) {
+                                         for (auto i = 0u; i < files.size(); i++) {
+                                             auto source = mappedFiles.at(i).view();
+                                             tokenizer.tokenize(source, tokens);
+                                             Section section(result);
+                                             metadata.at(i) = parser.parseTokens(files.at(i).filename().string(),
+                                                                                 source,
+                                                                                 tokens);
+                                             result.items += metadata.at(i).size();
+                                         }
+                                     }));
+
+        xng::HeaderGenerator headerGenerator;
+        results.emplace_back(measure("generate", "KiB", files.size(),
+                                     [&](StageResult &result) {
+                                         Section section(result);
+                                         size_t outputBytes = 0;
+                                         for (auto i = 0u; i < files.size(); i++) {
+                                             outputBytes += headerGenerator.generateHeader(
+                                                     files.at(i).filename().string(),
+                                                     metadata.at(i)).size();
+                                         }
+                                         result.items = outputBytes / 1024;
+                                     }));
+
+        mappedFiles.clear();
+        metadata.clear();
+
+        // The complete scan including the file system traversal and writing the generated headers
+        xng::HeaderIndex index;
+        xng::HeaderScanner scanner;
+        for (auto name: {"scan cold", "scan warm"}) {
+            results.emplace_back(measure(name, "files", files.size(),
+                                         [&](StageResult &result) {
+                                             Section section(result);
+                                             auto scanResult = scanner.scan({directory}, index);
+                                             if (!scanResult.errors.empty()) {
+                                                 throw std::runtime_error(scanResult.errors.at(0).second);
+                                             }
+                                             result.items = scanResult.fileCount;
+                                         }));
+        }
+
+        std::cout << "Corpus: " << settings.fileCount << " files, "
+                  << settings.componentsPerFile << " components/file, "
+                  << settings.membersPerComponent << " members/component, "
+                  << "template depth " << settings.templateDepth << ", "
+                  << "comment density " << settings.commentDensity << ", "
+                  << corpusBytes / 1024 << " KiB\n\n";
+
+        printResults(results);
+    } catch (const std::exception &e) {
+        std::cerr << "xheadertool-benchmark: " << e.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,202 @@
+/**
+ *  xEditor - Editor and tools for creating games
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <string>
+
+#include "headertool/headerscanner.hpp"
+#include "headertool/headergenerator.hpp"
+
+#include "io/fileutil.hpp"
+
+static const char *USAGE = R"###(Usage: xheadertool [options] <path>...
+
+Scans the header files and directories for XCOMPONENT declarations and writes the generated headers next to the sources.
+
+Options:
+  -s, --stamp <file>    Touch the file after a successful run, used as the output of build system rules
+  -d, --depfile <file>  Write a Make/Ninja depfile with the stamp file as the target and the scanned headers as dependencies
+  -i, --index <file>    Load and store the header index in the file, unchanged headers are not parsed again
+  -m, --metadata <file> Write a C++ source file which exports the metadata of all scanned components to the plugin
+  -j, --jobs <count>    The number of worker threads, defaults to the number of hardware threads
+  -q, --quiet           Only print errors
+  -h, --help            Print this message
+)###";
+
+/**
+ * Escape the characters of a path which have a special meaning in a makefile rule.
+ */
+static std::string escapeDepfilePath(const std::string &path) {
+    std::string ret;
+    for (auto c: path) {
+        switch (c) {
+            case ' ':
+            case '#':
+            case '\\':
+                ret += '\\';
+                break;
+            case '$':
+                ret += '$';
+                break;
+            default:
+                break;
+        }
+        ret += c;
+    }
+    return ret;
+}
+
+static void createParentDirectories(const std::filesystem::path &path) {
+    if (path.has_parent_path()) {
+        std::filesystem::create_directories(path.parent_path());
+    }
+}
+
+static void writeDepfile(const std::filesystem::path &depfile,
+                         const std::filesystem::path &target,
+                         const std::vector<std::filesystem::path> &dependencies) {
+    std::string contents = escapeDepfilePath(target.generic_string()) + ":";
+    for (auto &dependency: dependencies) {
+        contents += " \\\n  " + escapeDepfilePath(dependency.generic_string());
+    }
+    contents += "\n";
+    createParentDirectories(depfile);
+    FileUtil::writeIfChanged(depfile, contents);
+}
+
+static void touch(const std::filesystem::path &path) {
+    createParentDirectories(path);
+    std::ofstream fs;
+    fs.exceptions(std::ofstream::badbit | std::ofstream::failbit);
+    fs.open(path, std::ofstream::trunc);
+    fs.close();
+}
+
+/**
+ * The command line interface of the header tool, which allows build systems to generate the component headers
+ * without running the editor.
+ */
+
+int main(int argc, char *argv[]) {
+    std::set<std::filesystem::path> paths;
+    std::filesystem::path stampPath;
+    std::filesystem::path depfilePath;
+    std::filesystem::path indexPath;
+    std::filesystem::path metadataPath;
+    unsigned int jobs = 0;
+    bool quiet = false;
+
+    for (auto i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                throw std::runtime_error("Missing value for option " + arg);
+            }
+            return argv[++i];
+        };
+        try {
+            if (arg == "-h" || arg == "--help") {
+                std::cout << USAGE;
+                return 0;
+            } else if (arg == "-s" || arg == "--stamp") {
+                stampPath = value();
+            } else if (arg == "-d" || arg == "--depfile") {
+                depfilePath = value();
+            } else if (arg == "-i" || arg == "--index") {
+                indexPath = value();
+            } else if (arg == "-m" || arg == "--metadata") {
+                metadataPath = value();
+            } else if (arg == "-j" || arg == "--jobs") {
+                jobs = std::stoul(value());
+            } else if (arg == "-q" || arg == "--quiet") {
+                quiet = true;
+            } else if (!arg.empty() && arg[0] == '-') {
+                throw std::runtime_error("Unknown option " + arg);
+            } else {
+                paths.insert(std::filesystem::absolute(arg).lexically_normal());
+            }
+        } catch (const std::exception &e) {
+            std::cerr << "xheadertool: " << e.what() << "\n" << USAGE;
+            return 2;
+        }
+    }
+
+    if (paths.empty()) {
+        std::cerr << USAGE;
+        return 2;
+    }
+
+    if (!depfilePath.empty() && stampPath.empty()) {
+        std::cerr << "xheadertool: --depfile requires --stamp\n";
+        return 2;
+    }
+
+    try {
+        xng::HeaderIndex index;
+        if (!indexPath.empty()) {
+            index.load(indexPath);
+        }
+
+        xng::HeaderScanner scanner(jobs);
+        auto result = scanner.scan(paths, index);
+
+        for (auto &error: result.errors) {
+            std::cerr << error.first.string() << ": " << error.second << "\n";
+        }
+
+        if (!quiet) {
+            std::cout << "Scanned " << result.fileCount << " files ("
+                      << result.parsedCount << " parsed), Found "
+                      << result.componentCount << " Components\n";
+        }
+
+        if (!result.errors.empty()) {
+            return 1;
+        }
+
+        if (!indexPath.empty() && index.isModified()) {
+            createParentDirectories(indexPath);
+            index.save(indexPath);
+        }
+
+        if (!metadataPath.empty()) {
+            std::vector<xng::ComponentMetadata> components;
+            for (auto &pair: result.metadata) {
+                components.emplace_back(pair.second);
+            }
+            createParentDirectories(metadataPath);
+            FileUtil::writeIfChanged(metadataPath, xng::HeaderGenerator().generateMetadataSource(components));
+        }
+
+        if (!depfilePath.empty()) {
+            writeDepfile(depfilePath, stampPath, result.files);
+        }
+
+        if (!stampPath.empty()) {
+            touch(stampPath);
+        }
+    } catch (const std::exception &e) {
+        std::cerr << "xheadertool: " << e.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
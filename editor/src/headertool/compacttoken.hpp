@@ -0,0 +1,124 @@
+/**
+ *  xEditor - Editor and tools for creating games
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XENGINE_COMPACTTOKEN_HPP
+#define XENGINE_COMPACTTOKEN_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#include "headertool/token.hpp"
+
+namespace xng {
+    /**
+     * The identifiers which are interned by the tokenizer so that the parser can compare them by integer.
+     */
+    enum TokenKeyword : uint8_t {
+        KEYWORD_NONE,
+        KEYWORD_XCOMPONENT,
+        KEYWORD_XVARIABLE,
+        KEYWORD_XGENERATED_OPERATORS,
+        KEYWORD_CATEGORY,
+        KEYWORD_NAME,
+        KEYWORD_DESCRIPTION,
+        KEYWORD_MINIMUM,
+        KEYWORD_MIN,
+        KEYWORD_MAXIMUM,
+        KEYWORD_MAX
+    };
+
+    /**
+     * @return The interned keyword of the identifier or KEYWORD_NONE
+     */
+    inline TokenKeyword lookupKeyword(std::string_view identifier) {
+        auto equals = [&identifier](const char *keyword, size_t length) {
+            return std::memcmp(identifier.data(), keyword, length) == 0;
+        };
+        switch (identifier.size()) {
+            case 3:
+                if (equals("Min", 3))
+                    return KEYWORD_MIN;
+                if (equals("Max", 3))
+                    return KEYWORD_MAX;
+                break;
+            case 4:
+                if (equals("Name", 4))
+                    return KEYWORD_NAME;
+                break;
+            case 7:
+                if (equals("Minimum", 7))
+                    return KEYWORD_MINIMUM;
+                if (equals("Maximum", 7))
+                    return KEYWORD_MAXIMUM;
+                break;
+            case 8:
+                if (equals("Category", 8))
+                    return KEYWORD_CATEGORY;
+                break;
+            case 9:
+                if (equals("XVARIABLE", 9))
+                    return KEYWORD_XVARIABLE;
+                break;
+            case 10:
+                if (equals("XCOMPONENT", 10))
+                    return KEYWORD_XCOMPONENT;
+                break;
+            case 11:
+                if (equals("Description", 11))
+                    return KEYWORD_DESCRIPTION;
+                break;
+            case 20:
+                if (equals("XGENERATED_OPERATORS", 20))
+                    return KEYWORD_XGENERATED_OPERATORS;
+                break;
+            default:
+                break;
+        }
+        return KEYWORD_NONE;
+    }
+
+    /**
+     * A fixed size token which references its value in the tokenized source buffer instead of owning a copy.
+     *
+     * The source buffer must outlive the token.
+     */
+    struct CompactToken {
+        Token::TokenType type{};
+        TokenKeyword keyword = KEYWORD_NONE;
+        uint32_t lineNumber{};
+        uint32_t offset{};
+        uint32_t length{};
+
+        CompactToken() = default;
+
+        CompactToken(Token::TokenType type, uint32_t lineNumber, uint32_t offset, uint32_t length)
+                : type(type), lineNumber(lineNumber), offset(offset), length(length) {}
+
+        std::string_view value(std::string_view source) const {
+            return source.substr(offset, length);
+        }
+
+        Token toToken(std::string_view source) const {
+            return Token(type, lineNumber, std::string(value(source)));
+        }
+    };
+}
+
+#endif //XENGINE_COMPACTTOKEN_HPP
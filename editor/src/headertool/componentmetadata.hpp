@@ -65,6 +65,7 @@ namespace xng {
         std::string typeName;
         std::vector<MemberMetadata> members;
         std::string category;
+        size_t operatorsLineNumber = 0; // The line of the XGENERATED_OPERATORS() invocation or 0 if there is none
     };
 }
 #endif //XENGINE_COMPONENTMETADATA_HPP
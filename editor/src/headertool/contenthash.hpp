@@ -0,0 +1,86 @@
+/**
+ *  xEditor - Editor and tools for creating games
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XENGINE_CONTENTHASH_HPP
+#define XENGINE_CONTENTHASH_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+namespace xng {
+    /**
+     * A fast non cryptographic 64 bit hash (MurmurHash64A) used to detect changed file contents.
+     */
+    inline uint64_t hashContent(std::string_view data, uint64_t seed = 0) {
+        const uint64_t m = 0xc6a4a7935bd1e995ULL;
+        const int r = 47;
+
+        uint64_t h = seed ^ (data.size() * m);
+
+        auto *ptr = data.data();
+        auto blocks = data.size() / 8;
+        for (size_t i = 0; i < blocks; i++, ptr += 8) {
+            uint64_t k;
+            std::memcpy(&k, ptr, 8);
+
+            k *= m;
+            k ^= k >> r;
+            k *= m;
+
+            h ^= k;
+            h *= m;
+        }
+
+        switch (data.size() & 7) {
+            case 7:
+                h ^= uint64_t(static_cast<uint8_t>(ptr[6])) << 48;
+                [[fallthrough]];
+            case 6:
+                h ^= uint64_t(static_cast<uint8_t>(ptr[5])) << 40;
+                [[fallthrough]];
+            case 5:
+                h ^= uint64_t(static_cast<uint8_t>(ptr[4])) << 32;
+                [[fallthrough]];
+            case 4:
+                h ^= uint64_t(static_cast<uint8_t>(ptr[3])) << 24;
+                [[fallthrough]];
+            case 3:
+                h ^= uint64_t(static_cast<uint8_t>(ptr[2])) << 16;
+                [[fallthrough]];
+            case 2:
+                h ^= uint64_t(static_cast<uint8_t>(ptr[1])) << 8;
+                [[fallthrough]];
+            case 1:
+                h ^= uint64_t(static_cast<uint8_t>(ptr[0]));
+                h *= m;
+                break;
+            default:
+                break;
+        }
+
+        h ^= h >> r;
+        h *= m;
+        h ^= h >> r;
+
+        return h;
+    }
+}
+
+#endif //XENGINE_CONTENTHASH_HPP
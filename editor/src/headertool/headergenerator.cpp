@@ -17,17 +17,119 @@
  *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <cctype>
+#include <cstdio>
 #include <stdexcept>
 
 #include "headertool/headergenerator.hpp"
+#include "headertool/contenthash.hpp"
+#include "headertool/variabletype.hpp"
+#include "headertool/metadatablob.hpp"
 
 namespace xng {
-    std::string HeaderGenerator::generateHeader(const ComponentMetadata &metadata) {
-        std::string ret = R"###(// Contents generated by xng header tool (https://github.com/vetux/xng).
+    /**
+     * @return The file name with all characters that are not valid in an identifier replaced by underscores
+     */
+    static std::string getIdentifier(const std::string &fileName) {
+        std::string ret = fileName;
+        for (auto &c: ret) {
+            if (!std::isalnum(static_cast<unsigned char>(c))) {
+                c = '_';
+            }
+        }
+        return ret;
+    }
 
-#undef XGENERATED_OPERATORS
+    /**
+     * The schema hash changes when a member is added, removed, renamed, reordered or changes its type.
+     */
+    static uint64_t getSchemaHash(const ComponentMetadata &metadata) {
+        std::string schema = metadata.typeName + "{";
+        for (auto &member: metadata.members) {
+            schema += member.type.fullTypeName() + " " + member.instanceName + ";";
+        }
+        schema += "}";
+        return hashContent(schema);
+    }
+
+    static std::string formatHash(uint64_t hash) {
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "0x%016llxULL", static_cast<unsigned long long>(hash));
+        return buffer;
+    }
+
+    /**
+     * @return The value as a C string literal
+     */
+    static std::string quote(const std::string &value) {
+        std::string ret = "\"";
+        for (auto c: value) {
+            if (c == '"' || c == '\\') {
+                ret += '\\';
+            }
+            ret += c;
+        }
+        ret += "\"";
+        return ret;
+    }
+
+    /**
+     * @return The contents of a string literal token without the quotes, escape sequences are kept
+     */
+    static std::string unquote(const std::string &literal) {
+        if (literal.size() >= 2 && literal.front() == '"' && literal.back() == '"') {
+            return literal.substr(1, literal.size() - 2);
+        }
+        return literal;
+    }
 
-#define XGENERATED_OPERATORS() virtual xng::Messageable &operator<<(const xng::Message &message) override { \
+    static std::string generateLimit(const Token &token) {
+        if (token.type == Token::LITERAL_NUMERIC) {
+            return "true, " + token.value;
+        }
+        return "false, 0";
+    }
+
+    static std::string generateDescriptors(const ComponentMetadata &metadata) {
+        auto fieldCount = std::to_string(metadata.members.size());
+        std::string ret = "static constexpr std::array<xng::generated::FieldDescriptor, " + fieldCount
+                          + R"###(> getFieldDescriptors() { \
+        XGENERATED_BEGIN_OFFSETOF \
+        return {{ \
+)###";
+        for (auto &member: metadata.members) {
+            auto typeName = member.type.fullTypeName();
+            ret += "                {" + quote(member.instanceName)
+                   + ", " + quote(typeName)
+                   + ", \"" + unquote(member.displayName) + "\""
+                   + ", \"" + unquote(member.description) + "\""
+                   + ", " + quote(member.defaultValue)
+                   + ", offsetof(" + metadata.typeName + ", " + member.instanceName + ")"
+                   + ", sizeof(" + typeName + ")"
+                   + ", xng::" + getVariableTypeName(getVariableType(member.type.typeName))
+                   + ", " + generateLimit(member.minimum)
+                   + ", " + generateLimit(member.maximum)
+                   + R"###(}, \
+)###";
+        }
+        ret += R"###(        }}; \
+        XGENERATED_END_OFFSETOF \
+} \
+static const xng::generated::ComponentDescriptor &getComponentDescriptor() { \
+        static constexpr auto fields = getFieldDescriptors(); \
+)###";
+        ret += "        static const xng::generated::ComponentDescriptor descriptor{" + quote(metadata.typeName)
+               + ", \"" + unquote(metadata.category) + "\""
+               + R"###(, binarySchemaHash, fields.data(), fields.size()}; \
+        return descriptor; \
+}
+)###";
+        return ret;
+    }
+
+    static std::string generateOperators(const std::string &macroName, const ComponentMetadata &metadata) {
+        std::string ret = "// " + metadata.typeName + "\n";
+        ret += "#define " + macroName + R"###( virtual xng::Messageable &operator<<(const xng::Message &message) override { \
 )###";
 
         // Deserializers
@@ -53,8 +155,100 @@ virtual xng::Message &operator>>(xng::Message &message) const override { \
 )###";
         }
 
-        ret += "        return message; \\\n}\n";
+        ret += R"###(        return message; \
+} \
+)###";
+
+        // Binary serializers
+        auto fieldCount = std::to_string(metadata.members.size());
+        ret += "static constexpr uint64_t binarySchemaHash = " + formatHash(getSchemaHash(metadata)) + R"###(; \
+void serializeBinary(xng::generated::BinaryOutput &output) const { \
+)###";
+        ret += "        output.writeHeader(binarySchemaHash, " + fieldCount + R"###(); \
+)###";
+        for (auto &member: metadata.members) {
+            ret += "        output.writeField(" + member.instanceName + R"###(); \
+)###";
+        }
+        ret += R"###(} \
+bool deserializeBinary(xng::generated::BinaryInput &input) { \
+)###";
+        ret += "        if (!input.readHeader(binarySchemaHash, " + fieldCount + R"###()) \
+            return false; \
+)###";
+        for (auto &member: metadata.members) {
+            ret += "        input.readField(" + member.instanceName + R"###(); \
+)###";
+        }
+        ret += R"###(        return true; \
+} \
+)###";
+
+        // Reflection tables
+        ret += generateDescriptors(metadata);
+
+        return ret;
+    }
+
+    std::string HeaderGenerator::generateHeader(const std::string &fileName,
+                                                const std::vector<ComponentMetadata> &components) {
+        auto macroPrefix = "XGENERATED_OPERATORS_" + getIdentifier(fileName) + "_";
+
+        // XGENERATED_OPERATORS() expands to the operators of the component declared at the line of the invocation.
+        std::string ret = R"###(// Contents generated by xng header tool (https://github.com/vetux/xng).
+
+#include "headertool/headertoolruntime.hpp"
+
+#ifndef XGENERATED_JOIN
+#define XGENERATED_JOIN_IMPL(a, b) a##b
+#define XGENERATED_JOIN(a, b) XGENERATED_JOIN_IMPL(a, b)
+#endif
+
+#undef XGENERATED_OPERATORS
+)###";
+        ret += "#define XGENERATED_OPERATORS() XGENERATED_JOIN(" + macroPrefix + ", __LINE__)\n";
+
+        for (auto &metadata: components) {
+            if (metadata.operatorsLineNumber == 0) {
+                continue;
+            }
+            ret += "\n";
+            ret += generateOperators(macroPrefix + std::to_string(metadata.operatorsLineNumber), metadata);
+        }
+
+        return ret;
+    }
+
+    std::string HeaderGenerator::generateMetadataSource(const std::vector<ComponentMetadata> &components) {
+        auto blob = MetadataBlob::serialize(components);
+
+        std::string ret = R"###(// Contents generated by xng header tool (https://github.com/vetux/xng).
+
+#include <cstddef>
+
+#ifndef EXPORT
+#define EXPORT
+#endif
+
+static const unsigned char componentMetadata[] = {)###";
+
+        static const char *HEX_DIGITS = "0123456789abcdef";
+        for (auto i = 0u; i < blob.size(); i++) {
+            auto byte = static_cast<unsigned char>(blob[i]);
+            ret += i % 16 == 0 ? "\n    " : " ";
+            ret += "0x";
+            ret += HEX_DIGITS[byte >> 4];
+            ret += HEX_DIGITS[byte & 0xF];
+            ret += ",";
+        }
+
+        ret += "\n};\n\n";
+        ret += "extern \"C\" EXPORT const unsigned char *" + std::string(MetadataBlob::SYMBOL_NAME) + R"###((size_t *size) {
+    *size = sizeof(componentMetadata);
+    return componentMetadata;
+}
+)###";
 
         return ret;
     }
-}
\ No newline at end of file
+}
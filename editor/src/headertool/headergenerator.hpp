@@ -21,13 +21,45 @@
 #define XENGINE_HEADERGENERATOR_HPP
 
 #include <string>
+#include <filesystem>
+#include <vector>
 
 #include "headertool/componentmetadata.hpp"
 
 namespace xng {
     class HeaderGenerator {
     public:
-        std::string generateHeader(const ComponentMetadata &metadata);
+        /**
+         * @param filename The filename of the source file containing the component declarations
+         * @return The filename of the generated header, eg. component.hpp -> component.generated.hpp
+         */
+        static std::filesystem::path generatedHeaderFileName(const std::filesystem::path &filename) {
+            auto name = filename;
+            return name.replace_extension().string() + ".generated" + filename.extension().string();
+        }
+
+        /**
+         * Generate the header for all components declared in a source file.
+         *
+         * XGENERATED_OPERATORS() is defined to dispatch on __LINE__ so that every component in the file
+         * receives its own operators, the generated header must therefore be the last generated header that is included
+         * before the component declarations.
+         *
+         * @param fileName The filename of the source file, used to make the generated macro names unique
+         * @param components The components declared in the source file
+         * @return The contents of the generated header
+         */
+        std::string generateHeader(const std::string &fileName, const std::vector<ComponentMetadata> &components);
+
+        /**
+         * Generate a C++ source file which exports the metadata of all components as a MetadataBlob.
+         *
+         * The source is compiled into the project plugin.
+         *
+         * @param components The components of all scanned files
+         * @return The contents of the generated source file
+         */
+        std::string generateMetadataSource(const std::vector<ComponentMetadata> &components);
     };
 }
 
@@ -0,0 +1,131 @@
+/**
+ *  xEditor - Editor and tools for creating games
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "headertool/headerindex.hpp"
+
+#include "headertool/mappedfile.hpp"
+#include "headertool/metadataserializer.hpp"
+
+#include "io/binaryio.hpp"
+#include "io/fileutil.hpp"
+
+namespace xng {
+    static const uint32_t INDEX_MAGIC = 0x58484958; // XHIX
+
+    bool HeaderIndex::load(const std::filesystem::path &file) {
+        clear();
+        modified = false;
+
+        if (!std::filesystem::exists(file)) {
+            return false;
+        }
+
+        try {
+            MappedFile data(file);
+            BinaryReader reader(data.view());
+            if (reader.read<uint32_t>() != INDEX_MAGIC
+                || reader.read<uint32_t>() != VERSION) {
+                return false;
+            }
+            MetadataSerializer serializer;
+            auto count = reader.readVarInt();
+            for (auto i = 0u; i < count; i++) {
+                auto path = reader.readString();
+                HeaderIndexEntry entry;
+                entry.fileSize = reader.read<uint64_t>();
+                entry.modificationTime = reader.read<int64_t>();
+                entry.contentHash = reader.read<uint64_t>();
+                entry.components = serializer.deserialize(reader);
+                entries[path] = std::move(entry);
+            }
+        } catch (const std::exception &e) {
+            clear();
+            return false;
+        }
+
+        return true;
+    }
+
+    void HeaderIndex::save(const std::filesystem::path &file) {
+        std::string buffer;
+        BinaryWriter writer(buffer);
+        MetadataSerializer serializer;
+
+        writer.write<uint32_t>(INDEX_MAGIC);
+        writer.write<uint32_t>(VERSION);
+        writer.writeVarInt(entries.size());
+        for (auto &pair: entries) {
+            writer.writeString(pair.first);
+            writer.write<uint64_t>(pair.second.fileSize);
+            writer.write<int64_t>(pair.second.modificationTime);
+            writer.write<uint64_t>(pair.second.contentHash);
+            serializer.serialize(writer, pair.second.components);
+        }
+
+        std::filesystem::create_directories(file.parent_path());
+
+        FileUtil::writeAtomic(file, buffer);
+
+        modified = false;
+    }
+
+    const HeaderIndexEntry *HeaderIndex::find(const std::filesystem::path &source) const {
+        auto it = entries.find(source.string());
+        if (it == entries.end()) {
+            return nullptr;
+        } else {
+            return &it->second;
+        }
+    }
+
+    void HeaderIndex::set(const std::filesystem::path &source, HeaderIndexEntry entry) {
+        entries[source.string()] = std::move(entry);
+        modified = true;
+    }
+
+    void HeaderIndex::retain(const std::set<std::filesystem::path> &sources) {
+        for (auto it = entries.begin(); it != entries.end();) {
+            if (sources.find(it->first) == sources.end()) {
+                it = entries.erase(it);
+                modified = true;
+            } else {
+                it++;
+            }
+        }
+    }
+
+    void HeaderIndex::remove(const std::filesystem::path &path) {
+        for (auto it = entries.begin(); it != entries.end();) {
+            auto relative = std::filesystem::path(it->first).lexically_relative(path);
+            if (!relative.empty() && *relative.begin() != "..") {
+                it = entries.erase(it);
+                modified = true;
+            } else {
+                it++;
+            }
+        }
+    }
+
+    void HeaderIndex::clear() {
+        if (!entries.empty()) {
+            modified = true;
+        }
+        entries.clear();
+    }
+}
@@ -0,0 +1,112 @@
+/**
+ *  xEditor - Editor and tools for creating games
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XENGINE_HEADERINDEX_HPP
+#define XENGINE_HEADERINDEX_HPP
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <filesystem>
+
+#include "headertool/componentmetadata.hpp"
+
+namespace xng {
+    /**
+     * The fingerprint of a scanned file and the component metadata that was parsed from it.
+     */
+    struct HeaderIndexEntry {
+        uint64_t fileSize = 0;
+        int64_t modificationTime = 0;
+        uint64_t contentHash = 0;
+        std::vector<ComponentMetadata> components;
+    };
+
+    /**
+     * Persistent index of scanned source files which allows the scanner to skip files that did not change.
+     *
+     * A file whose size and modification time match its entry is not read at all,
+     * a file whose content hash matches its entry is not parsed.
+     */
+    class HeaderIndex {
+    public:
+        /**
+         * Increment when the index layout or the parser output changes to discard previously written indices.
+         */
+        static const uint32_t VERSION = 2;
+
+        /**
+         * Load the index from the file.
+         * If the file does not exist, is corrupted or was written by a different version the index is cleared.
+         *
+         * @param file
+         * @return True if the index was loaded
+         */
+        bool load(const std::filesystem::path &file);
+
+        /**
+         * Write the index to the file by writing to a temporary file and renaming it.
+         *
+         * @param file
+         */
+        void save(const std::filesystem::path &file);
+
+        /**
+         * @param source
+         * @return The entry for the source file or nullptr if the file is not indexed
+         */
+        const HeaderIndexEntry *find(const std::filesystem::path &source) const;
+
+        void set(const std::filesystem::path &source, HeaderIndexEntry entry);
+
+        /**
+         * Remove the entries of all files which are not contained in sources.
+         *
+         * @param sources
+         */
+        void retain(const std::set<std::filesystem::path> &sources);
+
+        /**
+         * Remove the entry of the file or the entries of all files in the directory.
+         *
+         * @param path
+         */
+        void remove(const std::filesystem::path &path);
+
+        void clear();
+
+        /**
+         * @return True if the index was changed since the last load() or save()
+         */
+        bool isModified() const {
+            return modified;
+        }
+
+        const std::map<std::string, HeaderIndexEntry> &getEntries() const {
+            return entries;
+        }
+
+    private:
+        std::map<std::string, HeaderIndexEntry> entries;
+        bool modified = false;
+    };
+}
+
+#endif //XENGINE_HEADERINDEX_HPP
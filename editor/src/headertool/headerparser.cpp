@@ -19,37 +19,76 @@
 
 #include "headertool/headerparser.hpp"
 
+#include <limits>
 #include <stdexcept>
 #include <vector>
 #include <string>
 
 namespace xng {
-    size_t findToken(size_t begin,
-                     size_t end,
-                     const std::vector<Token> &tokens,
-                     Token::TokenType type,
-                     const std::string &value) {
-        for (auto it = begin; it < end; it++) {
-            auto token = tokens.at(it);
-            if (token.type == type && token.value == value) {
-                return it;
-            }
+    static const char *ERROR_TOKEN_TYPE = "Token type error";
+    static const char *ERROR_EOF = "Unexpected EOF";
+    static const char *ERROR_COMPONENT_BODY = "Expected component body";
+
+    static const uint32_t NO_MATCH = std::numeric_limits<uint32_t>::max();
+
+    /**
+     * The state of parsing a single file.
+     *
+     * The parser operates on the indices of the non comment tokens so that comments are allowed anywhere between
+     * the header tool macros and the declarations.
+     * Every opening bracket stores the index of its closing bracket in the match table,
+     * which allows the parser to skip over nested scopes without scanning for the closing bracket.
+     */
+    class ParseContext {
+    public:
+        ParseContext(const std::string &fileName,
+                     std::string_view source,
+                     const std::vector<CompactToken> &tokens,
+                     std::vector<uint32_t> &code,
+                     std::vector<uint32_t> &matches)
+                : fileName(fileName), source(source), tokens(tokens), code(code), matches(matches) {}
+
+        size_t size() const {
+            return code.size();
         }
-        return end;
-    }
 
-    size_t findToken(size_t begin,
-                     size_t end,
-                     const std::vector<Token> &tokens,
-                     Token::TokenType type) {
-        for (auto it = begin; it < end; it++) {
-            auto token = tokens.at(it);
-            if (token.type == type) {
-                return it;
+        const CompactToken &at(size_t index) const {
+            return tokens[code[index]];
+        }
+
+        bool is(size_t index, Token::TokenType type) const {
+            return index < code.size() && at(index).type == type;
+        }
+
+        /**
+         * @return The index of the closing bracket of the opening bracket at index or NO_MATCH
+         */
+        uint32_t match(size_t index) const {
+            return matches[index];
+        }
+
+        std::string_view value(size_t index) const {
+            return at(index).value(source);
+        }
+
+        [[noreturn]] void error(size_t index, const char *msg) const {
+            size_t lineNumber = 0;
+            if (index < code.size()) {
+                lineNumber = at(index).lineNumber;
+            } else if (!code.empty()) {
+                lineNumber = at(code.size() - 1).lineNumber;
             }
+            throw SyntaxException(fileName, lineNumber, msg);
         }
-        return end;
-    }
+
+        const std::string &fileName;
+        std::string_view source;
+
+    private:
+        const std::vector<CompactToken> &tokens;
+        const std::vector<uint32_t> &code;
+        const std::vector<uint32_t> &matches;
+    };
 
     /**
      * Argument values must be either string or numeric literals.
@@ -58,301 +97,348 @@ namespace xng {
      *          lhs  |  rhs
      */
     struct MacroArgument {
-        Token lhs;
-        Token rhs;
-
-        MacroArgument() = default;
-
-        MacroArgument(Token lhs, Token rhs) : lhs(std::move(lhs)), rhs(std::move(rhs)) {}
+        const CompactToken *lhs;
+        const CompactToken *rhs;
     };
 
-    void syntaxErrorCallback(const std::string &fileName, size_t lineNumber, const std::string &msg) {
-        throw SyntaxException(fileName, lineNumber, msg);
-    }
-
-    static const char *ERROR_TOKEN_TYPE = "Token type error";
-    static const char *ERROR_EOF = "Unexpected EOF";
-
-    size_t parseMacro(const std::string &fileName,
-                      const std::vector<Token> &tokens,
-                      size_t begin,
-                      std::vector<MacroArgument> &arguments) {
+    /**
+     * Parse the arguments of the macro invocation at begin.
+     *
+     * @return The index of the closing bracket of the invocation
+     */
+    template<typename Callback>
+    size_t parseMacro(const ParseContext &context, size_t begin, Callback &&callback) {
         auto bracketOpen = begin + 1;
-        auto bracketClose = findToken(bracketOpen + 1, tokens.size(), tokens, Token::BRACKET_CLOSE);
-
-        auto diff = bracketClose - bracketOpen - 1;
-        if (diff > 3) {
-            // Iterate commas
-            size_t lastComma = 0;
-            for (auto comma = findToken(bracketOpen, bracketClose, tokens, Token::COMMA);
-                 comma < bracketClose;
-                 comma += 1,
-                         comma = findToken(comma, bracketClose, tokens, Token::COMMA)) {
-                lastComma = comma;
-
-                if (comma <= bracketOpen + 3) {
-                    continue;
-                }
+        if (!context.is(bracketOpen, Token::BRACKET_OPEN)) {
+            context.error(begin, ERROR_TOKEN_TYPE);
+        }
 
-                auto ident = tokens.at(comma - 3);
-                auto equals = tokens.at(comma - 2);
-                auto val = tokens.at(comma - 1);
-
-                if (ident.type != Token::IDENTIFIER
-                    || equals.type != Token::EQUAL_SIGN
-                    || (val.type != Token::LITERAL_STRING
-                        && val.type != Token::LITERAL_NUMERIC)) {
-                    syntaxErrorCallback(fileName,
-                                        ident.lineNumber,
-                                        ERROR_TOKEN_TYPE);
-                }
+        auto bracketClose = context.match(bracketOpen);
+        if (bracketClose == NO_MATCH) {
+            context.error(begin, ERROR_EOF);
+        }
 
-                arguments.emplace_back(MacroArgument(ident, val));
-            }
+        // A single token between the brackets is ignored, eg. the variadic parameter of the macro definition.
+        if (bracketClose - bracketOpen <= 2) {
+            return bracketClose;
+        }
 
-            auto ident = tokens.at(lastComma + 1);
-            auto equals = tokens.at(lastComma + 2);
-            auto val = tokens.at(lastComma + 3);
-
-            if (ident.type != Token::IDENTIFIER
-                || equals.type != Token::EQUAL_SIGN
-                || (val.type != Token::LITERAL_STRING
-                    && val.type != Token::LITERAL_NUMERIC)) {
-                syntaxErrorCallback(fileName,
-                                    ident.lineNumber,
-                                    ERROR_TOKEN_TYPE);
+        for (auto it = bracketOpen + 1; it < bracketClose; it += 4) {
+            if (it + 2 >= bracketClose
+                || context.at(it).type != Token::IDENTIFIER
+                || context.at(it + 1).type != Token::EQUAL_SIGN
+                || (context.at(it + 2).type != Token::LITERAL_STRING
+                    && context.at(it + 2).type != Token::LITERAL_NUMERIC)
+                || (it + 3 < bracketClose && context.at(it + 3).type != Token::COMMA)) {
+                context.error(it, ERROR_TOKEN_TYPE);
             }
+            callback(MacroArgument{&context.at(it), &context.at(it + 2)});
+        }
 
-            arguments.emplace_back(MacroArgument(ident, val));
-        } else if (diff > 1) {
-            auto ident = tokens.at(bracketOpen + 1);
-            auto equals = tokens.at(bracketOpen + 2);
-            auto val = tokens.at(bracketOpen + 3);
-
-            if (ident.type != Token::IDENTIFIER
-                || equals.type != Token::EQUAL_SIGN
-                || (val.type != Token::LITERAL_STRING
-                    && val.type != Token::LITERAL_NUMERIC)) {
-                syntaxErrorCallback(fileName,
-                                    ident.lineNumber,
-                                    ERROR_TOKEN_TYPE);
-            }
+        return bracketClose;
+    }
 
-            arguments.emplace_back(MacroArgument(ident, val));
+    /**
+     * @return The index of the first token at or after begin which is a top level token of type or end
+     */
+    size_t skipTo(const ParseContext &context, size_t begin, size_t end, Token::TokenType type) {
+        auto it = begin;
+        while (it < end) {
+            auto &token = context.at(it);
+            if (token.type == type) {
+                break;
+            }
+            auto match = context.match(it);
+            if (match != NO_MATCH && match < end) {
+                it = match + 1;
+            } else {
+                it++;
+            }
         }
-        return bracketClose;
+        return it;
     }
 
     /**
      * Parse a type with optional template specification.
      *
-     * @param fileName
-     * @param tokens
-     * @param begin
-     * @param typeName
-     * @param arguments
-     * @return The index of the last token belonging to the type
+     * @return The index of the first token after the type
      */
-    size_t parseType(const std::string &fileName,
+    size_t parseType(const ParseContext &context,
                      size_t begin,
                      size_t end,
-                     const std::vector<Token> &tokens,
                      ComponentMetadata::TypeMetadata &typeMetadata) {
-        if (begin >= tokens.size())
-            return begin;
+        if (begin >= end) {
+            context.error(begin, ERROR_EOF);
+        }
 
         // Parse top level typename
-        auto typeToken = tokens.at(begin);
-
-        if (typeToken.type != Token::IDENTIFIER) {
-            syntaxErrorCallback(fileName,
-                                typeToken.lineNumber,
-                                ERROR_TOKEN_TYPE);
+        if (context.at(begin).type != Token::IDENTIFIER) {
+            context.error(begin, ERROR_TOKEN_TYPE);
         }
 
-        typeMetadata.typeName = typeToken.value;
+        typeMetadata.typeName = context.value(begin);
 
         auto tempOpen = begin + 1;
-        auto tempClose = tempOpen;
-
-        if (tempOpen <= tokens.size()
-            && tokens.at(tempOpen).type == Token::LESS_THAN) {
-            // Type is template type
-            auto scope = 0;
-            for (auto i = tempOpen + 1; i < end; i++) {
-                if (tokens.at(i).type == Token::LESS_THAN) {
-                    scope++;
-                } else if (tokens.at(i).type == Token::GREATER_THAN) {
-                    if (scope == 0) {
-                        tempClose = i + 1;
-                        break;
-                    } else {
-                        scope--;
-                    }
-                }
-            }
+        if (tempOpen >= end || context.at(tempOpen).type != Token::LESS_THAN) {
+            return tempOpen;
+        }
 
-            auto tempTokens = tempClose - tempOpen - 2;
+        // Type is template type
+        auto tempClose = context.match(tempOpen);
+        if (tempClose == NO_MATCH || tempClose >= end) {
+            context.error(tempOpen, ERROR_EOF);
+        }
 
-            if (tempTokens == 1) {
-                // Single argument
-                ComponentMetadata::TypeMetadata tempMetadata;
+        // Parse the types between the commas
+        for (auto it = tempOpen + 1; it < tempClose;) {
+            ComponentMetadata::TypeMetadata tempMetadata;
+            auto typeEnd = parseType(context, it, tempClose, tempMetadata);
+            typeMetadata.templateArguments.emplace_back(std::move(tempMetadata));
 
-                // Parse typename
-                auto tempTypeToken = tokens.at(tempOpen + 1);
+            // Tokens after the argument type such as pointer declarators are not part of the metadata
+            it = skipTo(context, typeEnd, tempClose, Token::COMMA) + 1;
+        }
 
-                if (tempTypeToken.type != Token::IDENTIFIER) {
-                    syntaxErrorCallback(fileName,
-                                        tempTypeToken.lineNumber,
-                                        ERROR_TOKEN_TYPE);
-                }
+        return tempClose + 1;
+    }
 
-                tempMetadata.typeName = tempTypeToken.value;
-                typeMetadata.templateArguments.emplace_back(tempMetadata);
-            } else if (tempTokens > 1) {
-                // Multiple arguments
-                // Iterate commas between brackets
-                size_t lastComma = tempOpen;
-                for (auto comma = findToken(tempOpen, tempClose, tokens, Token::COMMA);
-                     comma < tempClose;
-                     lastComma = comma,
-                     comma += 1,
-                     comma = findToken(comma, tempClose, tokens, Token::COMMA)) {
-                    // Parse the type between the commas
-                    ComponentMetadata::TypeMetadata tempMetadata;
-                    parseType(fileName, lastComma + 1, comma, tokens, tempMetadata);
-                    typeMetadata.templateArguments.emplace_back(tempMetadata);
-                }
-                // Parse the type between the last comma and tempClose
-                ComponentMetadata::TypeMetadata tempMetadata;
-                parseType(fileName, lastComma + 1, tempClose, tokens, tempMetadata);
-                typeMetadata.templateArguments.emplace_back(tempMetadata);
+    /**
+     * Parse the XVARIABLE invocation at begin and the following member declaration.
+     *
+     * @return The index of the last token belonging to the member declaration
+     */
+    size_t parseMember(const ParseContext &context,
+                       size_t begin,
+                       size_t componentEnd,
+                       ComponentMetadata &componentMetadata) {
+        ComponentMetadata::MemberMetadata member;
+
+        auto bracketClose = parseMacro(context, begin, [&context, &member](const MacroArgument &arg) {
+            switch (arg.lhs->keyword) {
+                case KEYWORD_NAME:
+                    member.displayName = arg.rhs->value(context.source);
+                    break;
+                case KEYWORD_DESCRIPTION:
+                    member.description = arg.rhs->value(context.source);
+                    break;
+                case KEYWORD_MINIMUM:
+                case KEYWORD_MIN:
+                    member.minimum = arg.rhs->toToken(context.source);
+                    break;
+                case KEYWORD_MAXIMUM:
+                case KEYWORD_MAX:
+                    member.maximum = arg.rhs->toToken(context.source);
+                    break;
+                default:
+                    break;
             }
+        });
+
+        // Parse variable type
+        auto typeEnd = parseType(context, bracketClose + 1, componentEnd, member.type);
+
+        // Check instance name
+        auto instanceName = typeEnd;
+        if (instanceName >= componentEnd || context.at(instanceName).type != Token::IDENTIFIER) {
+            return typeEnd - 1;
         }
 
-        return tempClose;
+        member.instanceName = context.value(instanceName);
+
+        // Check assignment
+        auto last = instanceName;
+        auto assign = instanceName + 1;
+        if (assign < componentEnd && context.at(assign).type == Token::EQUAL_SIGN) {
+            // Parse default value
+            auto assignmentEnd = skipTo(context, assign + 1, componentEnd, Token::SEMICOLON);
+            for (auto i = assign + 1; i < assignmentEnd; i++) {
+                member.defaultValue += context.value(i);
+            }
+            last = assignmentEnd;
+        }
+
+        componentMetadata.members.emplace_back(std::move(member));
+
+        return last;
     }
 
     std::vector<ComponentMetadata> HeaderParser::parseTokens(const std::string &fileName,
                                                              const std::vector<Token> &tokens) {
+        // Rebuild a source buffer for the owning tokens so that they can be parsed as compact tokens.
+        std::string source;
+        std::vector<CompactToken> compactTokens;
+        compactTokens.reserve(tokens.size());
+        for (auto &token: tokens) {
+            auto &compactToken = compactTokens.emplace_back(token.type,
+                                                            static_cast<uint32_t>(token.lineNumber),
+                                                            static_cast<uint32_t>(source.size()),
+                                                            static_cast<uint32_t>(token.value.size()));
+            if (token.type == Token::IDENTIFIER) {
+                compactToken.keyword = lookupKeyword(token.value);
+            }
+            source += token.value;
+        }
+        return parseTokens(fileName, source, compactTokens);
+    }
+
+    void HeaderParser::buildMatchTable(const std::vector<CompactToken> &tokens) {
+        code.clear();
+        matches.clear();
+        for (auto i = 0u; i < tokens.size(); i++) {
+            if (tokens[i].type != Token::COMMENT) {
+                code.emplace_back(i);
+            }
+        }
+        matches.resize(code.size(), NO_MATCH);
+
+        roundStack.clear();
+        squareStack.clear();
+        curlyStack.clear();
+        angleStack.clear();
+
+        auto close = [this](std::vector<uint32_t> &stack, uint32_t index) {
+            if (!stack.empty()) {
+                matches[stack.back()] = index;
+                stack.pop_back();
+            }
+        };
+
+        // Angle brackets are ambiguous with the comparison operators,
+        // an unmatched less than sign is discarded when the enclosing scope or statement ends.
+        auto discardAngles = [this](uint32_t scopeBegin) {
+            while (!angleStack.empty() && angleStack.back() > scopeBegin) {
+                angleStack.pop_back();
+            }
+        };
+        auto scopeBegin = [this](const std::vector<uint32_t> &stack) -> uint32_t {
+            return stack.empty() ? 0 : stack.back();
+        };
+
+        for (auto i = 0u; i < code.size(); i++) {
+            switch (tokens[code[i]].type) {
+                case Token::BRACKET_OPEN:
+                    roundStack.emplace_back(i);
+                    break;
+                case Token::BRACKET_CLOSE:
+                    discardAngles(scopeBegin(roundStack));
+                    close(roundStack, i);
+                    break;
+                case Token::SQUARE_BRACKET_OPEN:
+                    squareStack.emplace_back(i);
+                    break;
+                case Token::SQUARE_BRACKET_CLOSE:
+                    discardAngles(scopeBegin(squareStack));
+                    close(squareStack, i);
+                    break;
+                case Token::CURLY_BRACKET_OPEN:
+                    angleStack.clear();
+                    curlyStack.emplace_back(i);
+                    break;
+                case Token::CURLY_BRACKET_CLOSE:
+                    angleStack.clear();
+                    close(curlyStack, i);
+                    break;
+                case Token::SEMICOLON:
+                    angleStack.clear();
+                    break;
+                case Token::LESS_THAN:
+                    angleStack.emplace_back(i);
+                    break;
+                case Token::GREATER_THAN:
+                    close(angleStack, i);
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+
+    std::vector<ComponentMetadata> HeaderParser::parseTokens(const std::string &fileName,
+                                                             std::string_view source,
+                                                             const std::vector<CompactToken> &tokens) {
+        buildMatchTable(tokens);
+
+        ParseContext context(fileName, source, tokens, code, matches);
+
         std::vector<ComponentMetadata> ret;
 
-        // Iterate all XCOMPONENT identifiers
-        for (auto componentBegin = findToken(0, tokens.size(), tokens, Token::IDENTIFIER, "XCOMPONENT");
-             componentBegin < tokens.size();
-             componentBegin += 1,
-                     componentBegin = findToken(componentBegin,
-                                                tokens.size(),
-                                                tokens,
-                                                Token::IDENTIFIER,
-                                                "XCOMPONENT")) {
-            ComponentMetadata componentMetadata;
-
-            // Parse XCOMPONENT macro arguments
-            std::vector<MacroArgument> macroArgs;
-            auto bracketClose = parseMacro(fileName, tokens, componentBegin, macroArgs);
-            if (!macroArgs.empty()) {
-                auto arg = macroArgs.at(0);
-                if (arg.lhs.value == "Category") {
-                    componentMetadata.category = arg.rhs.value;
-                }
+        // The components whose body contains the current token, the innermost component is the last element.
+        struct OpenComponent {
+            size_t index;
+            size_t end;
+        };
+        std::vector<OpenComponent> components;
+
+        for (size_t it = 0; it < context.size(); it++) {
+            while (!components.empty() && it >= components.back().end) {
+                components.pop_back();
             }
 
-            // Parse typename
-            auto typeName = bracketClose + 2;
-            if (typeName >= tokens.size()) {
-                syntaxErrorCallback(fileName,
-                                    tokens.at(componentBegin).lineNumber,
-                                    ERROR_EOF);
-            } else if (tokens.at(typeName).type == Token::IDENTIFIER) {
-                componentMetadata.typeName = tokens.at(typeName).value;
-            } else {
-                syntaxErrorCallback(fileName,
-                                    tokens.at(componentBegin).lineNumber,
-                                    ERROR_TOKEN_TYPE);
+            auto &token = context.at(it);
+            if (token.type != Token::IDENTIFIER) {
+                continue;
             }
 
-            // Find the component type closing brackets
-            auto componentEnd = typeName + 1;
-            auto scope = 0;
-            for (auto &i = componentEnd; i < tokens.size(); i++) {
-                if (tokens.at(i).type == Token::CURLY_BRACKET_OPEN) {
-                    scope++;
-                } else if (tokens.at(i).type == Token::CURLY_BRACKET_CLOSE) {
-                    scope--;
-                    if (scope == 0) {
-                        componentEnd = i;
+            switch (token.keyword) {
+                case KEYWORD_XCOMPONENT: {
+                    // Skip the macro definition in headertoolmacros.hpp
+                    if (it > 0 && context.value(it - 1) == "#define") {
                         break;
                     }
-                }
-            }
 
-            // Iterate all XVARIABLE identifiers in the component range
-            for (auto varBegin = findToken(componentBegin, componentEnd, tokens, Token::IDENTIFIER, "XVARIABLE");
-                 varBegin < componentEnd;
-                 varBegin += 1,
-                         varBegin = findToken(varBegin,
-                                              componentEnd,
-                                              tokens,
-                                              Token::IDENTIFIER,
-                                              "XVARIABLE")) {
-                ComponentMetadata::MemberMetadata member;
-
-                std::vector<MacroArgument> varMacroArgs;
-                auto varBracketCloseIndex = parseMacro(fileName, tokens, varBegin, varMacroArgs);
-
-                for (auto &arg: varMacroArgs) {
-                    if (arg.lhs.value == "Name") {
-                        member.displayName = arg.rhs.value;
-                    } else if (arg.lhs.value == "Description") {
-                        member.description = arg.rhs.value;
-                    } else if (arg.lhs.value == "Minimum" || arg.lhs.value == "Min") {
-                        member.minimum = arg.rhs;
-                    } else if (arg.lhs.value == "Maximum" || arg.lhs.value == "Max") {
-                        member.maximum = arg.rhs;
+                    ComponentMetadata componentMetadata;
+
+                    // Parse XCOMPONENT macro arguments
+                    auto bracketClose = parseMacro(context, it, [&context, &componentMetadata](const MacroArgument &arg) {
+                        if (arg.lhs->keyword == KEYWORD_CATEGORY) {
+                            componentMetadata.category = arg.rhs->value(context.source);
+                        }
+                    });
+
+                    // Parse typename, the token before it is the class key
+                    auto typeName = bracketClose + 2;
+                    if (typeName >= context.size()) {
+                        context.error(it, ERROR_EOF);
+                    } else if (context.at(typeName).type != Token::IDENTIFIER) {
+                        context.error(it, ERROR_TOKEN_TYPE);
+                    }
+                    componentMetadata.typeName = context.value(typeName);
+
+                    // Find the component body, the base clause may contain template arguments
+                    auto bodyOpen = skipTo(context, typeName + 1, context.size(), Token::CURLY_BRACKET_OPEN);
+                    auto declarationEnd = skipTo(context, typeName + 1, bodyOpen, Token::SEMICOLON);
+                    if (declarationEnd < bodyOpen) {
+                        context.error(declarationEnd, ERROR_COMPONENT_BODY);
+                    } else if (bodyOpen >= context.size() || context.match(bodyOpen) == NO_MATCH) {
+                        context.error(it, ERROR_EOF);
                     }
-                }
 
-                // Parse variable type
-                auto varTypeBegin = varBracketCloseIndex + 1;
+                    components.emplace_back(OpenComponent{ret.size(), context.match(bodyOpen)});
+                    ret.emplace_back(std::move(componentMetadata));
 
-                if (varBracketCloseIndex >= tokens.size()
-                    || varTypeBegin >= tokens.size()) {
-                    syntaxErrorCallback(fileName,
-                                        tokens.at(varBegin).lineNumber,
-                                        ERROR_EOF);
+                    // Continue with the contents of the body
+                    it = bodyOpen;
+                    break;
                 }
-
-                ComponentMetadata::TypeMetadata typeMetadata;
-                auto varTypeEnd = parseType(fileName, varTypeBegin, componentEnd, tokens, typeMetadata);
-
-                member.type = typeMetadata;
-
-                // Check instance name
-                auto varInstanceName = varTypeEnd;
-                if (varInstanceName < componentEnd && tokens.at(varInstanceName).type == Token::IDENTIFIER) {
-                    member.instanceName = tokens.at(varInstanceName).value;
-
-                    // Check assignment
-                    auto varAssign = varInstanceName + 1;
-                    if (varAssign < componentEnd && tokens.at(varAssign).type == Token::EQUAL_SIGN) {
-                        // Parse default value
-                        auto assignmentBegin = varAssign + 1;
-                        auto assignmentEnd = findToken(assignmentBegin, componentEnd, tokens, Token::SEMICOLON);
-                        std::string defVal;
-                        for (auto i = assignmentBegin; i < assignmentEnd; i++) {
-                            defVal += tokens.at(i).value;
+                case KEYWORD_XVARIABLE:
+                    if (!components.empty()) {
+                        auto &component = components.back();
+                        it = parseMember(context, it, component.end, ret.at(component.index));
+                    }
+                    break;
+                case KEYWORD_XGENERATED_OPERATORS:
+                    if (!components.empty()) {
+                        auto &componentMetadata = ret.at(components.back().index);
+                        if (componentMetadata.operatorsLineNumber == 0) {
+                            componentMetadata.operatorsLineNumber = token.lineNumber;
                         }
-                        member.defaultValue = defVal;
                     }
-
-                    componentMetadata.members.emplace_back(member);
-                }
+                    break;
+                default:
+                    break;
             }
-
-            ret.emplace_back(componentMetadata);
         }
 
         return ret;
     }
-}
\ No newline at end of file
+}
@@ -21,10 +21,13 @@
 #define XENGINE_HEADERPARSER_HPP
 
 #include <vector>
+#include <cstdint>
 #include <functional>
+#include <string_view>
 
 #include "headertool/componentmetadata.hpp"
 #include "headertool/token.hpp"
+#include "headertool/compacttoken.hpp"
 #include "headertool/syntaxexception.hpp"
 
 namespace xng {
@@ -39,6 +42,36 @@ namespace xng {
          */
         std::vector<ComponentMetadata> parseTokens(const std::string &fileName,
                                                    const std::vector<Token> &tokens);
+
+        /**
+         * Parse the list of compact tokens returned by Tokenizer::tokenize(std::string_view, ...).
+         *
+         * Header tool keywords are compared by their interned id instead of by string.
+         *
+         * @param fileName The string describing the source of the tokens, Used when building SyntaxExceptions
+         * @param source The source buffer which the tokens reference
+         * @param tokens The list of tokens to parse
+         * @return
+         */
+        std::vector<ComponentMetadata> parseTokens(const std::string &fileName,
+                                                   std::string_view source,
+                                                   const std::vector<CompactToken> &tokens);
+
+    private:
+        /**
+         * Collect the indices of the non comment tokens and match every opening bracket with its closing bracket.
+         *
+         * The buffers are reused between files so that parsing does not allocate once they have grown.
+         */
+        void buildMatchTable(const std::vector<CompactToken> &tokens);
+
+        std::vector<uint32_t> code;
+        std::vector<uint32_t> matches;
+
+        std::vector<uint32_t> roundStack;
+        std::vector<uint32_t> squareStack;
+        std::vector<uint32_t> curlyStack;
+        std::vector<uint32_t> angleStack;
     };
 }
 #endif //XENGINE_HEADERPARSER_HPP
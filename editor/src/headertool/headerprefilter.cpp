@@ -0,0 +1,115 @@
+/**
+ *  xEditor - Editor and tools for creating games
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "headertool/headerprefilter.hpp"
+
+#include <array>
+#include <bit>
+#include <cstring>
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+namespace xng {
+    static const std::array<std::string_view, 8> headerExtensions = {
+            ".h",
+            ".hh",
+            ".hpp",
+            ".hxx",
+            ".h++",
+            ".inl",
+            ".ipp",
+            ".tpp"
+    };
+
+    static bool matchesAt(const char *data, std::string_view needle) {
+        // The first and last characters have already been compared
+        return std::memcmp(data + 1, needle.data() + 1, needle.size() - 2) == 0;
+    }
+
+    bool HeaderPrefilter::isCandidateFile(const std::filesystem::path &path) {
+        auto extension = path.extension().string();
+        bool isHeader = false;
+        for (auto &ext: headerExtensions) {
+            if (extension == ext) {
+                isHeader = true;
+                break;
+            }
+        }
+        if (!isHeader) {
+            return false;
+        }
+        // Skip generated headers eg. component.generated.hpp
+        return path.stem().extension() != ".generated";
+    }
+
+    bool HeaderPrefilter::mayContainComponents(std::string_view source) {
+        return contains(source, "XCOMPONENT");
+    }
+
+    bool HeaderPrefilter::contains(std::string_view haystack, std::string_view needle) {
+        if (needle.size() < 2 || haystack.size() < needle.size()) {
+            return haystack.find(needle) != std::string_view::npos;
+        }
+
+        // Compare the first and last character of the needle against a block of candidate positions
+        // and only compare the full needle at positions where both match.
+        auto *data = haystack.data();
+        auto lastOffset = needle.size() - 1;
+        size_t i = 0;
+
+#if defined(__AVX2__)
+        const auto first = _mm256_set1_epi8(needle.front());
+        const auto last = _mm256_set1_epi8(needle.back());
+        for (; i + lastOffset + 32 <= haystack.size(); i += 32) {
+            auto blockFirst = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+            auto blockLast = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i + lastOffset));
+            auto eq = _mm256_and_si256(_mm256_cmpeq_epi8(first, blockFirst), _mm256_cmpeq_epi8(last, blockLast));
+            auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(eq));
+            while (mask != 0) {
+                auto bit = std::countr_zero(mask);
+                if (matchesAt(data + i + bit, needle)) {
+                    return true;
+                }
+                mask &= mask - 1;
+            }
+        }
+#elif defined(__SSE2__) || defined(_M_X64)
+        const auto first = _mm_set1_epi8(needle.front());
+        const auto last = _mm_set1_epi8(needle.back());
+        for (; i + lastOffset + 16 <= haystack.size(); i += 16) {
+            auto blockFirst = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+            auto blockLast = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i + lastOffset));
+            auto eq = _mm_and_si128(_mm_cmpeq_epi8(first, blockFirst), _mm_cmpeq_epi8(last, blockLast));
+            auto mask = static_cast<uint32_t>(_mm_movemask_epi8(eq));
+            while (mask != 0) {
+                auto bit = std::countr_zero(mask);
+                if (matchesAt(data + i + bit, needle)) {
+                    return true;
+                }
+                mask &= mask - 1;
+            }
+        }
+#endif
+
+        // Remaining bytes or platforms without SSE2
+        return haystack.substr(i).find(needle) != std::string_view::npos;
+    }
+}
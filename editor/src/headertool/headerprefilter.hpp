@@ -0,0 +1,57 @@
+/**
+ *  xEditor - Editor and tools for creating games
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XENGINE_HEADERPREFILTER_HPP
+#define XENGINE_HEADERPREFILTER_HPP
+
+#include <filesystem>
+#include <string_view>
+
+namespace xng {
+    /**
+     * Rejects files that cannot contain component declarations before they are tokenized.
+     */
+    class HeaderPrefilter {
+    public:
+        /**
+         * @param path
+         * @return True if the file has a header extension and is not a generated header
+         */
+        static bool isCandidateFile(const std::filesystem::path &path);
+
+        /**
+         * Search the source for the XCOMPONENT macro name in a single pass.
+         *
+         * @param source
+         * @return False if the source cannot contain a component declaration
+         */
+        static bool mayContainComponents(std::string_view source);
+
+        /**
+         * Vectorized substring search.
+         *
+         * @param haystack
+         * @param needle Must not be empty
+         * @return True if needle is contained in haystack
+         */
+        static bool contains(std::string_view haystack, std::string_view needle);
+    };
+}
+
+#endif //XENGINE_HEADERPREFILTER_HPP
@@ -0,0 +1,330 @@
+/**
+ *  xEditor - Editor and tools for creating games
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "headertool/headerscanner.hpp"
+
+#include <algorithm>
+
+#include "headertool/mappedfile.hpp"
+#include "headertool/contenthash.hpp"
+#include "headertool/headerprefilter.hpp"
+#include "headertool/tokenizer.hpp"
+#include "headertool/headerparser.hpp"
+#include "headertool/headergenerator.hpp"
+
+#include "io/fileutil.hpp"
+
+namespace xng {
+    struct HeaderScanner::ScanJob {
+        std::filesystem::path path;
+        HeaderIndexEntry entry;
+        const HeaderIndexEntry *indexEntry = nullptr;
+        bool parsed = false;
+        bool failed = false;
+        std::string error;
+    };
+
+    /**
+     * Write the aggregated generated header of the source file if the file contains components.
+     *
+     * If the file no longer contains components an existing generated header is replaced with one without operators,
+     * so that stale operators are not compiled and build systems which declared it as an output still find it.
+     *
+     * The file is only written when its contents changed so that build systems do not recompile the dependents.
+     */
+    static void writeGeneratedHeader(HeaderGenerator &generator,
+                                     const std::filesystem::path &path,
+                                     const std::vector<ComponentMetadata> &components) {
+        auto generatedPath = path.parent_path() / HeaderGenerator::generatedHeaderFileName(path.filename());
+        if (components.empty() && !std::filesystem::exists(generatedPath))
+            return;
+        FileUtil::writeIfChanged(generatedPath, generator.generateHeader(path.filename().string(), components));
+    }
+
+    struct ScanWorker {
+        Tokenizer tokenizer;
+        HeaderParser parser;
+        HeaderGenerator generator;
+        std::vector<CompactToken> tokens;
+
+        void run(HeaderScanner::ScanJob &job) {
+            MappedFile file(job.path);
+            if (!HeaderPrefilter::mayContainComponents(file.view())) {
+                // The file cannot declare components, it is not hashed because there is nothing to reuse.
+                job.entry.contentHash = 0;
+                job.entry.components.clear();
+                writeGeneratedHeader(generator, job.path, job.entry.components);
+                return;
+            }
+
+            job.entry.contentHash = hashContent(file.view());
+            if (job.indexEntry != nullptr && job.indexEntry->contentHash == job.entry.contentHash) {
+                // File was touched but the contents did not change
+                job.entry.components = job.indexEntry->components;
+            } else {
+                job.parsed = true;
+                tokenizer.tokenize(file.view(), tokens);
+                job.entry.components = parser.parseTokens(job.path.filename().string(), file.view(), tokens);
+            }
+
+            writeGeneratedHeader(generator, job.path, job.entry.components);
+        }
+    };
+
+    static void addFile(std::vector<HeaderScanner::ScanJob> &files, const std::filesystem::directory_entry &dirEntry) {
+        if (!HeaderPrefilter::isCandidateFile(dirEntry.path()))
+            return;
+        auto &job = files.emplace_back();
+        job.path = dirEntry.path();
+        job.entry.fileSize = dirEntry.file_size();
+        job.entry.modificationTime = dirEntry.last_write_time().time_since_epoch().count();
+    }
+
+    /**
+     * Record the result of the job in the scan result and update its index entry if the file changed.
+     *
+     * @return False if the file failed to scan
+     */
+    static bool mergeJob(HeaderScanner::ScanJob &job, HeaderIndex &index, HeaderScanner::Result &result) {
+        if (job.failed) {
+            result.errors.emplace_back(job.path, job.error);
+            return false;
+        }
+        if (job.parsed) {
+            result.parsedCount++;
+        }
+        if (job.indexEntry == nullptr
+            || job.indexEntry->fileSize != job.entry.fileSize
+            || job.indexEntry->modificationTime != job.entry.modificationTime) {
+            index.set(job.path, job.entry);
+        }
+        return true;
+    }
+
+    HeaderScanner::HeaderScanner(unsigned int threadCount)
+            : threadCount(threadCount) {
+        if (this->threadCount == 0) {
+            this->threadCount = std::max(1u, std::thread::hardware_concurrency());
+        }
+    }
+
+    HeaderScanner::Result HeaderScanner::scan(const std::set<std::filesystem::path> &paths,
+                                              HeaderIndex &index) {
+        cancelled = false;
+        totalFiles = 0;
+        processedFiles = 0;
+
+        Result ret;
+
+        // Collect the files and their fingerprints
+        std::vector<ScanJob> files;
+        for (auto &path: paths) {
+            try {
+                std::filesystem::directory_entry pathEntry(path);
+                if (!pathEntry.is_directory()) {
+                    addFile(files, pathEntry);
+                    continue;
+                }
+                for (auto &dirEntry: std::filesystem::recursive_directory_iterator(path)) {
+                    if (cancelled) {
+                        ret.cancelled = true;
+                        return ret;
+                    }
+                    if (dirEntry.is_directory())
+                        continue;
+                    addFile(files, dirEntry);
+                }
+            } catch (const std::exception &e) {
+                ret.errors.emplace_back(path, e.what());
+            }
+        }
+
+        std::sort(files.begin(), files.end(), [](const ScanJob &lhs, const ScanJob &rhs) {
+            return lhs.path < rhs.path;
+        });
+        files.erase(std::unique(files.begin(), files.end(), [](const ScanJob &lhs, const ScanJob &rhs) {
+            return lhs.path == rhs.path;
+        }), files.end());
+
+        processJobs(files, index, ret);
+
+        if (cancelled) {
+            ret.cancelled = true;
+            return ret;
+        }
+
+        // Merge the results in path order
+        std::set<std::filesystem::path> sourceFiles;
+        ret.fileCount = files.size();
+        for (auto &job: files) {
+            sourceFiles.insert(job.path);
+            ret.files.emplace_back(job.path);
+            if (!mergeJob(job, index, ret))
+                continue;
+            for (auto &metadata: job.entry.components) {
+                ret.metadata[metadata.typeName] = metadata;
+                ret.componentCount++;
+            }
+        }
+
+        index.retain(sourceFiles);
+
+        return ret;
+    }
+
+    HeaderScanner::Result HeaderScanner::scanChanges(const std::set<std::filesystem::path> &modified,
+                                                     const std::set<std::filesystem::path> &removed,
+                                                     HeaderIndex &index) {
+        cancelled = false;
+        totalFiles = 0;
+        processedFiles = 0;
+
+        Result ret;
+
+        // The index is only updated if the scan is not cancelled
+        std::vector<std::filesystem::path> removedFiles(removed.begin(), removed.end());
+
+        std::vector<ScanJob> files;
+        for (auto &path: modified) {
+            if (!HeaderPrefilter::isCandidateFile(path))
+                continue;
+            std::error_code error;
+            std::filesystem::directory_entry entry(path, error);
+            if (error || !entry.is_regular_file(error)) {
+                removedFiles.emplace_back(path); // The file was removed again after the change was reported
+                continue;
+            }
+            try {
+                addFile(files, entry);
+            } catch (const std::exception &e) {
+                ret.errors.emplace_back(path, e.what());
+            }
+        }
+
+        processJobs(files, index, ret);
+
+        if (cancelled) {
+            ret.cancelled = true;
+            return ret;
+        }
+
+        for (auto &path: removedFiles) {
+            index.remove(path);
+        }
+
+        for (auto &job: files) {
+            mergeJob(job, index, ret);
+        }
+
+        // The index contains the entries of all files in the source paths
+        for (auto &pair: index.getEntries()) {
+            ret.files.emplace_back(pair.first);
+            for (auto &metadata: pair.second.components) {
+                ret.metadata[metadata.typeName] = metadata;
+                ret.componentCount++;
+            }
+        }
+        ret.fileCount = index.getEntries().size();
+
+        return ret;
+    }
+
+    void HeaderScanner::processJobs(std::vector<ScanJob> &files, HeaderIndex &index, Result &result) {
+        // Skip the files which did not change since they were last scanned
+        HeaderGenerator generator;
+        std::vector<size_t> pending;
+        for (auto i = 0u; i < files.size(); i++) {
+            auto &job = files.at(i);
+            job.indexEntry = index.find(job.path);
+            if (job.indexEntry != nullptr
+                && job.indexEntry->fileSize == job.entry.fileSize
+                && job.indexEntry->modificationTime == job.entry.modificationTime) {
+                job.entry = *job.indexEntry;
+                if (!job.entry.components.empty()
+                    && !std::filesystem::exists(job.path.parent_path()
+                                                / HeaderGenerator::generatedHeaderFileName(job.path.filename()))) {
+                    // The generated header was deleted, it is restored from the indexed metadata without parsing
+                    try {
+                        writeGeneratedHeader(generator, job.path, job.entry.components);
+                    } catch (const std::exception &e) {
+                        result.errors.emplace_back(job.path, e.what());
+                    }
+                }
+            } else {
+                pending.emplace_back(i);
+            }
+        }
+
+        totalFiles = pending.size();
+
+        // Scan the changed files on the worker threads
+        std::atomic<size_t> nextJob = 0;
+        auto work = [this, &files, &pending, &nextJob]() {
+            ScanWorker worker;
+            for (auto i = nextJob++; i < pending.size() && !cancelled; i = nextJob++) {
+                auto &job = files.at(pending.at(i));
+                try {
+                    worker.run(job);
+                } catch (const std::exception &e) {
+                    job.failed = true;
+                    job.error = e.what();
+                }
+                processedFiles++;
+            }
+        };
+
+        auto workerCount = std::min<size_t>(threadCount, pending.size());
+        if (workerCount > 1) {
+            std::vector<std::thread> threads;
+            for (auto i = 0u; i < workerCount; i++) {
+                threads.emplace_back(work);
+            }
+            for (auto &thread: threads) {
+                thread.join();
+            }
+        } else {
+            work();
+        }
+    }
+
+    bool HeaderScanner::containsNewerFiles(const std::set<std::filesystem::path> &paths,
+                                           std::filesystem::file_time_type time) {
+        try {
+            for (auto &path: paths) {
+                std::filesystem::directory_entry pathEntry(path);
+                if (!pathEntry.is_directory()) {
+                    if (HeaderPrefilter::isCandidateFile(path) && pathEntry.last_write_time() > time)
+                        return true;
+                    continue;
+                }
+                if (pathEntry.last_write_time() > time)
+                    return true;
+                for (auto &dirEntry: std::filesystem::recursive_directory_iterator(path)) {
+                    // A newer directory means files were added, removed or renamed
+                    if ((dirEntry.is_directory() || HeaderPrefilter::isCandidateFile(dirEntry.path()))
+                        && dirEntry.last_write_time() > time)
+                        return true;
+                }
+            }
+        } catch (const std::exception &e) {
+            return true;
+        }
+        return false;
+    }
+}
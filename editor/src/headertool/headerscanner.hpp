@@ -0,0 +1,127 @@
+/**
+ *  xEditor - Editor and tools for creating games
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XENGINE_HEADERSCANNER_HPP
+#define XENGINE_HEADERSCANNER_HPP
+
+#include <atomic>
+#include <filesystem>
+#include <map>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "headertool/componentmetadata.hpp"
+#include "headertool/headerindex.hpp"
+
+namespace xng {
+    /**
+     * Scans source directories or files for component declarations and writes the generated headers.
+     *
+     * Only header files that contain the XCOMPONENT macro name are tokenized, see HeaderPrefilter.
+     *
+     * Files are tokenized, parsed and generated on a pool of worker threads,
+     * the results are merged in path order so that the output does not depend on the scheduling.
+     */
+    class HeaderScanner {
+    public:
+        struct Result {
+            std::map<std::string, ComponentMetadata> metadata; // The merged metadata of all scanned files
+            std::vector<std::filesystem::path> files; // The scanned header files in path order
+            std::vector<std::pair<std::filesystem::path, std::string>> errors; // The files that failed to scan
+            size_t fileCount = 0; // The number of header files in the source paths
+            size_t parsedCount = 0; // The number of files that were parsed
+            size_t componentCount = 0;
+            bool cancelled = false; // If true the scan was cancelled and the index was not updated
+        };
+
+        struct ScanJob; // The state of a single file during a scan
+
+        /**
+         * @param threadCount The number of worker threads, 0 uses the number of hardware threads
+         */
+        explicit HeaderScanner(unsigned int threadCount = 0);
+
+        /**
+         * Scan all header files in the source paths.
+         *
+         * Files whose index entry matches are not parsed, the index is updated with the results of the scan.
+         * Index entries of files which are not contained in the source paths are removed.
+         *
+         * @param paths The directories to scan recursively or individual header files
+         * @param index
+         * @return
+         */
+        Result scan(const std::set<std::filesystem::path> &paths, HeaderIndex &index);
+
+        /**
+         * Update the index with a set of changed files, eg. reported by a FileWatcher, without walking the source paths.
+         *
+         * The index must contain the entries of all files in the source paths, eg. from a previous scan(),
+         * the result contains the metadata of all indexed files.
+         *
+         * @param modified The created or modified files, files which are not headers are ignored
+         * @param removed The removed files or directories
+         * @param index
+         * @return
+         */
+        Result scanChanges(const std::set<std::filesystem::path> &modified,
+                           const std::set<std::filesystem::path> &removed,
+                           HeaderIndex &index);
+
+        /**
+         * Check if any header file in the source paths was modified after the time point without reading the files.
+         *
+         * @param paths The directories to check recursively or individual header files
+         * @param time The time point to compare the modification times against
+         * @return True if a header file or directory was modified after time or a path could not be checked
+         */
+        static bool containsNewerFiles(const std::set<std::filesystem::path> &paths,
+                                       std::filesystem::file_time_type time);
+
+        /**
+         * Cancel a running scan, Can be called from any thread.
+         */
+        void cancel() {
+            cancelled = true;
+        }
+
+        size_t getTotalFiles() const {
+            return totalFiles;
+        }
+
+        size_t getProcessedFiles() const {
+            return processedFiles;
+        }
+
+    private:
+        /**
+         * Parse the files whose index entry does not match on the worker threads.
+         */
+        void processJobs(std::vector<ScanJob> &files, HeaderIndex &index, Result &result);
+
+        unsigned int threadCount;
+        std::atomic<bool> cancelled = false;
+        std::atomic<size_t> totalFiles = 0;
+        std::atomic<size_t> processedFiles = 0;
+    };
+}
+
+#endif //XENGINE_HEADERSCANNER_HPP
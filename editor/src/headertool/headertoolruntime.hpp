@@ -0,0 +1,353 @@
+/**
+ *  xEditor - Editor and tools for creating games
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XENGINE_HEADERTOOLRUNTIME_HPP
+#define XENGINE_HEADERTOOLRUNTIME_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "xng/xng.hpp"
+
+#include "variabletype.hpp"
+
+#if defined(__GNUC__) || defined(__clang__)
+// offsetof is conditionally supported for the non standard layout component types, it is supported by all compilers we target.
+#define XGENERATED_BEGIN_OFFSETOF _Pragma("GCC diagnostic push") _Pragma("GCC diagnostic ignored \"-Winvalid-offsetof\"")
+#define XGENERATED_END_OFFSETOF _Pragma("GCC diagnostic pop")
+#else
+#define XGENERATED_BEGIN_OFFSETOF
+#define XGENERATED_END_OFFSETOF
+#endif
+
+/**
+ * The support code of the binary serializers generated by the header tool.
+ *
+ * The encoding is little endian, integers are stored as variable length integers (zigzag encoded if signed).
+ * Every field is prefixed by the type tag of the member type,
+ * types without a dedicated encoding are stored as a Message in json.
+ */
+namespace xng::generated {
+    enum BinaryTypeTag : uint8_t {
+        TAG_BOOL = 1,
+        TAG_INTEGER,
+        TAG_FLOAT,
+        TAG_STRING,
+        TAG_VECTOR,
+        TAG_MAP,
+        TAG_URI,
+        TAG_RESOURCE_HANDLE,
+        TAG_MESSAGE,
+    };
+
+    /**
+     * The reflection data of a XVARIABLE member, generated by the header tool.
+     */
+    struct FieldDescriptor {
+        const char *name; // The instance name
+        const char *typeName; // The full type name including template arguments as written in the declaration
+        const char *displayName; // The Name argument of the XVARIABLE invocation or an empty string
+        const char *description; // The Description argument of the XVARIABLE invocation or an empty string
+        const char *defaultValue; // The source text of the default initializer or an empty string
+        size_t offset; // The offset of the member in the component
+        size_t size; // The size of the member type
+        VariableType type; // The variable type of the top level type name
+        bool hasMinimum;
+        double minimum;
+        bool hasMaximum;
+        double maximum;
+    };
+
+    /**
+     * The reflection data of a XCOMPONENT type, generated by the header tool.
+     */
+    struct ComponentDescriptor {
+        const char *typeName;
+        const char *category;
+        uint64_t schemaHash; // The schema hash of the binary serializers
+        const FieldDescriptor *fields; // The XVARIABLE members in declaration order
+        size_t fieldCount;
+    };
+
+    template<typename T>
+    struct IsVector : std::false_type {
+    };
+
+    template<typename T, typename A>
+    struct IsVector<std::vector<T, A>> : std::true_type {
+    };
+
+    template<typename T>
+    struct IsMap : std::false_type {
+    };
+
+    template<typename K, typename V, typename C, typename A>
+    struct IsMap<std::map<K, V, C, A>> : std::true_type {
+    };
+
+    template<typename T>
+    struct IsResourceHandle : std::false_type {
+    };
+
+    template<typename T>
+    struct IsResourceHandle<ResourceHandle<T>> : std::true_type {
+    };
+
+    template<typename T>
+    constexpr BinaryTypeTag getTypeTag() {
+        if constexpr (std::is_same_v<T, bool>) {
+            return TAG_BOOL;
+        } else if constexpr (std::is_integral_v<T> || std::is_enum_v<T>) {
+            return TAG_INTEGER;
+        } else if constexpr (std::is_floating_point_v<T>) {
+            return TAG_FLOAT;
+        } else if constexpr (std::is_same_v<T, std::string>) {
+            return TAG_STRING;
+        } else if constexpr (IsVector<T>::value) {
+            return TAG_VECTOR;
+        } else if constexpr (IsMap<T>::value) {
+            return TAG_MAP;
+        } else if constexpr (std::is_same_v<T, Uri>) {
+            return TAG_URI;
+        } else if constexpr (IsResourceHandle<T>::value) {
+            return TAG_RESOURCE_HANDLE;
+        } else {
+            return TAG_MESSAGE;
+        }
+    }
+
+    class BinaryOutput {
+    public:
+        explicit BinaryOutput(std::string &buffer) : buffer(buffer) {}
+
+        void writeHeader(uint64_t schemaHash, size_t fieldCount) {
+            writeFixed(schemaHash, sizeof(schemaHash));
+            writeVarInt(fieldCount);
+        }
+
+        template<typename T>
+        void writeField(const T &value) {
+            buffer.push_back(static_cast<char>(getTypeTag<T>()));
+            writeValue(value);
+        }
+
+        template<typename T>
+        void writeValue(const T &value) {
+            if constexpr (std::is_same_v<T, bool>) {
+                buffer.push_back(value ? 1 : 0);
+            } else if constexpr (std::is_enum_v<T>) {
+                writeValue(static_cast<std::underlying_type_t<T>>(value));
+            } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+                auto v = static_cast<int64_t>(value);
+                writeVarInt((static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63));
+            } else if constexpr (std::is_integral_v<T>) {
+                writeVarInt(value);
+            } else if constexpr (std::is_same_v<T, float>) {
+                uint32_t bits;
+                std::memcpy(&bits, &value, sizeof(bits));
+                writeFixed(bits, sizeof(bits));
+            } else if constexpr (std::is_floating_point_v<T>) {
+                auto v = static_cast<double>(value);
+                uint64_t bits;
+                std::memcpy(&bits, &v, sizeof(bits));
+                writeFixed(bits, sizeof(bits));
+            } else if constexpr (std::is_same_v<T, std::string>) {
+                writeString(value);
+            } else if constexpr (IsVector<T>::value) {
+                writeVarInt(value.size());
+                for (auto &element: value) {
+                    writeValue(static_cast<const typename T::value_type &>(element));
+                }
+            } else if constexpr (IsMap<T>::value) {
+                writeVarInt(value.size());
+                for (auto &pair: value) {
+                    writeValue(pair.first);
+                    writeValue(pair.second);
+                }
+            } else if constexpr (std::is_same_v<T, Uri>) {
+                writeString(value.toString());
+            } else if constexpr (IsResourceHandle<T>::value) {
+                writeString(value.getUri().toString());
+            } else {
+                Message message(Message::DICTIONARY);
+                value >> message["value"];
+                std::stringstream stream;
+                JsonProtocol().serialize(stream, message);
+                writeString(stream.str());
+            }
+        }
+
+        void writeVarInt(uint64_t value) {
+            while (value >= 0x80) {
+                buffer.push_back(static_cast<char>((value & 0x7F) | 0x80));
+                value >>= 7;
+            }
+            buffer.push_back(static_cast<char>(value));
+        }
+
+        void writeString(std::string_view value) {
+            writeVarInt(value.size());
+            buffer.append(value);
+        }
+
+    private:
+        void writeFixed(uint64_t value, size_t size) {
+            for (auto i = 0u; i < size; i++) {
+                buffer.push_back(static_cast<char>((value >> (i * 8)) & 0xFF));
+            }
+        }
+
+        std::string &buffer;
+    };
+
+    /**
+     * Throws std::runtime_error if the data is truncated or a type tag does not match the member type.
+     */
+    class BinaryInput {
+    public:
+        explicit BinaryInput(std::string_view buffer) : buffer(buffer) {}
+
+        /**
+         * @return False if the data was written by a different version of the component, the offset is not advanced.
+         */
+        bool readHeader(uint64_t schemaHash, size_t fieldCount) {
+            auto begin = offset;
+            if (buffer.size() - offset < sizeof(schemaHash)
+                || readFixed(sizeof(schemaHash)) != schemaHash
+                || readVarInt() != fieldCount) {
+                offset = begin;
+                return false;
+            }
+            return true;
+        }
+
+        template<typename T>
+        void readField(T &value) {
+            if (static_cast<BinaryTypeTag>(readBytes(1)[0]) != getTypeTag<T>()) {
+                throw std::runtime_error("Binary component field type mismatch");
+            }
+            readValue(value);
+        }
+
+        template<typename T>
+        void readValue(T &value) {
+            if constexpr (std::is_same_v<T, bool>) {
+                value = readBytes(1)[0] != 0;
+            } else if constexpr (std::is_enum_v<T>) {
+                std::underlying_type_t<T> v;
+                readValue(v);
+                value = static_cast<T>(v);
+            } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+                auto v = readVarInt();
+                value = static_cast<T>(static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1));
+            } else if constexpr (std::is_integral_v<T>) {
+                value = static_cast<T>(readVarInt());
+            } else if constexpr (std::is_same_v<T, float>) {
+                auto bits = static_cast<uint32_t>(readFixed(sizeof(uint32_t)));
+                std::memcpy(&value, &bits, sizeof(bits));
+            } else if constexpr (std::is_floating_point_v<T>) {
+                auto bits = readFixed(sizeof(uint64_t));
+                double v;
+                std::memcpy(&v, &bits, sizeof(v));
+                value = static_cast<T>(v);
+            } else if constexpr (std::is_same_v<T, std::string>) {
+                value = readString();
+            } else if constexpr (IsVector<T>::value) {
+                auto count = readVarInt();
+                value.clear();
+                for (auto i = 0u; i < count; i++) {
+                    typename T::value_type element{};
+                    readValue(element);
+                    value.emplace_back(std::move(element));
+                }
+            } else if constexpr (IsMap<T>::value) {
+                auto count = readVarInt();
+                value.clear();
+                for (auto i = 0u; i < count; i++) {
+                    typename T::key_type key{};
+                    typename T::mapped_type mapped{};
+                    readValue(key);
+                    readValue(mapped);
+                    value.emplace(std::move(key), std::move(mapped));
+                }
+            } else if constexpr (std::is_same_v<T, Uri>) {
+                value = Uri(readString().c_str());
+            } else if constexpr (IsResourceHandle<T>::value) {
+                value = T(Uri(readString().c_str()));
+            } else {
+                std::stringstream stream(readString());
+                auto message = JsonProtocol().deserialize(stream);
+                message.value("value", value);
+            }
+        }
+
+        uint64_t readVarInt() {
+            uint64_t ret = 0;
+            for (int shift = 0; shift < 64; shift += 7) {
+                auto byte = static_cast<uint8_t>(readBytes(1)[0]);
+                ret |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0) {
+                    return ret;
+                }
+            }
+            throw std::runtime_error("Invalid variable length integer");
+        }
+
+        std::string readString() {
+            return std::string(readBytes(readVarInt()));
+        }
+
+        std::string_view readBytes(size_t count) {
+            if (count > buffer.size() - offset) {
+                throw std::runtime_error("Unexpected end of binary component data");
+            }
+            auto ret = buffer.substr(offset, count);
+            offset += count;
+            return ret;
+        }
+
+        size_t getOffset() const {
+            return offset;
+        }
+
+    private:
+        uint64_t readFixed(size_t size) {
+            auto bytes = readBytes(size);
+            uint64_t ret = 0;
+            for (auto i = 0u; i < size; i++) {
+                ret |= static_cast<uint64_t>(static_cast<uint8_t>(bytes[i])) << (i * 8);
+            }
+            return ret;
+        }
+
+        std::string_view buffer;
+        size_t offset = 0;
+    };
+}
+
+#endif //XENGINE_HEADERTOOLRUNTIME_HPP
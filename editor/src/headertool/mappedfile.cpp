@@ -0,0 +1,134 @@
+/**
+ *  xEditor - Editor and tools for creating games
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "headertool/mappedfile.hpp"
+
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace xng {
+#ifdef _WIN32
+    MappedFile::MappedFile(const std::filesystem::path &path) {
+        fileHandle = CreateFileW(path.wstring().c_str(),
+                                 GENERIC_READ,
+                                 FILE_SHARE_READ,
+                                 nullptr,
+                                 OPEN_EXISTING,
+                                 FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+                                 nullptr);
+        if (fileHandle == INVALID_HANDLE_VALUE) {
+            fileHandle = nullptr;
+            throw std::runtime_error("Failed to open file: " + path.string());
+        }
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(fileHandle, &fileSize)) {
+            close();
+            throw std::runtime_error("Failed to read file size: " + path.string());
+        }
+        length = static_cast<size_t>(fileSize.QuadPart);
+        if (length == 0) {
+            return; // Empty files cannot be mapped
+        }
+        mappingHandle = CreateFileMappingW(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mappingHandle == nullptr) {
+            close();
+            throw std::runtime_error("Failed to map file: " + path.string());
+        }
+        buffer = static_cast<const char *>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+        if (buffer == nullptr) {
+            close();
+            throw std::runtime_error("Failed to map file: " + path.string());
+        }
+    }
+
+    void MappedFile::close() {
+        if (buffer != nullptr)
+            UnmapViewOfFile(buffer);
+        if (mappingHandle != nullptr)
+            CloseHandle(mappingHandle);
+        if (fileHandle != nullptr)
+            CloseHandle(fileHandle);
+        buffer = nullptr;
+        length = 0;
+        mappingHandle = nullptr;
+        fileHandle = nullptr;
+    }
+#else
+    MappedFile::MappedFile(const std::filesystem::path &path) {
+        auto fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Failed to open file: " + path.string());
+        }
+        struct stat info{};
+        if (fstat(fd, &info) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Failed to read file size: " + path.string());
+        }
+        length = static_cast<size_t>(info.st_size);
+        if (length > 0) {
+            auto *ptr = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (ptr == MAP_FAILED) {
+                ::close(fd);
+                length = 0;
+                throw std::runtime_error("Failed to map file: " + path.string());
+            }
+            madvise(ptr, length, MADV_SEQUENTIAL);
+            buffer = static_cast<const char *>(ptr);
+        }
+        ::close(fd); // The mapping stays valid after the descriptor is closed
+    }
+
+    void MappedFile::close() {
+        if (buffer != nullptr)
+            munmap(const_cast<char *>(buffer), length);
+        buffer = nullptr;
+        length = 0;
+    }
+#endif
+
+    MappedFile::~MappedFile() {
+        close();
+    }
+
+    MappedFile::MappedFile(MappedFile &&other) noexcept {
+        *this = std::move(other);
+    }
+
+    MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+        if (this != &other) {
+            close();
+            buffer = std::exchange(other.buffer, nullptr);
+            length = std::exchange(other.length, 0);
+#ifdef _WIN32
+            fileHandle = std::exchange(other.fileHandle, nullptr);
+            mappingHandle = std::exchange(other.mappingHandle, nullptr);
+#endif
+        }
+        return *this;
+    }
+}
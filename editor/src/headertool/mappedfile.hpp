@@ -0,0 +1,72 @@
+/**
+ *  xEditor - Editor and tools for creating games
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XENGINE_MAPPEDFILE_HPP
+#define XENGINE_MAPPEDFILE_HPP
+
+#include <filesystem>
+#include <string_view>
+
+namespace xng {
+    /**
+     * A read only memory mapping of a file.
+     *
+     * Throws std::runtime_error if the file cannot be opened or mapped.
+     */
+    class MappedFile {
+    public:
+        MappedFile() = default;
+
+        explicit MappedFile(const std::filesystem::path &path);
+
+        ~MappedFile();
+
+        MappedFile(const MappedFile &other) = delete;
+
+        MappedFile &operator=(const MappedFile &other) = delete;
+
+        MappedFile(MappedFile &&other) noexcept;
+
+        MappedFile &operator=(MappedFile &&other) noexcept;
+
+        const char *data() const {
+            return buffer;
+        }
+
+        size_t size() const {
+            return length;
+        }
+
+        std::string_view view() const {
+            return {buffer, length};
+        }
+
+    private:
+        void close();
+
+        const char *buffer = nullptr;
+        size_t length = 0;
+#ifdef _WIN32
+        void *fileHandle = nullptr;
+        void *mappingHandle = nullptr;
+#endif
+    };
+}
+
+#endif //XENGINE_MAPPEDFILE_HPP
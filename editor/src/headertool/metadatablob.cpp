@@ -0,0 +1,54 @@
+/**
+ *  xEditor - Editor and tools for creating games
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "headertool/metadatablob.hpp"
+
+#include <stdexcept>
+
+#include "headertool/metadataserializer.hpp"
+
+#include "io/binaryio.hpp"
+
+namespace xng {
+    static const uint32_t BLOB_MAGIC = 0x424D4358; // XCMB
+
+    const char *const MetadataBlob::SYMBOL_NAME = "xgeneratedComponentMetadata";
+
+    const uint32_t MetadataBlob::VERSION = 1;
+
+    std::string MetadataBlob::serialize(const std::vector<ComponentMetadata> &metadata) {
+        std::string ret;
+        BinaryWriter writer(ret);
+        writer.write<uint32_t>(BLOB_MAGIC);
+        writer.write<uint32_t>(VERSION);
+        MetadataSerializer().serialize(writer, metadata);
+        return ret;
+    }
+
+    std::vector<ComponentMetadata> MetadataBlob::deserialize(std::string_view data) {
+        BinaryReader reader(data);
+        if (reader.read<uint32_t>() != BLOB_MAGIC) {
+            throw std::runtime_error("Invalid component metadata blob");
+        }
+        if (reader.read<uint32_t>() != VERSION) {
+            throw std::runtime_error("Unsupported component metadata blob version");
+        }
+        return MetadataSerializer().deserialize(reader);
+    }
+}
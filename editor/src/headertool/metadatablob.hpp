@@ -0,0 +1,55 @@
+/**
+ *  xEditor - Editor and tools for creating games
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XENGINE_METADATABLOB_HPP
+#define XENGINE_METADATABLOB_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "headertool/componentmetadata.hpp"
+
+namespace xng {
+    /**
+     * The versioned binary table of component metadata which is compiled into the project plugin,
+     * so that the editor can read the metadata of an up to date plugin without parsing the sources.
+     *
+     * The plugin exports the blob through the function named by SYMBOL_NAME with the signature
+     * extern "C" const unsigned char *xgeneratedComponentMetadata(size_t *size)
+     */
+    class MetadataBlob {
+    public:
+        typedef const unsigned char *(ExportFunction)(size_t *size);
+
+        static const char *const SYMBOL_NAME;
+
+        static const uint32_t VERSION; // Must be incremented when the MetadataSerializer format changes
+
+        static std::string serialize(const std::vector<ComponentMetadata> &metadata);
+
+        /**
+         * @throws std::runtime_error if the data is not a metadata blob or was written by a different version
+         */
+        static std::vector<ComponentMetadata> deserialize(std::string_view data);
+    };
+}
+
+#endif //XENGINE_METADATABLOB_HPP
@@ -0,0 +1,96 @@
+/**
+ *  xEditor - Editor and tools for creating games
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "headertool/metadataserializer.hpp"
+
+namespace xng {
+    static void serializeToken(BinaryWriter &writer, const Token &token) {
+        writer.write<uint8_t>(token.type);
+        writer.writeVarInt(token.lineNumber);
+        writer.writeString(token.value);
+    }
+
+    static Token deserializeToken(BinaryReader &reader) {
+        Token ret;
+        ret.type = static_cast<Token::TokenType>(reader.read<uint8_t>());
+        ret.lineNumber = reader.readVarInt();
+        ret.value = reader.readString();
+        return ret;
+    }
+
+    static void serializeType(BinaryWriter &writer, const ComponentMetadata::TypeMetadata &type) {
+        writer.writeString(type.typeName);
+        writer.writeVarInt(type.templateArguments.size());
+        for (auto &argument: type.templateArguments) {
+            serializeType(writer, argument);
+        }
+    }
+
+    static ComponentMetadata::TypeMetadata deserializeType(BinaryReader &reader) {
+        ComponentMetadata::TypeMetadata ret;
+        ret.typeName = reader.readString();
+        auto count = reader.readVarInt();
+        for (auto i = 0u; i < count; i++) {
+            ret.templateArguments.emplace_back(deserializeType(reader));
+        }
+        return ret;
+    }
+
+    void MetadataSerializer::serialize(BinaryWriter &writer, const std::vector<ComponentMetadata> &metadata) {
+        writer.writeVarInt(metadata.size());
+        for (auto &component: metadata) {
+            writer.writeString(component.typeName);
+            writer.writeString(component.category);
+            writer.writeVarInt(component.operatorsLineNumber);
+            writer.writeVarInt(component.members.size());
+            for (auto &member: component.members) {
+                serializeType(writer, member.type);
+                writer.writeString(member.instanceName);
+                writer.writeString(member.defaultValue);
+                writer.writeString(member.displayName);
+                writer.writeString(member.description);
+                serializeToken(writer, member.minimum);
+                serializeToken(writer, member.maximum);
+            }
+        }
+    }
+
+    std::vector<ComponentMetadata> MetadataSerializer::deserialize(BinaryReader &reader) {
+        std::vector<ComponentMetadata> ret;
+        auto count = reader.readVarInt();
+        for (auto i = 0u; i < count; i++) {
+            auto &component = ret.emplace_back();
+            component.typeName = reader.readString();
+            component.category = reader.readString();
+            component.operatorsLineNumber = reader.readVarInt();
+            auto memberCount = reader.readVarInt();
+            for (auto m = 0u; m < memberCount; m++) {
+                auto &member = component.members.emplace_back();
+                member.type = deserializeType(reader);
+                member.instanceName = reader.readString();
+                member.defaultValue = reader.readString();
+                member.displayName = reader.readString();
+                member.description = reader.readString();
+                member.minimum = deserializeToken(reader);
+                member.maximum = deserializeToken(reader);
+            }
+        }
+        return ret;
+    }
+}
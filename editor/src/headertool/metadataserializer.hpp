@@ -0,0 +1,46 @@
+/**
+ *  xEditor - Editor and tools for creating games
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XENGINE_METADATASERIALIZER_HPP
+#define XENGINE_METADATASERIALIZER_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "headertool/componentmetadata.hpp"
+
+#include "io/binaryio.hpp"
+
+namespace xng {
+    /**
+     * Serializes component metadata to a compact binary representation.
+     */
+    class MetadataSerializer {
+    public:
+        void serialize(BinaryWriter &writer, const std::vector<ComponentMetadata> &metadata);
+
+        /**
+         * @throws std::runtime_error if the data is truncated
+         */
+        std::vector<ComponentMetadata> deserialize(BinaryReader &reader);
+    };
+}
+
+#endif //XENGINE_METADATASERIALIZER_HPP
@@ -0,0 +1,146 @@
+/**
+ *  xEditor - Editor and tools for creating games
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "headertool/headergenerator.hpp"
+#include "headertool/headerscanner.hpp"
+
+/**
+ * Checks that the generated header of a source header follows the components declared in it.
+ */
+
+static const char *COMPONENT_HEADER = R"###(#include "xng/xng.hpp"
+#include "component.generated.hpp"
+
+XCOMPONENT()
+struct TestComponent : public xng::Component {
+    XVARIABLE()
+    int value = 0;
+
+    XGENERATED_OPERATORS()
+};
+)###";
+
+// Still contains the macro name so the file is parsed
+static const char *COMMENTED_HEADER = R"###(#include "xng/xng.hpp"
+
+// XCOMPONENT() was removed
+struct TestComponent : public xng::Component {
+    int value = 0;
+};
+)###";
+
+// Does not contain the macro name so the file is skipped by the prefilter
+static const char *PLAIN_HEADER = R"###(#include "xng/xng.hpp"
+
+struct TestComponent : public xng::Component {
+    int value = 0;
+};
+)###";
+
+static int failures = 0;
+
+static void check(bool condition, const std::string &message) {
+    if (!condition) {
+        std::cerr << "FAILED: " << message << "\n";
+        failures++;
+    }
+}
+
+static void writeFile(const std::filesystem::path &path, const std::string &contents) {
+    std::ofstream fs(path, std::ofstream::binary | std::ofstream::trunc);
+    fs << contents;
+}
+
+static std::string readFile(const std::filesystem::path &path) {
+    std::ifstream fs(path, std::ifstream::binary);
+    std::stringstream stream;
+    stream << fs.rdbuf();
+    return stream.str();
+}
+
+static bool containsOperators(const std::filesystem::path &generatedPath) {
+    return readFile(generatedPath).find("#define XGENERATED_OPERATORS_") != std::string::npos;
+}
+
+/**
+ * Scan the header after replacing its contents, the index is kept between scans like in the editor.
+ */
+static xng::HeaderScanner::Result scan(const std::filesystem::path &header,
+                                       const std::string &contents,
+                                       xng::HeaderIndex &index) {
+    writeFile(header, contents);
+    xng::HeaderScanner scanner(1);
+    return scanner.scan({header}, index);
+}
+
+static void testComponentRemoved(const std::filesystem::path &directory, const char *removedContents) {
+    auto header = directory / "component.hpp";
+    auto generated = directory / xng::HeaderGenerator::generatedHeaderFileName(header.filename());
+    xng::HeaderIndex index;
+
+    auto result = scan(header, COMPONENT_HEADER, index);
+    check(result.errors.empty() && result.componentCount == 1, "The component is found");
+    check(std::filesystem::exists(generated) && containsOperators(generated),
+          "The generated header contains the operators");
+
+    result = scan(header, removedContents, index);
+    check(result.errors.empty() && result.componentCount == 0, "The removed component is not found");
+    check(std::filesystem::exists(generated), "The generated header is kept");
+    check(!containsOperators(generated), "The generated header does not contain stale operators");
+
+    result = scan(header, COMPONENT_HEADER, index);
+    check(containsOperators(generated), "The generated header contains the operators of the restored component");
+}
+
+static void testNoComponents(const std::filesystem::path &directory) {
+    auto header = directory / "plain.hpp";
+    auto generated = directory / xng::HeaderGenerator::generatedHeaderFileName(header.filename());
+    xng::HeaderIndex index;
+
+    scan(header, PLAIN_HEADER, index);
+    scan(header, COMMENTED_HEADER, index);
+    check(!std::filesystem::exists(generated), "No generated header is written for headers without components");
+}
+
+int main() {
+    auto directory = std::filesystem::temp_directory_path() / "xheadertool-headerscannertest";
+    std::filesystem::remove_all(directory);
+
+    for (auto *contents: {COMMENTED_HEADER, PLAIN_HEADER}) {
+        std::filesystem::create_directories(directory);
+        testComponentRemoved(directory, contents);
+        std::filesystem::remove_all(directory);
+    }
+
+    std::filesystem::create_directories(directory);
+    testNoComponents(directory);
+    std::filesystem::remove_all(directory);
+
+    if (failures > 0) {
+        std::cerr << failures << " checks failed\n";
+        return 1;
+    }
+    return 0;
+}
@@ -19,207 +19,359 @@
 
 #include "headertool/tokenizer.hpp"
 
+#include <bit>
 #include <iterator>
+#include <limits>
+#include <stdexcept>
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
 
 namespace xng {
-    enum Scope {
-        SCOPE_NONE,
-        SCOPE_IDENTIFIER,
-        SCOPE_STRING_LITERAL,
-        SCOPE_NUMERIC_LITERAL,
-        SCOPE_COMMENT_SINGLE_LINE,
-        SCOPE_COMMENT_MULTI_LINE
+    enum CharClass : uint8_t {
+        CLASS_OTHER, // Starts or continues an identifier
+        CLASS_WHITESPACE,
+        CLASS_NEWLINE,
+        CLASS_PUNCTUATION, // A single character token
+        CLASS_NUMBER, // Starts a numeric literal
+        CLASS_QUOTE,
+        CLASS_SLASH
+    };
+
+    struct CharTable {
+        CharClass classes[256]{};
+        Token::TokenType types[256]{}; // The token type of CLASS_PUNCTUATION characters
     };
 
-    bool isNumber(char c) {
-        return c >= '0' && c <= '9';
+    static constexpr CharTable createCharTable() {
+        CharTable ret;
+        for (auto &type: ret.types) {
+            type = Token::COMMENT;
+        }
+        auto setPunctuation = [&ret](char c, Token::TokenType type) {
+            ret.classes[static_cast<unsigned char>(c)] = CLASS_PUNCTUATION;
+            ret.types[static_cast<unsigned char>(c)] = type;
+        };
+        setPunctuation('(', Token::BRACKET_OPEN);
+        setPunctuation(')', Token::BRACKET_CLOSE);
+        setPunctuation('[', Token::SQUARE_BRACKET_OPEN);
+        setPunctuation(']', Token::SQUARE_BRACKET_CLOSE);
+        setPunctuation('{', Token::CURLY_BRACKET_OPEN);
+        setPunctuation('}', Token::CURLY_BRACKET_CLOSE);
+        setPunctuation('*', Token::ASTERISK);
+        setPunctuation('&', Token::AMPERSAND);
+        setPunctuation(';', Token::SEMICOLON);
+        setPunctuation('<', Token::LESS_THAN);
+        setPunctuation('>', Token::GREATER_THAN);
+        setPunctuation('=', Token::EQUAL_SIGN);
+        setPunctuation(',', Token::COMMA);
+        ret.classes[static_cast<unsigned char>(' ')] = CLASS_WHITESPACE;
+        ret.classes[static_cast<unsigned char>('\t')] = CLASS_WHITESPACE;
+        ret.classes[static_cast<unsigned char>('\r')] = CLASS_WHITESPACE;
+        ret.classes[static_cast<unsigned char>('\n')] = CLASS_NEWLINE;
+        for (char c = '0'; c <= '9'; c++) {
+            ret.classes[static_cast<unsigned char>(c)] = CLASS_NUMBER;
+        }
+        ret.classes[static_cast<unsigned char>('-')] = CLASS_NUMBER;
+        ret.classes[static_cast<unsigned char>('+')] = CLASS_NUMBER;
+        ret.classes[static_cast<unsigned char>('"')] = CLASS_QUOTE;
+        ret.classes[static_cast<unsigned char>('/')] = CLASS_SLASH;
+        return ret;
     }
 
-    bool isTerminator(char c) {
-        return c == ' '
-               || c == '\r'
-               || c == '\n'
-               || c == '\t'
-               || c == ',';
+    static constexpr CharTable charTable = createCharTable();
+
+    static bool isWhitespace(char c) {
+        auto cls = charTable.classes[static_cast<unsigned char>(c)];
+        return cls == CLASS_WHITESPACE || cls == CLASS_NEWLINE;
     }
 
-    void finishScope(std::vector<Token> &ret, std::string &accumulator, Scope &currentScope, int lineNumber) {
-        switch (currentScope) {
-            case SCOPE_NONE:
-                break;
-            case SCOPE_IDENTIFIER:
-                ret.emplace_back(Token(Token::IDENTIFIER, lineNumber, accumulator));
-                break;
-            case SCOPE_STRING_LITERAL:
-                ret.emplace_back(Token(Token::LITERAL_STRING, lineNumber, accumulator));
-                break;
-            case SCOPE_NUMERIC_LITERAL:
-                ret.emplace_back(Token(Token::LITERAL_NUMERIC, lineNumber, accumulator));
+    /**
+     * @return True if the character ends an identifier or numeric literal
+     */
+    static bool isDelimiter(char c) {
+        auto cls = charTable.classes[static_cast<unsigned char>(c)];
+        return cls == CLASS_WHITESPACE || cls == CLASS_NEWLINE || cls == CLASS_PUNCTUATION;
+    }
+
+#if defined(__AVX2__)
+#define XTOKENIZER_SIMD
+    struct Block {
+        static constexpr size_t SIZE = 32;
+
+        __m256i value;
+
+        static Block load(const char *data) {
+            return {_mm256_loadu_si256(reinterpret_cast<const __m256i *>(data))};
+        }
+
+        uint32_t equals(char c) const {
+            return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(value, _mm256_set1_epi8(c))));
+        }
+
+        // Only valid for ascii ranges, bytes >= 0x80 compare as negative and are never in range
+        uint32_t inRange(char min, char max) const {
+            auto ret = _mm256_and_si256(_mm256_cmpgt_epi8(value, _mm256_set1_epi8(static_cast<char>(min - 1))),
+                                        _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(max + 1)), value));
+            return static_cast<uint32_t>(_mm256_movemask_epi8(ret));
+        }
+    };
+#elif defined(__SSE2__) || defined(_M_X64)
+#define XTOKENIZER_SIMD
+    struct Block {
+        static constexpr size_t SIZE = 16;
+
+        __m128i value;
+
+        static Block load(const char *data) {
+            return {_mm_loadu_si128(reinterpret_cast<const __m128i *>(data))};
+        }
+
+        uint32_t equals(char c) const {
+            return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(value, _mm_set1_epi8(c))));
+        }
+
+        // Only valid for ascii ranges, bytes >= 0x80 compare as negative and are never in range
+        uint32_t inRange(char min, char max) const {
+            auto ret = _mm_and_si128(_mm_cmpgt_epi8(value, _mm_set1_epi8(static_cast<char>(min - 1))),
+                                     _mm_cmpgt_epi8(_mm_set1_epi8(static_cast<char>(max + 1)), value));
+            return static_cast<uint32_t>(_mm_movemask_epi8(ret));
+        }
+    };
+#endif
+
+#ifdef XTOKENIZER_SIMD
+    static constexpr uint32_t BLOCK_MASK = Block::SIZE == 32 ? ~0u : (1u << Block::SIZE) - 1;
+
+    static uint32_t countNewlines(uint32_t newlineMask, int end) {
+        return std::popcount(newlineMask & ((1u << end) - 1));
+    }
+#endif
+
+    /**
+     * @return The index of the first character which is not whitespace
+     */
+    static size_t skipWhitespace(const char *data, size_t i, size_t end, uint32_t &lineNumber) {
+#ifdef XTOKENIZER_SIMD
+        for (; i + Block::SIZE <= end; i += Block::SIZE) {
+            auto block = Block::load(data + i);
+            auto newlines = block.equals('\n');
+            auto whitespace = block.equals(' ') | block.equals('\t') | block.equals('\r') | newlines;
+            auto other = ~whitespace & BLOCK_MASK;
+            if (other != 0) {
+                auto bit = std::countr_zero(other);
+                lineNumber += countNewlines(newlines, bit);
+                return i + bit;
+            }
+            lineNumber += std::popcount(newlines);
+        }
+#endif
+        for (; i < end; i++) {
+            auto cls = charTable.classes[static_cast<unsigned char>(data[i])];
+            if (cls == CLASS_NEWLINE) {
+                lineNumber++;
+            } else if (cls != CLASS_WHITESPACE) {
                 break;
-            case SCOPE_COMMENT_SINGLE_LINE:
-            case SCOPE_COMMENT_MULTI_LINE:
-                ret.emplace_back(Token::COMMENT, lineNumber, accumulator);
+            }
+        }
+        return i;
+    }
+
+    /**
+     * @return The index of the first delimiter character
+     */
+    static size_t skipIdentifier(const char *data, size_t i, size_t end) {
+        while (i < end) {
+#ifdef XTOKENIZER_SIMD
+            // Skip blocks of alphanumeric characters and only classify the remaining characters with the table
+            for (; i + Block::SIZE <= end; i += Block::SIZE) {
+                auto block = Block::load(data + i);
+                auto word = block.inRange('a', 'z')
+                            | block.inRange('A', 'Z')
+                            | block.inRange('0', '9')
+                            | block.equals('_');
+                auto other = ~word & BLOCK_MASK;
+                if (other != 0) {
+                    i += std::countr_zero(other);
+                    break;
+                }
+            }
+            if (i >= end)
                 break;
+#endif
+            if (isDelimiter(data[i]))
+                return i;
+            i++;
         }
-        currentScope = SCOPE_NONE;
-        accumulator.clear();
+        return end;
     }
 
-    std::vector<Token> Tokenizer::tokenize(std::istream &source) {
-        std::string data;
-        char c;
-        while (source.get(c)) {
-            data += c;
+    /**
+     * @return The index of the next newline
+     */
+    static size_t findLineEnd(const char *data, size_t i, size_t end) {
+#ifdef XTOKENIZER_SIMD
+        for (; i + Block::SIZE <= end; i += Block::SIZE) {
+            auto newlines = Block::load(data + i).equals('\n');
+            if (newlines != 0) {
+                return i + std::countr_zero(newlines);
+            }
+        }
+#endif
+        for (; i < end; i++) {
+            if (data[i] == '\n')
+                break;
         }
+        return i;
+    }
 
-        std::vector<Token> ret;
-        std::string accumulator;
-        Scope currentScope = SCOPE_NONE;
-        bool stringEscape = false;
-
-        int lineNumber = 1;
-
-        for (auto i = 0; i < data.size(); i++) {
-            auto c = data.at(i);
-
-            if (currentScope != SCOPE_STRING_LITERAL
-                && currentScope != SCOPE_COMMENT_SINGLE_LINE
-                && currentScope != SCOPE_COMMENT_MULTI_LINE) {
-                if (c == '(') {
-                    finishScope(ret, accumulator, currentScope, lineNumber);
-                    ret.emplace_back(Token(Token::BRACKET_OPEN, lineNumber, std::string(1, c)));
-                    continue;
-                } else if (c == '[') {
-                    finishScope(ret, accumulator, currentScope, lineNumber);
-                    ret.emplace_back(Token(Token::SQUARE_BRACKET_OPEN, lineNumber, std::string(1, c)));
-                    continue;
-                } else if (c == ']') {
-                    finishScope(ret, accumulator, currentScope, lineNumber);
-                    ret.emplace_back(Token(Token::SQUARE_BRACKET_CLOSE, lineNumber, std::string(1, c)));
-                    continue;
-                } else if (c == ')') {
-                    finishScope(ret, accumulator, currentScope, lineNumber);
-                    ret.emplace_back(Token(Token::BRACKET_CLOSE, lineNumber, std::string(1, c)));
-                    continue;
-                } else if (c == '{') {
-                    finishScope(ret, accumulator, currentScope, lineNumber);
-                    ret.emplace_back(Token(Token::CURLY_BRACKET_OPEN, lineNumber, std::string(1, c)));
-                    continue;
-                } else if (c == '}') {
-                    finishScope(ret, accumulator, currentScope, lineNumber);
-                    ret.emplace_back(Token(Token::CURLY_BRACKET_CLOSE, lineNumber, std::string(1, c)));
-                    continue;
-                } else if (c == '*') {
-                    finishScope(ret, accumulator, currentScope, lineNumber);
-                    ret.emplace_back(Token(Token::ASTERISK, lineNumber, std::string(1, c)));
-                    continue;
-                } else if (c == '&') {
-                    finishScope(ret, accumulator, currentScope, lineNumber);
-                    ret.emplace_back(Token(Token::AMPERSAND, lineNumber, std::string(1, c)));
-                    continue;
-                } else if (c == ';') {
-                    finishScope(ret, accumulator, currentScope, lineNumber);
-                    ret.emplace_back(Token(Token::SEMICOLON, lineNumber, std::string(1, c)));
-                    continue;
-                } else if (c == '<') {
-                    finishScope(ret, accumulator, currentScope, lineNumber);
-                    ret.emplace_back(Token(Token::LESS_THAN, lineNumber, std::string(1, c)));
-                    continue;
-                } else if (c == '>') {
-                    finishScope(ret, accumulator, currentScope, lineNumber);
-                    ret.emplace_back(Token(Token::GREATER_THAN, lineNumber, std::string(1, c)));
-                    continue;
-                } else if (c == '=') {
-                    finishScope(ret, accumulator, currentScope, lineNumber);
-                    ret.emplace_back(Token(Token::EQUAL_SIGN, lineNumber, std::string(1, c)));
-                    continue;
-                } else if (c == ',') {
-                    finishScope(ret, accumulator, currentScope, lineNumber);
-                    ret.emplace_back(Token(Token::COMMA, lineNumber, std::string(1, c)));
-                    continue;
-                } else if (c == '\n') {
-                    lineNumber++;
+    /**
+     * @return The index after the closing star slash of a multi line comment
+     */
+    static size_t findCommentEnd(const char *data, size_t i, size_t end, uint32_t &lineNumber) {
+#ifdef XTOKENIZER_SIMD
+        for (; i + Block::SIZE <= end; i += Block::SIZE) {
+            auto block = Block::load(data + i);
+            auto newlines = block.equals('\n');
+            auto stars = block.equals('*');
+            while (stars != 0) {
+                auto bit = std::countr_zero(stars);
+                if (i + bit + 1 < end && data[i + bit + 1] == '/') {
+                    lineNumber += countNewlines(newlines, bit);
+                    return i + bit + 2;
                 }
+                stars &= stars - 1;
             }
-            switch (currentScope) {
-                case SCOPE_NONE:
-                    if (isTerminator(c)) {
-                        continue;
-                    } else if (isNumber(c)
-                               || c == '-'
-                               || c == '+') {
-                        currentScope = SCOPE_NUMERIC_LITERAL;
-                        accumulator += c;
-                    } else if (c == '"') {
-                        currentScope = SCOPE_STRING_LITERAL;
-                        accumulator += c;
-                    } else if (c == '/'
-                               && i + 1 < data.size()
-                               && data.at(i + 1) == '/') {
-                        currentScope = SCOPE_COMMENT_SINGLE_LINE;
-                        accumulator += c;
-                    } else if (c == '/'
-                               && i + 1 < data.size()
-                               && data.at(i + 1) == '*') {
-                        currentScope = SCOPE_COMMENT_MULTI_LINE;
-                        accumulator += c;
-                    } else {
-                        currentScope = SCOPE_IDENTIFIER;
-                        accumulator += c;
-                    }
+            lineNumber += std::popcount(newlines);
+        }
+#endif
+        for (; i < end; i++) {
+            if (data[i] == '\n') {
+                lineNumber++;
+            } else if (data[i] == '*' && i + 1 < end && data[i + 1] == '/') {
+                return i + 2;
+            }
+        }
+        return end;
+    }
+
+    /**
+     * @return The index after the closing quote of a string literal
+     */
+    static size_t findStringEnd(const char *data, size_t i, size_t end, uint32_t &lineNumber) {
+        while (i < end) {
+#ifdef XTOKENIZER_SIMD
+            for (; i + Block::SIZE <= end; i += Block::SIZE) {
+                auto block = Block::load(data + i);
+                auto newlines = block.equals('\n');
+                auto stops = block.equals('"') | block.equals('\\');
+                if (stops != 0) {
+                    auto bit = std::countr_zero(stops);
+                    lineNumber += countNewlines(newlines, bit);
+                    i += bit;
                     break;
-                case SCOPE_IDENTIFIER:
-                    if (isTerminator(c)) {
-                        finishScope(ret, accumulator, currentScope, lineNumber);
-                    } else {
-                        accumulator += c;
-                    }
+                }
+                lineNumber += std::popcount(newlines);
+            }
+            if (i >= end)
+                break;
+#endif
+            auto c = data[i];
+            if (c == '"') {
+                return i + 1;
+            } else if (c == '\\') {
+                // The escaped character can be an escaped newline
+                if (i + 1 < end && data[i + 1] == '\n')
+                    lineNumber++;
+                i += 2;
+            } else {
+                if (c == '\n')
+                    lineNumber++;
+                i++;
+            }
+        }
+        return end;
+    }
+
+    void Tokenizer::tokenize(std::string_view source, std::vector<CompactToken> &ret) {
+        if (source.size() > std::numeric_limits<uint32_t>::max()) {
+            throw std::runtime_error("Source exceeds the maximum tokenizer input size");
+        }
+
+        ret.clear();
+
+        auto *data = source.data();
+        auto end = source.size();
+
+        uint32_t lineNumber = 1;
+
+        // The class of the first character selects the scope of the token,
+        // each scope then consumes its characters in runs until the end of the token.
+        size_t i = 0;
+        while (i < end) {
+            auto c = static_cast<unsigned char>(data[i]);
+            auto begin = static_cast<uint32_t>(i);
+            switch (charTable.classes[c]) {
+                case CLASS_NEWLINE:
+                    lineNumber++;
+                    [[fallthrough]];
+                case CLASS_WHITESPACE:
+                    // Most runs are a single space, only use the block scan for longer runs like indentation
+                    i++;
+                    if (i < end && isWhitespace(data[i]))
+                        i = skipWhitespace(data, i, end, lineNumber);
                     break;
-                case SCOPE_STRING_LITERAL:
-                    accumulator += c;
-                    if (c == '\\' && !stringEscape) {
-                        stringEscape = true;
-                    } else if (c == '"' && !stringEscape) {
-                        finishScope(ret, accumulator, currentScope, lineNumber);
-                    } else {
-                        stringEscape = false;
-                    }
+                case CLASS_PUNCTUATION:
+                    ret.emplace_back(charTable.types[c], lineNumber, begin, 1);
+                    i++;
                     break;
-                case SCOPE_NUMERIC_LITERAL:
-                    if (isTerminator(c)) {
-                        finishScope(ret, accumulator, currentScope, lineNumber);
-                    } else {
-                        accumulator += c;
-                    }
+                case CLASS_NUMBER:
+                    i = skipIdentifier(data, i + 1, end);
+                    ret.emplace_back(Token::LITERAL_NUMERIC, lineNumber, begin, static_cast<uint32_t>(i - begin));
                     break;
-                case SCOPE_COMMENT_SINGLE_LINE:
-                    if (c == '\n') {
-                        finishScope(ret, accumulator, currentScope, lineNumber);
-                    } else {
-                        accumulator += c;
-                    }
+                case CLASS_QUOTE: {
+                    auto line = lineNumber;
+                    i = findStringEnd(data, i + 1, end, lineNumber);
+                    ret.emplace_back(Token::LITERAL_STRING, line, begin, static_cast<uint32_t>(i - begin));
                     break;
-                case SCOPE_COMMENT_MULTI_LINE:
-                    accumulator += c;
-                    if (c == '*'
-                        && i + 1 < data.size()
-                        && data.at(i + 1) == '/') {
-                        accumulator += data.at(i + 1);
-                        finishScope(ret, accumulator, currentScope, lineNumber);
-                        i++;
+                }
+                case CLASS_SLASH:
+                    if (i + 1 < end && data[i + 1] == '/') {
+                        i = findLineEnd(data, i + 2, end);
+                        ret.emplace_back(Token::COMMENT, lineNumber, begin, static_cast<uint32_t>(i - begin));
+                        break;
+                    } else if (i + 1 < end && data[i + 1] == '*') {
+                        auto line = lineNumber;
+                        i = findCommentEnd(data, i + 2, end, lineNumber);
+                        ret.emplace_back(Token::COMMENT, line, begin, static_cast<uint32_t>(i - begin));
+                        break;
                     }
+                    [[fallthrough]];
+                case CLASS_OTHER: {
+                    i = skipIdentifier(data, i + 1, end);
+                    auto &token = ret.emplace_back(Token::IDENTIFIER,
+                                                   lineNumber,
+                                                   begin,
+                                                   static_cast<uint32_t>(i - begin));
+                    token.keyword = lookupKeyword(source.substr(begin, i - begin));
                     break;
-            }
-
-            if (currentScope != SCOPE_STRING_LITERAL
-                && currentScope != SCOPE_COMMENT_SINGLE_LINE
-                && currentScope != SCOPE_COMMENT_MULTI_LINE) {
-                if (c == '\n') {
-                    lineNumber++;
                 }
             }
         }
+    }
 
+    std::vector<Token> Tokenizer::tokenize(std::istream &source) {
+        std::string data(std::istreambuf_iterator<char>(source), {});
+
+        std::vector<CompactToken> tokens;
+        tokenize(data, tokens);
+
+        std::vector<Token> ret;
+        ret.reserve(tokens.size());
+        for (auto &token: tokens) {
+            ret.emplace_back(token.toToken(data));
+        }
         return ret;
     }
 }
@@ -22,8 +22,10 @@
 
 #include <vector>
 #include <istream>
+#include <string_view>
 
 #include "headertool/token.hpp"
+#include "headertool/compacttoken.hpp"
 
 namespace xng {
     /**
@@ -32,6 +34,17 @@ namespace xng {
     class Tokenizer {
     public:
         std::vector<Token> tokenize(std::istream &source);
+
+        /**
+         * Tokenize the source buffer without allocating per token.
+         *
+         * The returned tokens reference the source buffer (eg. a MappedFile) and identifiers that are header tool
+         * keywords are interned. The tokens vector is cleared before tokenizing so that it can be reused across files.
+         *
+         * @param source The source code to tokenize, must outlive the tokens
+         * @param tokens The output token list
+         */
+        void tokenize(std::string_view source, std::vector<CompactToken> &tokens);
     };
 }
 #endif //XENGINE_TOKENIZER_HPP
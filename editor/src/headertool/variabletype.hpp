@@ -0,0 +1,215 @@
+/**
+ *  xEditor - Editor and tools for creating games
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XENGINE_VARIABLETYPE_HPP
+#define XENGINE_VARIABLETYPE_HPP
+
+#include <map>
+#include <string>
+
+namespace xng {
+    /**
+    * The list of supported types for XVARIABLE invocations
+    */
+    enum VariableType {
+        // Fundamental Types
+        TYPE_CHAR,
+        TYPE_SHORT,
+        TYPE_INT,
+        TYPE_LONG,
+        TYPE_BOOL,
+        TYPE_FLOAT,
+        TYPE_DOUBLE,
+
+        // Standard Types
+        TYPE_STRING,
+
+        // Standard Containers
+        TYPE_VECTOR,
+        TYPE_MAP,
+
+        // xEngine Types
+        TYPE_RESOURCE_HANDLE,
+        TYPE_URI,
+        TYPE_ENTITY_NAME,
+
+        //      - Assets -
+        TYPE_AUDIO,
+        TYPE_COLOR,
+        TYPE_IMAGE,
+        TYPE_LIGHT,
+        TYPE_MATERIAL,
+        TYPE_MESH,
+        TYPE_SHADER,
+        TYPE_SKYBOX,
+        TYPE_SPRITE,
+        TYPE_TEXTURE,
+        TYPE_SPRITE_ANIMATION,
+
+        //      - Math -
+        TYPE_GRID,
+        TYPE_MATRIX,
+        TYPE_RECTANGLE,
+        TYPE_TRANSFORM,
+        TYPE_VECTOR2,
+        TYPE_VECTOR3,
+        TYPE_VECTOR4,
+
+        TYPE_UNSUPPORTED, // The type has no editor support
+    };
+
+    /**
+     * The corresponding names for the supported types.
+     * Only single word fundamental types are supported.
+     * For standard types the full name space must be specified,
+     * for xEngine types the xng:: namespace specification is optional.
+     */
+    const std::map<std::string, VariableType> typeNameMapping = {
+            {"char",                 TYPE_CHAR},
+            {"short",                TYPE_SHORT},
+            {"int",                  TYPE_INT},
+            {"long",                 TYPE_LONG},
+            {"bool",                 TYPE_BOOL},
+            {"float",                TYPE_FLOAT},
+            {"double",               TYPE_FLOAT},
+
+            {"std::string",          TYPE_STRING},
+
+            {"std::vector",          TYPE_VECTOR},
+            {"std::map",             TYPE_MAP},
+
+            {"ResourceHandle",       TYPE_RESOURCE_HANDLE},
+            {"xng::ResourceHandle",  TYPE_RESOURCE_HANDLE},
+            {"Uri",                  TYPE_URI},
+            {"xng::Uri",             TYPE_URI},
+            {"EntityName",           TYPE_ENTITY_NAME},
+            {"xng::EntityName",      TYPE_ENTITY_NAME},
+
+            {"Audio",                TYPE_AUDIO},
+            {"xng::Audio",           TYPE_AUDIO},
+            {"ColorRGBA",            TYPE_COLOR},
+            {"xng::ColorRGBA",       TYPE_COLOR},
+            {"ColorRGB",             TYPE_COLOR},
+            {"xng::ColorRGB",        TYPE_COLOR},
+            {"ImageRGBA",            TYPE_IMAGE},
+            {"xng::ImageRGBA",       TYPE_IMAGE},
+            {"Light",                TYPE_LIGHT},
+            {"xng::Light",           TYPE_LIGHT},
+            {"Material",             TYPE_MATERIAL},
+            {"xng::Material",        TYPE_MATERIAL},
+            {"Mesh",                 TYPE_MESH},
+            {"xng::Mesh",            TYPE_MESH},
+            {"Shader",               TYPE_SHADER},
+            {"xng::Shader",          TYPE_SHADER},
+            {"Skybox",               TYPE_SKYBOX},
+            {"xng::Skybox",          TYPE_SKYBOX},
+            {"Sprite",               TYPE_SPRITE},
+            {"xng::Sprite",          TYPE_SPRITE},
+            {"Texture",              TYPE_TEXTURE},
+            {"xng::Texture",         TYPE_TEXTURE},
+            {"SpriteAnimation",      TYPE_SPRITE_ANIMATION},
+            {"xng::SpriteAnimation", TYPE_SPRITE_ANIMATION},
+    };
+
+    /**
+     * @param typeName The top level type name of a member without template arguments
+     * @return The variable type of the type name or TYPE_UNSUPPORTED
+     */
+    inline VariableType getVariableType(const std::string &typeName) {
+        auto it = typeNameMapping.find(typeName);
+        if (it == typeNameMapping.end()) {
+            return TYPE_UNSUPPORTED;
+        }
+        return it->second;
+    }
+    /**
+     * @return The name of the enumerator, used when generating code
+     */
+    inline const char *getVariableTypeName(VariableType type) {
+        switch (type) {
+            case TYPE_CHAR:
+                return "TYPE_CHAR";
+            case TYPE_SHORT:
+                return "TYPE_SHORT";
+            case TYPE_INT:
+                return "TYPE_INT";
+            case TYPE_LONG:
+                return "TYPE_LONG";
+            case TYPE_BOOL:
+                return "TYPE_BOOL";
+            case TYPE_FLOAT:
+                return "TYPE_FLOAT";
+            case TYPE_DOUBLE:
+                return "TYPE_DOUBLE";
+            case TYPE_STRING:
+                return "TYPE_STRING";
+            case TYPE_VECTOR:
+                return "TYPE_VECTOR";
+            case TYPE_MAP:
+                return "TYPE_MAP";
+            case TYPE_RESOURCE_HANDLE:
+                return "TYPE_RESOURCE_HANDLE";
+            case TYPE_URI:
+                return "TYPE_URI";
+            case TYPE_ENTITY_NAME:
+                return "TYPE_ENTITY_NAME";
+            case TYPE_AUDIO:
+                return "TYPE_AUDIO";
+            case TYPE_COLOR:
+                return "TYPE_COLOR";
+            case TYPE_IMAGE:
+                return "TYPE_IMAGE";
+            case TYPE_LIGHT:
+                return "TYPE_LIGHT";
+            case TYPE_MATERIAL:
+                return "TYPE_MATERIAL";
+            case TYPE_MESH:
+                return "TYPE_MESH";
+            case TYPE_SHADER:
+                return "TYPE_SHADER";
+            case TYPE_SKYBOX:
+                return "TYPE_SKYBOX";
+            case TYPE_SPRITE:
+                return "TYPE_SPRITE";
+            case TYPE_TEXTURE:
+                return "TYPE_TEXTURE";
+            case TYPE_SPRITE_ANIMATION:
+                return "TYPE_SPRITE_ANIMATION";
+            case TYPE_GRID:
+                return "TYPE_GRID";
+            case TYPE_MATRIX:
+                return "TYPE_MATRIX";
+            case TYPE_RECTANGLE:
+                return "TYPE_RECTANGLE";
+            case TYPE_TRANSFORM:
+                return "TYPE_TRANSFORM";
+            case TYPE_VECTOR2:
+                return "TYPE_VECTOR2";
+            case TYPE_VECTOR3:
+                return "TYPE_VECTOR3";
+            case TYPE_VECTOR4:
+                return "TYPE_VECTOR4";
+            case TYPE_UNSUPPORTED:
+                return "TYPE_UNSUPPORTED";
+        }
+        return "TYPE_UNSUPPORTED";
+    }
+}
+
+#endif //XENGINE_VARIABLETYPE_HPP
@@ -0,0 +1,146 @@
+/**
+ *  xEditor - Editor and tools for creating games
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XEDITOR_BINARYIO_HPP
+#define XEDITOR_BINARYIO_HPP
+
+#include <string>
+#include <string_view>
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+
+/**
+ * Appends little endian encoded values to a byte buffer.
+ */
+class BinaryWriter {
+public:
+    explicit BinaryWriter(std::string &buffer) : buffer(buffer) {}
+
+    template<typename T>
+    void write(T value) {
+        static_assert(std::is_arithmetic_v<T> || std::is_enum_v<T>);
+        char bytes[sizeof(T)];
+        std::memcpy(bytes, &value, sizeof(T));
+        if constexpr (std::endian::native == std::endian::big) {
+            std::reverse(bytes, bytes + sizeof(T));
+        }
+        buffer.append(bytes, sizeof(T));
+    }
+
+    /**
+     * Write an unsigned integer using a variable length encoding of 7 bits per byte.
+     */
+    void writeVarInt(uint64_t value) {
+        while (value >= 0x80) {
+            buffer.push_back(static_cast<char>((value & 0x7F) | 0x80));
+            value >>= 7;
+        }
+        buffer.push_back(static_cast<char>(value));
+    }
+
+    void writeString(std::string_view value) {
+        writeVarInt(value.size());
+        buffer.append(value);
+    }
+
+    void writeBytes(std::string_view value) {
+        buffer.append(value);
+    }
+
+    size_t size() const {
+        return buffer.size();
+    }
+
+private:
+    std::string &buffer;
+};
+
+/**
+ * Reads values written by BinaryWriter from a byte buffer.
+ *
+ * Throws std::runtime_error when reading past the end of the buffer.
+ */
+class BinaryReader {
+public:
+    explicit BinaryReader(std::string_view buffer) : buffer(buffer) {}
+
+    template<typename T>
+    T read() {
+        static_assert(std::is_arithmetic_v<T> || std::is_enum_v<T>);
+        auto bytes = readBytes(sizeof(T));
+        char data[sizeof(T)];
+        std::memcpy(data, bytes.data(), sizeof(T));
+        if constexpr (std::endian::native == std::endian::big) {
+            std::reverse(data, data + sizeof(T));
+        }
+        T ret;
+        std::memcpy(&ret, data, sizeof(T));
+        return ret;
+    }
+
+    uint64_t readVarInt() {
+        uint64_t ret = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            auto byte = static_cast<uint8_t>(readBytes(1)[0]);
+            ret |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) {
+                return ret;
+            }
+        }
+        throw std::runtime_error("Invalid variable length integer");
+    }
+
+    std::string readString() {
+        return std::string(readStringView());
+    }
+
+    /**
+     * @return A view into the underlying buffer
+     */
+    std::string_view readStringView() {
+        return readBytes(readVarInt());
+    }
+
+    std::string_view readBytes(size_t count) {
+        if (count > buffer.size() - offset) {
+            throw std::runtime_error("Unexpected end of binary data");
+        }
+        auto ret = buffer.substr(offset, count);
+        offset += count;
+        return ret;
+    }
+
+    bool atEnd() const {
+        return offset >= buffer.size();
+    }
+
+    size_t getOffset() const {
+        return offset;
+    }
+
+private:
+    std::string_view buffer;
+    size_t offset = 0;
+};
+
+#endif //XEDITOR_BINARYIO_HPP
@@ -0,0 +1,585 @@
+/**
+ *  xEditor - Editor and tools for creating games
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "io/binaryscene.hpp"
+
+#include <cstring>
+#include <map>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "io/binaryio.hpp"
+
+using namespace xng;
+
+static const char SCENE_MAGIC[4] = {'X', 'S', 'C', 'N'};
+
+static const size_t HEADER_SIZE = sizeof(SCENE_MAGIC) + sizeof(uint32_t) + sizeof(uint8_t);
+static const size_t FOOTER_SIZE = sizeof(uint64_t) + sizeof(SCENE_MAGIC);
+
+static const char *TYPE_MEMBER = "type";
+
+namespace {
+    class StringTable {
+    public:
+        void add(const std::string &value) {
+            if (ids.emplace(value, strings.size()).second)
+                strings.emplace_back(value);
+        }
+
+        void addAll(const Message &message) {
+            switch (message.getType()) {
+                case Message::STRING:
+                    add(message.asString());
+                    break;
+                case Message::LIST:
+                    for (auto &element: message.asList()) {
+                        addAll(element);
+                    }
+                    break;
+                case Message::DICTIONARY:
+                    for (auto &pair: message.asDictionary()) {
+                        add(pair.first);
+                        addAll(pair.second);
+                    }
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        uint64_t get(const std::string &value) const {
+            return ids.at(value);
+        }
+
+        const std::vector<std::string> &getStrings() const {
+            return strings;
+        }
+
+    private:
+        std::vector<std::string> strings;
+        std::unordered_map<std::string, uint64_t> ids;
+    };
+
+    struct EntityRecord {
+        uint8_t flags = 0;
+        uint64_t name = 0;
+        uint64_t parent = 0;
+        Message properties;
+        const Message *raw = nullptr; // The entity message if it is not a dictionary
+        std::vector<std::pair<size_t, const Message *>> components; // The pool index and the message of every component
+        std::vector<std::pair<uint64_t, uint64_t>> ranges; // The offset and size of every encoded component
+    };
+
+    struct Pool {
+        bool typed = false;
+        std::string type;
+        std::vector<std::pair<size_t, size_t>> components; // The entity index and the component index
+    };
+}
+
+/**
+ * @param writeString Writes a string or dictionary key
+ * @param skipMember If not null the member of the dictionary with this name is not written
+ */
+template<typename WriteString>
+static void writeValue(BinaryWriter &writer,
+                       const Message &message,
+                       const WriteString &writeString,
+                       const char *skipMember = nullptr) {
+    switch (message.getType()) {
+        case Message::NUL:
+            writer.write<uint8_t>(BinaryScene::VALUE_NULL);
+            break;
+        case Message::SIGNED_INTEGER: {
+            auto value = static_cast<int64_t>(message.asLongLong());
+            writer.write<uint8_t>(BinaryScene::VALUE_SIGNED);
+            writer.writeVarInt((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+            break;
+        }
+        case Message::UNSIGNED_INTEGER:
+            writer.write<uint8_t>(BinaryScene::VALUE_UNSIGNED);
+            writer.writeVarInt(static_cast<uint64_t>(message.asULongLong()));
+            break;
+        case Message::FLOAT: {
+            auto value = message.asDouble();
+            auto single = static_cast<float>(value);
+            if (static_cast<double>(single) == value) {
+                writer.write<uint8_t>(BinaryScene::VALUE_FLOAT);
+                writer.write<float>(single);
+            } else {
+                writer.write<uint8_t>(BinaryScene::VALUE_DOUBLE);
+                writer.write<double>(value);
+            }
+            break;
+        }
+        case Message::STRING:
+            writer.write<uint8_t>(BinaryScene::VALUE_STRING);
+            writeString(writer, message.asString());
+            break;
+        case Message::LIST: {
+            auto &list = message.asList();
+            writer.write<uint8_t>(BinaryScene::VALUE_LIST);
+            writer.writeVarInt(list.size());
+            for (auto &element: list) {
+                writeValue(writer, element, writeString);
+            }
+            break;
+        }
+        case Message::DICTIONARY: {
+            auto &dictionary = message.asDictionary();
+            auto count = dictionary.size();
+            if (skipMember != nullptr && dictionary.find(skipMember) != dictionary.end())
+                count--;
+            writer.write<uint8_t>(BinaryScene::VALUE_DICTIONARY);
+            writer.writeVarInt(count);
+            for (auto &pair: dictionary) {
+                if (skipMember != nullptr && pair.first == skipMember)
+                    continue;
+                writeString(writer, pair.first);
+                writeValue(writer, pair.second, writeString);
+            }
+            break;
+        }
+        default:
+            throw std::runtime_error("Unsupported message type in scene");
+    }
+}
+
+static const std::string &readString(BinaryReader &reader, const std::vector<std::string> &strings) {
+    auto index = reader.readVarInt();
+    if (index >= strings.size())
+        throw std::runtime_error("Invalid binary scene string index");
+    return strings[index];
+}
+
+/**
+ * @param readString Reads a string or dictionary key written by the writeString function of writeValue
+ */
+template<typename ReadString>
+static Message readValue(BinaryReader &reader, const ReadString &readString) {
+    switch (reader.read<uint8_t>()) {
+        case BinaryScene::VALUE_NULL:
+            return {};
+        case BinaryScene::VALUE_SIGNED: {
+            auto value = reader.readVarInt();
+            return Message(static_cast<long long>(static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1)));
+        }
+        case BinaryScene::VALUE_UNSIGNED:
+            return Message(static_cast<unsigned long long>(reader.readVarInt()));
+        case BinaryScene::VALUE_FLOAT:
+            return Message(static_cast<double>(reader.read<float>()));
+        case BinaryScene::VALUE_DOUBLE:
+            return Message(reader.read<double>());
+        case BinaryScene::VALUE_STRING:
+            return Message(std::string(readString(reader)));
+        case BinaryScene::VALUE_LIST: {
+            auto count = reader.readVarInt();
+            std::vector<Message> list;
+            for (auto i = 0u; i < count; i++) {
+                list.emplace_back(readValue(reader, readString));
+            }
+            return Message(list);
+        }
+        case BinaryScene::VALUE_DICTIONARY: {
+            auto count = reader.readVarInt();
+            std::map<std::string, Message> dictionary;
+            for (auto i = 0u; i < count; i++) {
+                auto key = std::string(readString(reader));
+                dictionary[key] = readValue(reader, readString);
+            }
+            return Message(dictionary);
+        }
+        default:
+            throw std::runtime_error("Invalid binary scene value type");
+    }
+}
+
+static Message readValue(BinaryReader &reader, const std::vector<std::string> &strings) {
+    return readValue(reader, [&strings](BinaryReader &reader) -> const std::string & {
+        return readString(reader, strings);
+    });
+}
+
+static void skipValue(BinaryReader &reader) {
+    switch (reader.read<uint8_t>()) {
+        case BinaryScene::VALUE_NULL:
+            break;
+        case BinaryScene::VALUE_SIGNED:
+        case BinaryScene::VALUE_UNSIGNED:
+        case BinaryScene::VALUE_STRING:
+            reader.readVarInt();
+            break;
+        case BinaryScene::VALUE_FLOAT:
+            reader.readBytes(sizeof(float));
+            break;
+        case BinaryScene::VALUE_DOUBLE:
+            reader.readBytes(sizeof(double));
+            break;
+        case BinaryScene::VALUE_LIST: {
+            auto count = reader.readVarInt();
+            for (auto i = 0u; i < count; i++) {
+                skipValue(reader);
+            }
+            break;
+        }
+        case BinaryScene::VALUE_DICTIONARY: {
+            auto count = reader.readVarInt();
+            for (auto i = 0u; i < count; i++) {
+                reader.readVarInt();
+                skipValue(reader);
+            }
+            break;
+        }
+        default:
+            throw std::runtime_error("Invalid binary scene value type");
+    }
+}
+
+bool BinaryScene::isBinaryScene(std::string_view data) {
+    return data.size() >= sizeof(SCENE_MAGIC) && std::memcmp(data.data(), SCENE_MAGIC, sizeof(SCENE_MAGIC)) == 0;
+}
+
+void BinaryScene::writeMessage(BinaryWriter &writer, const Message &message) {
+    writeValue(writer, message, [](BinaryWriter &writer, const std::string &value) {
+        writer.writeString(value);
+    });
+}
+
+Message BinaryScene::readMessage(BinaryReader &reader) {
+    return readValue(reader, [](BinaryReader &reader) {
+        return reader.readStringView();
+    });
+}
+
+void BinarySceneWriter::write(const Message &scene) {
+    StringTable table;
+    uint8_t flags = 0;
+    Message properties;
+    std::vector<EntityRecord> entities;
+    std::vector<Pool> pools;
+
+    if (scene.getType() == Message::DICTIONARY
+        && scene.has("entities")
+        && scene["entities"].getType() == Message::LIST) {
+        flags |= BinaryScene::SCENE_ENTITIES;
+        std::map<std::string, Message> members;
+        for (auto &pair: scene.asDictionary()) {
+            if (pair.first != "entities")
+                members.insert(pair);
+        }
+        properties = Message(members);
+    } else {
+        properties = scene;
+    }
+    table.addAll(properties);
+
+    // Split the entities into the index records and the component pools
+    std::map<std::pair<bool, std::string>, size_t> poolIndices;
+    auto getPool = [&](bool typed, const std::string &type) {
+        auto it = poolIndices.find({typed, type});
+        if (it != poolIndices.end())
+            return it->second;
+        Pool pool;
+        pool.typed = typed;
+        pool.type = type;
+        pools.emplace_back(pool);
+        poolIndices[{typed, type}] = pools.size() - 1;
+        if (typed)
+            table.add(type);
+        return pools.size() - 1;
+    };
+
+    if (flags & BinaryScene::SCENE_ENTITIES) {
+        const auto &entityList = scene["entities"].asList();
+        entities.resize(entityList.size());
+        for (auto i = 0u; i < entityList.size(); i++) {
+            auto &entity = entityList[i];
+            auto &record = entities[i];
+            if (entity.getType() != Message::DICTIONARY) {
+                record.flags = BinaryScene::ENTITY_RAW;
+                record.raw = &entity;
+                table.addAll(entity);
+                continue;
+            }
+
+            std::map<std::string, Message> members;
+            for (auto &pair: entity.asDictionary()) {
+                if (pair.first == "name" && pair.second.getType() == Message::STRING) {
+                    table.add(pair.second.asString());
+                    record.name = table.get(pair.second.asString()) + 1;
+                } else if (pair.first == "components" && pair.second.getType() == Message::LIST) {
+                    record.flags |= BinaryScene::ENTITY_COMPONENT_LIST;
+                    for (auto &component: pair.second.asList()) {
+                        auto typed = component.getType() == Message::DICTIONARY
+                                     && component.has(TYPE_MEMBER)
+                                     && component[TYPE_MEMBER].getType() == Message::STRING;
+                        auto pool = getPool(typed, typed ? component[TYPE_MEMBER].asString() : std::string());
+                        pools[pool].components.emplace_back(i, record.components.size());
+                        record.components.emplace_back(pool, &component);
+                    }
+                } else if (pair.first == "components" && pair.second.getType() == Message::DICTIONARY) {
+                    record.flags |= BinaryScene::ENTITY_COMPONENT_DICTIONARY;
+                    for (auto &component: pair.second.asDictionary()) {
+                        auto pool = getPool(true, component.first);
+                        pools[pool].components.emplace_back(i, record.components.size());
+                        record.components.emplace_back(pool, &component.second);
+                    }
+                } else {
+                    members.insert(pair);
+                }
+            }
+            record.properties = Message(members);
+            table.addAll(record.properties);
+
+            for (auto &pair: record.components) {
+                auto &component = *pair.second;
+                table.addAll(component);
+                // The parent name of transform components is stored in the index for readers of the hierarchy
+                if (record.parent == 0
+                    && component.getType() == Message::DICTIONARY
+                    && component.has("parent")
+                    && component["parent"].getType() == Message::STRING
+                    && !component["parent"].asString().empty()) {
+                    record.parent = table.get(component["parent"].asString()) + 1;
+                }
+            }
+        }
+    }
+
+    auto writeString = [&table](BinaryWriter &writer, const std::string &value) {
+        writer.writeVarInt(table.get(value));
+    };
+
+    std::string buffer;
+    BinaryWriter writer(buffer);
+    writer.writeBytes({SCENE_MAGIC, sizeof(SCENE_MAGIC)});
+    writer.write<uint32_t>(BinaryScene::VERSION);
+    writer.write<uint8_t>(flags);
+
+    writer.writeVarInt(table.getStrings().size());
+    for (auto &string: table.getStrings()) {
+        writer.writeString(string);
+    }
+
+    writeValue(writer, properties, writeString);
+
+    writer.writeVarInt(pools.size());
+    flush(buffer);
+
+    for (auto i = 0u; i < pools.size(); i++) {
+        auto &pool = pools[i];
+
+        std::string poolBuffer;
+        BinaryWriter poolWriter(poolBuffer);
+        std::string componentBuffer;
+        std::vector<std::pair<uint64_t, uint64_t>> ranges; // The offset in the pool buffer and size of every component
+        for (auto &pair: pool.components) {
+            auto &component = *entities[pair.first].components[pair.second].second;
+            componentBuffer.clear();
+            BinaryWriter componentWriter(componentBuffer);
+            writeValue(componentWriter, component, writeString, pool.typed ? TYPE_MEMBER : nullptr);
+            poolWriter.writeVarInt(pair.first);
+            poolWriter.writeVarInt(componentBuffer.size());
+            ranges.emplace_back(poolBuffer.size(), componentBuffer.size());
+            poolWriter.writeBytes(componentBuffer);
+        }
+
+        writer.writeVarInt(pool.typed ? table.get(pool.type) + 1 : 0);
+        writer.writeVarInt(pool.components.size());
+        writer.write<uint64_t>(poolBuffer.size());
+
+        auto dataOffset = offset + buffer.size();
+        for (auto c = 0u; c < pool.components.size(); c++) {
+            auto &pair = pool.components[c];
+            auto &record = entities[pair.first];
+            record.ranges.resize(record.components.size());
+            record.ranges[pair.second] = {dataOffset + ranges[c].first, ranges[c].second};
+        }
+
+        flush(buffer);
+        flush(poolBuffer);
+    }
+
+    auto indexOffset = offset;
+    writer.writeVarInt(entities.size());
+    for (auto &record: entities) {
+        writer.write<uint8_t>(record.flags);
+        writer.writeVarInt(record.name);
+        writer.writeVarInt(record.parent);
+        writeValue(writer, record.raw ? *record.raw : record.properties, writeString);
+        writer.writeVarInt(record.components.size());
+        for (auto c = 0u; c < record.components.size(); c++) {
+            writer.writeVarInt(record.components[c].first);
+            writer.writeVarInt(record.ranges[c].first);
+            writer.writeVarInt(record.ranges[c].second);
+        }
+        if (buffer.size() > 1024 * 1024)
+            flush(buffer);
+    }
+
+    writer.write<uint64_t>(indexOffset);
+    writer.writeBytes({SCENE_MAGIC, sizeof(SCENE_MAGIC)});
+    flush(buffer);
+}
+
+void BinarySceneWriter::flush(std::string &buffer) {
+    stream.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    if (!stream)
+        throw std::runtime_error("Failed to write binary scene");
+    offset += buffer.size();
+    buffer.clear();
+}
+
+BinarySceneReader::BinarySceneReader(std::string_view data)
+        : data(data) {
+    if (data.size() < HEADER_SIZE + FOOTER_SIZE
+        || !BinaryScene::isBinaryScene(data)
+        || std::memcmp(data.data() + data.size() - sizeof(SCENE_MAGIC), SCENE_MAGIC, sizeof(SCENE_MAGIC)) != 0) {
+        throw std::runtime_error("Invalid binary scene");
+    }
+
+    BinaryReader reader(data);
+    reader.readBytes(sizeof(SCENE_MAGIC));
+    if (reader.read<uint32_t>() != BinaryScene::VERSION)
+        throw std::runtime_error("Unsupported binary scene version");
+    flags = reader.read<uint8_t>();
+
+    auto stringCount = reader.readVarInt();
+    for (auto i = 0u; i < stringCount; i++) {
+        strings.emplace_back(reader.readString());
+    }
+
+    propertiesOffset = reader.getOffset();
+    skipValue(reader);
+
+    auto poolCount = reader.readVarInt();
+    for (auto i = 0u; i < poolCount; i++) {
+        auto type = reader.readVarInt();
+        if (type > strings.size())
+            throw std::runtime_error("Invalid binary scene string index");
+        typedPools.push_back(type != 0);
+        componentTypes.emplace_back(type == 0 ? std::string() : strings[type - 1]);
+        reader.readVarInt();
+        reader.readBytes(reader.read<uint64_t>());
+    }
+
+    BinaryReader footer(data.substr(data.size() - FOOTER_SIZE));
+    auto indexOffset = footer.read<uint64_t>();
+    if (indexOffset > data.size() - FOOTER_SIZE)
+        throw std::runtime_error("Invalid binary scene index offset");
+
+    BinaryReader index(data.substr(indexOffset, data.size() - FOOTER_SIZE - indexOffset));
+    auto entityCount = index.readVarInt();
+    for (auto i = 0u; i < entityCount; i++) {
+        Entity entity;
+        entity.flags = index.read<uint8_t>();
+        auto name = index.readVarInt();
+        auto parent = index.readVarInt();
+        if (name > strings.size() || parent > strings.size())
+            throw std::runtime_error("Invalid binary scene string index");
+        if (name != 0) {
+            entity.hasName = true;
+            entity.name = strings[name - 1];
+        }
+        if (parent != 0) {
+            entity.parent = strings[parent - 1];
+        }
+        entity.properties = readValue(index, strings);
+        auto componentCount = index.readVarInt();
+        for (auto c = 0u; c < componentCount; c++) {
+            Component component{};
+            component.pool = index.readVarInt();
+            component.offset = index.readVarInt();
+            component.size = index.readVarInt();
+            if (component.pool >= componentTypes.size()
+                || component.offset > indexOffset
+                || component.size > indexOffset - component.offset) {
+                throw std::runtime_error("Invalid binary scene component range");
+            }
+            entity.components.emplace_back(component);
+        }
+        entities.emplace_back(std::move(entity));
+    }
+}
+
+Message BinarySceneReader::readProperties() const {
+    BinaryReader reader(data.substr(propertiesOffset));
+    return readValue(reader, strings);
+}
+
+Message BinarySceneReader::readComponent(const Component &component) const {
+    BinaryReader reader(data.substr(component.offset, component.size));
+    return readValue(reader, strings);
+}
+
+Message BinarySceneReader::readListComponent(const Component &component) const {
+    auto message = readComponent(component);
+    if (typedPools[component.pool]) {
+        message[TYPE_MEMBER] = Message(componentTypes[component.pool]);
+    }
+    return message;
+}
+
+Message BinarySceneReader::readEntity(size_t index) const {
+    auto &entity = entities.at(index);
+    if (entity.flags & BinaryScene::ENTITY_RAW)
+        return entity.properties;
+
+    std::map<std::string, Message> members;
+    if (entity.properties.getType() == Message::DICTIONARY) {
+        members = entity.properties.asDictionary();
+    }
+    if (entity.hasName) {
+        members["name"] = Message(entity.name);
+    }
+    if (entity.flags & BinaryScene::ENTITY_COMPONENT_LIST) {
+        std::vector<Message> components;
+        for (auto &component: entity.components) {
+            components.emplace_back(readListComponent(component));
+        }
+        members["components"] = Message(components);
+    } else if (entity.flags & BinaryScene::ENTITY_COMPONENT_DICTIONARY) {
+        std::map<std::string, Message> components;
+        for (auto &component: entity.components) {
+            components[componentTypes[component.pool]] = readComponent(component);
+        }
+        members["components"] = Message(components);
+    }
+    return Message(members);
+}
+
+Message BinarySceneReader::read() const {
+    auto properties = readProperties();
+    if (!(flags & BinaryScene::SCENE_ENTITIES))
+        return properties;
+
+    std::vector<Message> entityList;
+    entityList.reserve(entities.size());
+    for (auto i = 0u; i < entities.size(); i++) {
+        entityList.emplace_back(readEntity(i));
+    }
+
+    std::map<std::string, Message> members;
+    if (properties.getType() == Message::DICTIONARY) {
+        members = properties.asDictionary();
+    }
+    members["entities"] = Message(entityList);
+    return Message(members);
+}
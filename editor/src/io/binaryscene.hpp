@@ -0,0 +1,232 @@
+/**
+ *  xEditor - Editor and tools for creating games
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XEDITOR_BINARYSCENE_HPP
+#define XEDITOR_BINARYSCENE_HPP
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "xng/xng.hpp"
+
+#include "io/binaryio.hpp"
+
+/**
+ * A compact binary encoding of the serialized scene message.
+ *
+ * The components of all entities are grouped into one pool per component type,
+ * every string (entity names, uris, member names) is stored once in a string table and referenced by index
+ * and integers are variable length encoded.
+ *
+ * Layout, all fixed size integers are little endian:
+ *
+ *  Header      "XSCN" magic, uint32 version, uint8 flags (SCENE_ENTITIES)
+ *  Strings     varint count followed by the strings
+ *  Properties  value   The scene message without the entities list
+ *  Pools       varint pool count, per pool:
+ *                  varint type         The string index of the component type name + 1
+ *                                      or 0 if the components of the pool have no type member
+ *                  varint count        The number of components in the pool
+ *                  uint64 size         The size of the components of the pool in bytes
+ *                  count times:
+ *                      varint entity   The index of the entity of the component
+ *                      varint size     The size of the encoded component
+ *                      value           The component message
+ *  Index       varint entity count, per entity:
+ *                  uint8 flags         ENTITY_RAW | ENTITY_COMPONENT_LIST | ENTITY_COMPONENT_DICTIONARY
+ *                  varint name         The string index of the name + 1 or 0 if the entity has no name
+ *                  varint parent       The string index of the parent name + 1 or 0 if the entity has no parent
+ *                  value               The other members of the entity message, the entity message if ENTITY_RAW
+ *                  varint count        The number of components
+ *                  count times:
+ *                      varint pool     The index of the pool of the component
+ *                      varint offset   The offset of the encoded component from the beginning of the file
+ *                      varint size     The size of the encoded component
+ *  Footer      uint64 index offset, "XSCN" magic
+ *
+ * Strings are stored as a varint length followed by the bytes.
+ *
+ * Values start with a uint8 type tag:
+ *  VALUE_NULL
+ *  VALUE_SIGNED        zigzag encoded varint
+ *  VALUE_UNSIGNED      varint
+ *  VALUE_FLOAT         float, used for floating point values which are exactly representable
+ *  VALUE_DOUBLE        double
+ *  VALUE_STRING        varint string index
+ *  VALUE_LIST          varint count followed by the values
+ *  VALUE_DICTIONARY    varint count followed by the varint string index of the key and the value of every member
+ *
+ * Component list entries store their "type" member as the pool type instead of in the component value.
+ * The entity index at the end of the file allows readers to look up entities and their components
+ * without decoding the pools.
+ */
+class BinaryScene {
+public:
+    static const uint32_t VERSION = 1;
+
+    enum SceneFlags : uint8_t {
+        SCENE_ENTITIES = 1 << 0, // The scene message is a dictionary with an entities list
+    };
+
+    enum EntityFlags : uint8_t {
+        ENTITY_RAW = 1 << 0, // The entity message is not a dictionary and stored as the entity properties
+        ENTITY_COMPONENT_LIST = 1 << 1, // The components member is a list of dictionaries with a type member
+        ENTITY_COMPONENT_DICTIONARY = 1 << 2, // The components member is a dictionary by type name
+    };
+
+    enum ValueType : uint8_t {
+        VALUE_NULL,
+        VALUE_SIGNED,
+        VALUE_UNSIGNED,
+        VALUE_FLOAT,
+        VALUE_DOUBLE,
+        VALUE_STRING,
+        VALUE_LIST,
+        VALUE_DICTIONARY
+    };
+
+    /**
+     * @return True if the data starts with the magic of the binary scene format
+     */
+    static bool isBinaryScene(std::string_view data);
+
+    /**
+     * Write a standalone value, strings are stored inline instead of in a string table.
+     */
+    static void writeMessage(BinaryWriter &writer, const xng::Message &message);
+
+    static xng::Message readMessage(BinaryReader &reader);
+};
+
+/**
+ * Writes a scene message in the binary scene format to a stream.
+ *
+ * The string table is collected from the message before the sections are written,
+ * afterwards the pools are encoded and written to the stream one at a time.
+ */
+class BinarySceneWriter {
+public:
+    explicit BinarySceneWriter(std::ostream &stream) : stream(stream) {}
+
+    /**
+     * Throws std::runtime_error if the stream cannot be written.
+     *
+     * @param scene The message of the serialized scene
+     */
+    void write(const xng::Message &scene);
+
+private:
+    void flush(std::string &buffer);
+
+    std::ostream &stream;
+    uint64_t offset = 0;
+};
+
+/**
+ * Reads scenes in the binary scene format from a buffer.
+ *
+ * The constructor reads the string table and the entity index,
+ * the components are decoded when they are requested.
+ *
+ * Throws std::runtime_error if the data is not a valid binary scene.
+ */
+class BinarySceneReader {
+public:
+    struct Component {
+        size_t pool; // The index of the component type in getComponentTypes
+        uint64_t offset; // The offset of the encoded component from the beginning of the data
+        uint64_t size;
+    };
+
+    struct Entity {
+        uint8_t flags = 0;
+        bool hasName = false;
+        std::string name;
+        std::string parent;
+        xng::Message properties; // The members of the entity message other than the name and the components
+        std::vector<Component> components;
+    };
+
+    /**
+     * @param data The data of the file, must outlive the reader
+     */
+    explicit BinarySceneReader(std::string_view data);
+
+    /**
+     * @return True if the scene message is a dictionary with an entities list
+     */
+    bool hasEntities() const {
+        return flags & BinaryScene::SCENE_ENTITIES;
+    }
+
+    const std::vector<Entity> &getEntities() const {
+        return entities;
+    }
+
+    /**
+     * @return The component type names by pool index, empty for the pool of components without a type member
+     */
+    const std::vector<std::string> &getComponentTypes() const {
+        return componentTypes;
+    }
+
+    /**
+     * @return The scene message without the entities
+     */
+    xng::Message readProperties() const;
+
+    xng::Message readComponent(const Component &component) const;
+
+    /**
+     * @return The component message with the type member restored for the components list of the entity message
+     */
+    xng::Message readListComponent(const Component &component) const;
+
+    /**
+     * @return True if the components of the pool store their type in the type member
+     */
+    bool isTypedPool(size_t pool) const {
+        return typedPools.at(pool);
+    }
+
+    /**
+     * @param index
+     * @return The message of the entity as it was passed to the writer
+     */
+    xng::Message readEntity(size_t index) const;
+
+    /**
+     * @return The message of the scene as it was passed to the writer
+     */
+    xng::Message read() const;
+
+private:
+    std::string_view data;
+    uint8_t flags = 0;
+    std::vector<std::string> strings;
+    std::vector<std::string> componentTypes;
+    std::vector<bool> typedPools; // True if the type of the pool is stored in the type member of list components
+    size_t propertiesOffset = 0;
+    std::vector<Entity> entities;
+};
+
+#endif //XEDITOR_BINARYSCENE_HPP
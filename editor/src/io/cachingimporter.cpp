@@ -0,0 +1,340 @@
+/**
+ *  xEditor - Editor and tools for creating games
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "io/cachingimporter.hpp"
+
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <typeindex>
+#include <vector>
+
+#include "io/binaryio.hpp"
+#include "io/binaryscene.hpp"
+#include "headertool/contenthash.hpp"
+
+using namespace xng;
+
+// Increment when the layout of the cached entries or the encoding of a resource type changes
+static const uint32_t ENTRY_VERSION = 2;
+
+enum DependencyType : uint8_t {
+    DEPENDENCY_MISSING, // The importer checked that the file does not exist
+    DEPENDENCY_EXISTS, // The importer checked that the file exists
+    DEPENDENCY_OPENED, // The importer read the file, the hash of the contents is stored
+};
+
+struct Dependency {
+    DependencyType type;
+    std::string path;
+    uint64_t hash = 0;
+};
+
+/**
+ * Records the files which the wrapped importer queries or opens through the archive
+ * so that the cached resources are only used while the files are unchanged.
+ */
+class RecordingArchive : public Archive {
+public:
+    explicit RecordingArchive(Archive &archive) : archive(archive) {}
+
+    std::unique_ptr<std::istream> open(const std::string &path) override {
+        auto stream = archive.open(path);
+        if (!stream)
+            return stream;
+        std::string data((std::istreambuf_iterator<char>(*stream)), std::istreambuf_iterator<char>());
+        dependencies.push_back({DEPENDENCY_OPENED, path, hashContent(data)});
+        return std::make_unique<std::istringstream>(std::move(data));
+    }
+
+    bool exists(const std::string &path) override {
+        auto ret = archive.exists(path);
+        dependencies.push_back({ret ? DEPENDENCY_EXISTS : DEPENDENCY_MISSING, path});
+        return ret;
+    }
+
+    std::vector<Dependency> dependencies;
+
+private:
+    Archive &archive;
+};
+
+static void writeDependencies(BinaryWriter &writer, const std::vector<Dependency> &dependencies) {
+    writer.writeVarInt(dependencies.size());
+    for (auto &dependency: dependencies) {
+        writer.write<uint8_t>(dependency.type);
+        writer.writeString(dependency.path);
+        writer.write<uint64_t>(dependency.hash);
+    }
+}
+
+/**
+ * @return True if the files recorded for the entry still have the recorded state in the archive
+ */
+static bool checkDependencies(BinaryReader &reader, Archive *archive) {
+    auto count = reader.readVarInt();
+    for (auto i = 0u; i < count; i++) {
+        auto type = reader.read<uint8_t>();
+        auto path = reader.readString();
+        auto hash = reader.read<uint64_t>();
+        if (archive == nullptr)
+            return false;
+        switch (type) {
+            case DEPENDENCY_MISSING:
+                if (archive->exists(path))
+                    return false;
+                break;
+            case DEPENDENCY_EXISTS:
+                if (!archive->exists(path))
+                    return false;
+                break;
+            case DEPENDENCY_OPENED: {
+                if (!archive->exists(path))
+                    return false;
+                auto stream = archive->open(path);
+                if (!stream)
+                    return false;
+                std::string data((std::istreambuf_iterator<char>(*stream)), std::istreambuf_iterator<char>());
+                if (hashContent(data) != hash)
+                    return false;
+                break;
+            }
+            default:
+                return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Converts a resource type to and from the representation which is stored in the cache.
+ */
+struct ResourceCodec {
+    std::string name;
+    std::function<void(const Resource &, BinaryWriter &)> encode;
+    std::function<std::unique_ptr<Resource>(BinaryReader &)> decode;
+};
+
+/**
+ * Resources whose message is small, the message is stored in the binary value encoding of the scene files.
+ */
+template<typename T>
+static ResourceCodec messageableCodec(const std::string &name) {
+    return {name,
+            [](const Resource &resource, BinaryWriter &writer) {
+                Message message;
+                dynamic_cast<const T &>(resource) >> message;
+                BinaryScene::writeMessage(writer, message);
+            },
+            [](BinaryReader &reader) -> std::unique_ptr<Resource> {
+                auto ret = std::make_unique<T>();
+                *ret << BinaryScene::readMessage(reader);
+                return ret;
+            }};
+}
+
+static void encodeMesh(const Mesh &mesh, BinaryWriter &writer) {
+    // The members other than the buffers and sub meshes are small and stored as the message of a copy without them
+    Mesh properties = mesh;
+    properties.vertices.clear();
+    properties.indices.clear();
+    properties.subMeshes.clear();
+    Message message;
+    properties >> message;
+    BinaryScene::writeMessage(writer, message);
+
+    writer.writeVarInt(mesh.vertices.size());
+    for (auto &vertex: mesh.vertices) {
+        writer.writeString({reinterpret_cast<const char *>(vertex.buffer.data()),
+                            vertex.buffer.size() * sizeof(vertex.buffer[0])});
+    }
+
+    writer.writeVarInt(mesh.indices.size());
+    writer.writeBytes({reinterpret_cast<const char *>(mesh.indices.data()),
+                       mesh.indices.size() * sizeof(mesh.indices[0])});
+
+    writer.writeVarInt(mesh.subMeshes.size());
+    for (auto &subMesh: mesh.subMeshes) {
+        encodeMesh(subMesh, writer);
+    }
+}
+
+static void decodeMesh(Mesh &mesh, BinaryReader &reader) {
+    mesh << BinaryScene::readMessage(reader);
+
+    mesh.vertices.resize(reader.readVarInt());
+    for (auto &vertex: mesh.vertices) {
+        auto bytes = reader.readStringView();
+        vertex.buffer.resize(bytes.size() / sizeof(vertex.buffer[0]));
+        std::memcpy(vertex.buffer.data(), bytes.data(), vertex.buffer.size() * sizeof(vertex.buffer[0]));
+    }
+
+    auto indexCount = reader.readVarInt();
+    auto indices = reader.readBytes(indexCount * sizeof(mesh.indices[0]));
+    mesh.indices.resize(indexCount);
+    std::memcpy(mesh.indices.data(), indices.data(), indices.size());
+
+    mesh.subMeshes.resize(reader.readVarInt());
+    for (auto &subMesh: mesh.subMeshes) {
+        decodeMesh(subMesh, reader);
+    }
+}
+
+static const std::map<std::type_index, ResourceCodec> &getCodecs() {
+    static const std::map<std::type_index, ResourceCodec> codecs = {
+            {typeid(ImageRGBA), {"ImageRGBA",
+                                 [](const Resource &resource, BinaryWriter &writer) {
+                                     auto &image = dynamic_cast<const ImageRGBA &>(resource);
+                                     auto &buffer = image.getBuffer();
+                                     writer.writeVarInt(image.getWidth());
+                                     writer.writeVarInt(image.getHeight());
+                                     writer.writeBytes({reinterpret_cast<const char *>(buffer.data()),
+                                                        buffer.size() * sizeof(ColorRGBA)});
+                                 },
+                                 [](BinaryReader &reader) -> std::unique_ptr<Resource> {
+                                     auto width = reader.readVarInt();
+                                     auto height = reader.readVarInt();
+                                     auto bytes = reader.readBytes(width * height * sizeof(ColorRGBA));
+                                     std::vector<ColorRGBA> buffer(width * height);
+                                     std::memcpy(buffer.data(), bytes.data(), bytes.size());
+                                     return std::make_unique<ImageRGBA>(static_cast<int>(width),
+                                                                        static_cast<int>(height),
+                                                                        std::move(buffer));
+                                 }}},
+            {typeid(AudioData), {"AudioData",
+                                 [](const Resource &resource, BinaryWriter &writer) {
+                                     auto &audio = dynamic_cast<const AudioData &>(resource);
+                                     writer.writeVarInt(audio.format);
+                                     writer.writeVarInt(audio.frequency);
+                                     writer.writeString({reinterpret_cast<const char *>(audio.buffer.data()),
+                                                         audio.buffer.size()});
+                                 },
+                                 [](BinaryReader &reader) -> std::unique_ptr<Resource> {
+                                     auto ret = std::make_unique<AudioData>();
+                                     ret->format = static_cast<AudioFormat>(reader.readVarInt());
+                                     ret->frequency = static_cast<unsigned int>(reader.readVarInt());
+                                     auto bytes = reader.readStringView();
+                                     ret->buffer.assign(bytes.begin(), bytes.end());
+                                     return ret;
+                                 }}},
+            {typeid(Mesh), {"Mesh",
+                            [](const Resource &resource, BinaryWriter &writer) {
+                                encodeMesh(dynamic_cast<const Mesh &>(resource), writer);
+                            },
+                            [](BinaryReader &reader) -> std::unique_ptr<Resource> {
+                                auto ret = std::make_unique<Mesh>();
+                                decodeMesh(*ret, reader);
+                                return ret;
+                            }}},
+            {typeid(Material), messageableCodec<Material>("Material")},
+    };
+    return codecs;
+}
+
+static const ResourceCodec *findCodec(const std::string &name) {
+    for (auto &pair: getCodecs()) {
+        if (pair.second.name == name)
+            return &pair.second;
+    }
+    return nullptr;
+}
+
+/**
+ * @return True if all resources of the bundle could be encoded
+ */
+static bool encodeBundle(const ResourceBundle &bundle, BinaryWriter &writer) {
+    writer.writeVarInt(bundle.assets.size());
+    for (auto &pair: bundle.assets) {
+        auto it = getCodecs().find(pair.second->getTypeIndex());
+        if (it == getCodecs().end())
+            return false;
+        std::string resourceData;
+        BinaryWriter resourceWriter(resourceData);
+        it->second.encode(*pair.second, resourceWriter);
+        writer.writeString(pair.first);
+        writer.writeString(it->second.name);
+        writer.writeString(resourceData);
+    }
+    return true;
+}
+
+static ResourceBundle decodeBundle(BinaryReader &reader) {
+    ResourceBundle ret;
+    auto count = reader.readVarInt();
+    for (auto i = 0u; i < count; i++) {
+        auto name = reader.readString();
+        auto *codec = findCodec(reader.readString());
+        if (codec == nullptr)
+            throw std::runtime_error("Unknown resource codec");
+        BinaryReader resourceReader(reader.readStringView());
+        ret.add(name, codec->decode(resourceReader));
+    }
+    return ret;
+}
+
+CachingImporter::CachingImporter(std::unique_ptr<ResourceImporter> importer,
+                                 std::string id,
+                                 uint32_t version,
+                                 std::shared_ptr<DerivedDataCache> cache)
+        : importer(std::move(importer)), id(std::move(id)), version(version), cache(std::move(cache)) {}
+
+ResourceBundle CachingImporter::read(std::istream &stream,
+                                     const std::string &hint,
+                                     const std::string &path,
+                                     Archive *archive) {
+    if (!cache->isOpen())
+        return importer->read(stream, hint, path, archive);
+
+    std::string source((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+
+    std::string keyData;
+    BinaryWriter keyWriter(keyData);
+    keyWriter.write<uint32_t>(ENTRY_VERSION);
+    keyWriter.writeString(id);
+    keyWriter.write<uint32_t>(version);
+    keyWriter.writeString(hint);
+    auto key = hashContent(keyData, hashContent(source));
+
+    std::string data;
+    if (cache->get(key, data)) {
+        try {
+            BinaryReader reader(data);
+            if (checkDependencies(reader, archive))
+                return decodeBundle(reader);
+        } catch (const std::exception &e) {
+            // Entries which cannot be decoded are replaced below
+        }
+    }
+
+    std::istringstream sourceStream(source);
+    std::unique_ptr<RecordingArchive> recorder;
+    if (archive != nullptr)
+        recorder = std::make_unique<RecordingArchive>(*archive);
+    auto ret = importer->read(sourceStream, hint, path, recorder ? recorder.get() : nullptr);
+
+    data.clear();
+    BinaryWriter writer(data);
+    writeDependencies(writer, recorder ? recorder->dependencies : std::vector<Dependency>());
+    if (encodeBundle(ret, writer)) {
+        cache->put(key, data);
+    }
+    return ret;
+}
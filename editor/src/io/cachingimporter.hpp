@@ -0,0 +1,70 @@
+/**
+ *  xEditor - Editor and tools for creating games
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XEDITOR_CACHINGIMPORTER_HPP
+#define XEDITOR_CACHINGIMPORTER_HPP
+
+#include <memory>
+#include <string>
+
+#include "xng/xng.hpp"
+
+#include "io/deriveddatacache.hpp"
+
+/**
+ * Stores the resources imported by the wrapped importer in the derived data cache
+ * and returns the cached resources instead of importing the same source data again.
+ *
+ * The cache key is derived from the source data, the format hint and the importer id and version.
+ * The path is not part of the key so that imports ahead of time hit the cache regardless of how the path is spelled.
+ * The files which the wrapped importer queries or opens through the archive, such as material libraries,
+ * are stored with the entry and the entry is only used while their contents are unchanged.
+ *
+ * Bundles which contain resource types that cannot be encoded are not cached.
+ */
+class CachingImporter : public xng::ResourceImporter {
+public:
+    /**
+     * @param importer The importer which imports the source data on a cache miss
+     * @param id Identifies the importer in the cache key
+     * @param version Increment when the output of the importer changes to discard the previously cached resources
+     * @param cache
+     */
+    CachingImporter(std::unique_ptr<xng::ResourceImporter> importer,
+                    std::string id,
+                    uint32_t version,
+                    std::shared_ptr<DerivedDataCache> cache);
+
+    xng::ResourceBundle read(std::istream &stream,
+                             const std::string &hint,
+                             const std::string &path,
+                             xng::Archive *archive) override;
+
+    const std::set<std::string> &getSupportedFormats() const override {
+        return importer->getSupportedFormats();
+    }
+
+private:
+    std::unique_ptr<xng::ResourceImporter> importer;
+    std::string id;
+    uint32_t version;
+    std::shared_ptr<DerivedDataCache> cache;
+};
+
+#endif //XEDITOR_CACHINGIMPORTER_HPP
@@ -0,0 +1,252 @@
+/**
+ *  xEditor - Editor and tools for creating games
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "io/deriveddatacache.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+#include "io/binaryio.hpp"
+
+static const uint32_t ENTRY_MAGIC = 0x43444458; // XDDC
+
+static const char *ENTRY_EXTENSION = ".ddc";
+
+static const char *TEMPORARY_EXTENSION = ".tmp";
+
+static const size_t ENTRY_HEADER_SIZE = sizeof(uint32_t) * 2 + sizeof(uint64_t);
+
+static bool parseKey(const std::filesystem::path &file, uint64_t &key) {
+    if (file.extension() != ENTRY_EXTENSION)
+        return false;
+    auto stem = file.stem().string();
+    if (stem.size() != 16)
+        return false;
+    try {
+        size_t count = 0;
+        key = std::stoull(stem, &count, 16);
+        return count == stem.size();
+    } catch (const std::exception &e) {
+        return false;
+    }
+}
+
+DerivedDataCache::DerivedDataCache(uint64_t sizeLimit)
+        : sizeLimit(sizeLimit) {}
+
+void DerivedDataCache::open(const std::filesystem::path &dir) {
+    std::filesystem::create_directories(dir);
+
+    // Order the existing entries by the time of their last use
+    std::vector<std::pair<std::filesystem::file_time_type, uint64_t>> files;
+    std::unordered_map<uint64_t, Entry> existing;
+    uint64_t existingSize = 0;
+    for (auto &dirEntry: std::filesystem::directory_iterator(dir)) {
+        uint64_t key;
+        std::error_code error;
+        if (!dirEntry.is_regular_file(error))
+            continue;
+        if (dirEntry.path().extension() == TEMPORARY_EXTENSION) {
+            // Left behind by a put which was interrupted
+            std::filesystem::remove(dirEntry.path(), error);
+            continue;
+        }
+        if (!parseKey(dirEntry.path(), key))
+            continue;
+        auto fileSize = dirEntry.file_size(error);
+        auto time = dirEntry.last_write_time(error);
+        if (error)
+            continue;
+        files.emplace_back(time, key);
+        existing[key].size = fileSize;
+        existingSize += fileSize;
+    }
+    std::sort(files.begin(), files.end());
+    for (auto i = 0u; i < files.size(); i++) {
+        existing[files.at(i).second].lastUse = i;
+    }
+
+    std::lock_guard<std::mutex> guard(mutex);
+    directory = dir;
+    entries = std::move(existing);
+    size = existingSize;
+    useCounter = files.size();
+    evict();
+}
+
+void DerivedDataCache::close() {
+    std::lock_guard<std::mutex> guard(mutex);
+    directory.clear();
+    entries.clear();
+    size = 0;
+}
+
+bool DerivedDataCache::isOpen() const {
+    std::lock_guard<std::mutex> guard(mutex);
+    return !directory.empty();
+}
+
+bool DerivedDataCache::get(uint64_t key, std::string &data) {
+    std::filesystem::path file;
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        auto it = entries.find(key);
+        if (it == entries.end())
+            return false;
+        it->second.lastUse = ++useCounter;
+        file = getEntryFile(key);
+    }
+
+    // The file is read without holding the lock, a concurrent eviction makes the read fail which is reported as a miss
+    std::string buffer;
+    std::ifstream fs(file, std::ifstream::binary);
+    std::error_code error;
+    auto fileSize = std::filesystem::file_size(file, error);
+    if (fs && !error) {
+        buffer.resize(fileSize);
+        if (!fs.read(buffer.data(), static_cast<std::streamsize>(fileSize)))
+            buffer.clear();
+    }
+
+    try {
+        BinaryReader reader(buffer);
+        if (reader.read<uint32_t>() != ENTRY_MAGIC
+            || reader.read<uint32_t>() != VERSION
+            || reader.read<uint64_t>() != key) {
+            throw std::runtime_error("Invalid derived data entry");
+        }
+        data = buffer.substr(ENTRY_HEADER_SIZE);
+    } catch (const std::exception &e) {
+        std::lock_guard<std::mutex> guard(mutex);
+        if (!directory.empty() && getEntryFile(key) == file)
+            remove(key);
+        return false;
+    }
+
+    std::filesystem::last_write_time(file, std::filesystem::file_time_type::clock::now(), error);
+    return true;
+}
+
+void DerivedDataCache::put(uint64_t key, std::string_view data) {
+    std::string buffer;
+    BinaryWriter writer(buffer);
+    writer.write<uint32_t>(ENTRY_MAGIC);
+    writer.write<uint32_t>(VERSION);
+    writer.write<uint64_t>(key);
+    writer.writeBytes(data);
+
+    std::filesystem::path file;
+    std::filesystem::path tmpFile;
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        if (directory.empty() || buffer.size() > sizeLimit)
+            return;
+        file = getEntryFile(key);
+        // Concurrent puts of the same key write separate temporary files
+        tmpFile = file;
+        tmpFile += "." + std::to_string(++writeCounter) + TEMPORARY_EXTENSION;
+    }
+
+    // The file is written without holding the lock so that gets and puts of other workers are not blocked by the write,
+    // only the rename which publishes the entry is serialized with the index updates
+    std::error_code error;
+    try {
+        std::ofstream fs;
+        fs.exceptions(std::ofstream::badbit | std::ofstream::failbit);
+        fs.open(tmpFile, std::ofstream::binary | std::ofstream::trunc);
+        fs.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        fs.close();
+    } catch (...) {
+        std::filesystem::remove(tmpFile, error);
+        throw;
+    }
+
+    std::lock_guard<std::mutex> guard(mutex);
+    if (directory.empty() || getEntryFile(key) != file) {
+        // The cache was closed or opened in another directory while the file was written
+        std::filesystem::remove(tmpFile, error);
+        return;
+    }
+
+    std::filesystem::rename(tmpFile, file, error);
+    if (error) {
+        std::filesystem::remove(tmpFile, error);
+        throw std::runtime_error("Failed to store derived data entry: " + file.string());
+    }
+
+    auto it = entries.find(key);
+    if (it != entries.end()) {
+        size -= it->second.size;
+    }
+
+    auto &entry = entries[key];
+    entry.size = buffer.size();
+    entry.lastUse = ++useCounter;
+    size += entry.size;
+
+    evict();
+}
+
+uint64_t DerivedDataCache::getSize() const {
+    std::lock_guard<std::mutex> guard(mutex);
+    return size;
+}
+
+void DerivedDataCache::setSizeLimit(uint64_t value) {
+    std::lock_guard<std::mutex> guard(mutex);
+    sizeLimit = value;
+    evict();
+}
+
+std::filesystem::path DerivedDataCache::getEntryFile(uint64_t key) const {
+    char name[17];
+    std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(key));
+    return std::filesystem::path(directory).append(std::string(name) + ENTRY_EXTENSION);
+}
+
+void DerivedDataCache::evict() {
+    if (size <= sizeLimit)
+        return;
+
+    std::vector<std::pair<uint64_t, uint64_t>> order; // The last use and key of the entries
+    order.reserve(entries.size());
+    for (auto &pair: entries) {
+        order.emplace_back(pair.second.lastUse, pair.first);
+    }
+    std::sort(order.begin(), order.end());
+
+    for (auto &pair: order) {
+        if (size <= sizeLimit)
+            break;
+        remove(pair.second);
+    }
+}
+
+void DerivedDataCache::remove(uint64_t key) {
+    auto it = entries.find(key);
+    if (it == entries.end())
+        return;
+    std::error_code error;
+    std::filesystem::remove(getEntryFile(key), error);
+    size -= it->second.size;
+    entries.erase(it);
+}
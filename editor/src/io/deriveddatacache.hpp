@@ -0,0 +1,108 @@
+/**
+ *  xEditor - Editor and tools for creating games
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XEDITOR_DERIVEDDATACACHE_HPP
+#define XEDITOR_DERIVEDDATACACHE_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+/**
+ * A size limited directory of data which was derived from source files, for example imported resources.
+ *
+ * Every entry is stored in a separate file named after its key.
+ * When the size limit is exceeded the least recently used entries are removed,
+ * the modification time of the entry files records the last use so that the order persists between sessions.
+ *
+ * All methods can be called from any thread.
+ */
+class DerivedDataCache {
+public:
+    /**
+     * Increment when the entry file layout changes to discard previously written entries.
+     */
+    static const uint32_t VERSION = 1;
+
+    /**
+     * @param sizeLimit The maximum combined size of the entry files in bytes
+     */
+    explicit DerivedDataCache(uint64_t sizeLimit = 1024ull * 1024ull * 1024ull);
+
+    /**
+     * Use the entries in the directory, the directory is created if it does not exist.
+     *
+     * @param directory
+     */
+    void open(const std::filesystem::path &directory);
+
+    /**
+     * Stop using the directory, get and put do nothing until the cache is opened again.
+     */
+    void close();
+
+    bool isOpen() const;
+
+    /**
+     * @param key
+     * @param data Receives the data of the entry
+     * @return True if the entry exists, the entry is marked as recently used
+     */
+    bool get(uint64_t key, std::string &data);
+
+    /**
+     * Store the entry and remove the least recently used entries if the size limit is exceeded.
+     *
+     * @param key
+     * @param data
+     */
+    void put(uint64_t key, std::string_view data);
+
+    /**
+     * @return The combined size of the entry files in bytes
+     */
+    uint64_t getSize() const;
+
+    void setSizeLimit(uint64_t value);
+
+private:
+    struct Entry {
+        uint64_t size = 0;
+        uint64_t lastUse = 0; // Larger values were used more recently
+    };
+
+    std::filesystem::path getEntryFile(uint64_t key) const;
+
+    void evict();
+
+    void remove(uint64_t key);
+
+    mutable std::mutex mutex;
+    std::filesystem::path directory;
+    uint64_t sizeLimit;
+    uint64_t size = 0;
+    uint64_t useCounter = 0;
+    uint64_t writeCounter = 0;
+    std::unordered_map<uint64_t, Entry> entries;
+};
+
+#endif //XEDITOR_DERIVEDDATACACHE_HPP
@@ -0,0 +1,85 @@
+/**
+ *  xEditor - Editor and tools for creating games
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XEDITOR_FILEUTIL_HPP
+#define XEDITOR_FILEUTIL_HPP
+
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string_view>
+
+namespace FileUtil {
+    /**
+     * Write a temporary file next to path with the writer and rename it to path,
+     * readers of path never observe a partially written file.
+     * The temporary file is removed if the writer throws.
+     */
+    static inline void writeAtomic(const std::filesystem::path &path,
+                                   const std::function<void(std::ostream &stream)> &writer) {
+        auto tmpPath = path;
+        tmpPath += ".tmp";
+
+        try {
+            std::ofstream fs;
+            fs.exceptions(std::ofstream::badbit | std::ofstream::failbit);
+            fs.open(tmpPath, std::ofstream::binary | std::ofstream::trunc);
+            writer(fs);
+            fs.close();
+        } catch (...) {
+            std::error_code error;
+            std::filesystem::remove(tmpPath, error);
+            throw;
+        }
+
+        std::filesystem::rename(tmpPath, path);
+    }
+
+    /**
+     * Write the data to a temporary file next to path and rename it to path,
+     * readers of path never observe a partially written file.
+     */
+    static inline void writeAtomic(const std::filesystem::path &path, std::string_view data) {
+        writeAtomic(path, [&data](std::ostream &stream) {
+            stream.write(data.data(), static_cast<std::streamsize>(data.size()));
+        });
+    }
+
+    /**
+     * Write the data atomically if the contents of the file at path differ from data.
+     * The modification time of an unchanged file is preserved so that build systems do not consider it dirty.
+     *
+     * @return True if the file was written
+     */
+    static inline bool writeIfChanged(const std::filesystem::path &path, std::string_view data) {
+        std::error_code error;
+        auto size = std::filesystem::file_size(path, error);
+        if (!error && size == data.size()) {
+            std::ifstream fs(path, std::ifstream::binary);
+            std::string existing(size, '\0');
+            if (fs.read(existing.data(), static_cast<std::streamsize>(size)) && existing == data) {
+                return false;
+            }
+        }
+        writeAtomic(path, data);
+        return true;
+    }
+}
+
+#endif //XEDITOR_FILEUTIL_HPP
@@ -0,0 +1,357 @@
+/**
+ *  xEditor - Editor and tools for creating games
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "io/filewatcher.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#endif
+
+// Changes are reported after this many delays even if events keep arriving, eg. while copying a large directory.
+static const int MAXIMUM_DELAY_FACTOR = 8;
+
+static std::filesystem::path normalizeDirectory(const std::filesystem::path &path) {
+    auto ret = path.lexically_normal();
+    if (!ret.has_filename() && ret.has_parent_path()) {
+        ret = ret.parent_path(); // Remove the trailing separator
+    }
+    return ret;
+}
+
+static bool isHidden(const std::filesystem::path &path) {
+    auto name = path.filename().string();
+    return !name.empty() && name.front() == '.';
+}
+
+/**
+ * @return True if path equals directory or is contained in directory
+ */
+static bool isContained(const std::filesystem::path &directory, const std::filesystem::path &path) {
+    auto it = path.begin();
+    for (auto &element: directory) {
+        if (element.empty())
+            continue;
+        if (it == path.end() || *it != element)
+            return false;
+        ++it;
+    }
+    return true;
+}
+
+FileWatcher::Changes FileWatcher::Changes::filter(const std::set<std::filesystem::path> &directories) const {
+    Changes ret;
+    ret.overflow = overflow;
+    auto contained = [&directories](const std::filesystem::path &path) {
+        return std::any_of(directories.begin(), directories.end(), [&path](const std::filesystem::path &directory) {
+            return isContained(directory, path);
+        });
+    };
+    for (auto &path: modified) {
+        if (contained(path))
+            ret.modified.insert(path);
+    }
+    for (auto &path: removed) {
+        if (contained(path))
+            ret.removed.insert(path);
+    }
+    return ret;
+}
+
+FileWatcher::FileWatcher(std::chrono::milliseconds delay)
+        : delay(delay) {}
+
+FileWatcher::~FileWatcher() {
+    stop();
+}
+
+void FileWatcher::deliver(Changes &changes) {
+    if (!changes.empty() && listener) {
+        listener(changes);
+    }
+    changes = {};
+}
+
+#ifdef __linux__
+
+static const uint32_t WATCH_MASK = IN_CREATE
+                                   | IN_CLOSE_WRITE
+                                   | IN_DELETE
+                                   | IN_MOVED_FROM
+                                   | IN_MOVED_TO
+                                   | IN_DELETE_SELF
+                                   | IN_MOVE_SELF
+                                   | IN_ONLYDIR;
+
+void FileWatcher::start(const std::set<std::filesystem::path> &value, Listener callback) {
+    stop();
+
+    directories.clear();
+    for (auto &directory: value) {
+        directories.insert(normalizeDirectory(directory));
+    }
+    listener = std::move(callback);
+
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd < 0) {
+        throw std::runtime_error(std::string("Failed to create inotify instance: ") + std::strerror(errno));
+    }
+    stopFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (stopFd < 0) {
+        auto error = errno;
+        close(inotifyFd);
+        inotifyFd = -1;
+        throw std::runtime_error(std::string("Failed to create event descriptor: ") + std::strerror(error));
+    }
+
+    // The watches are added before returning so that no change after start() is missed
+    for (auto &directory: directories) {
+        addWatches(directory, nullptr);
+    }
+
+    thread = std::thread([this]() {
+        run();
+    });
+}
+
+void FileWatcher::stop() {
+    if (thread.joinable()) {
+        uint64_t value = 1;
+        if (write(stopFd, &value, sizeof(value)) < 0) {
+            // The thread cannot be woken up, it is still joined below because poll() returns on the next event.
+        }
+        thread.join();
+    }
+    if (inotifyFd >= 0) {
+        close(inotifyFd); // Closing the instance removes all watches
+        inotifyFd = -1;
+    }
+    if (stopFd >= 0) {
+        close(stopFd);
+        stopFd = -1;
+    }
+    watches.clear();
+}
+
+void FileWatcher::addWatches(const std::filesystem::path &directory, Changes *changes) {
+    auto wd = inotify_add_watch(inotifyFd, directory.c_str(), WATCH_MASK);
+    if (wd < 0) {
+        // Eg. the watch limit (fs.inotify.max_user_watches) was reached, changes in the directory are not reported.
+        if (changes)
+            changes->overflow = true;
+        return;
+    }
+    watches[wd] = directory;
+
+    // Files created before the watch was added would otherwise be missed
+    std::error_code error;
+    for (auto it = std::filesystem::directory_iterator(directory, error);
+         !error && it != std::filesystem::directory_iterator();
+         it.increment(error)) {
+        if (it->is_directory(error)) {
+            if (!isHidden(it->path()))
+                addWatches(it->path(), changes);
+        } else if (changes) {
+            changes->addModified(it->path());
+        }
+    }
+}
+
+void FileWatcher::removeWatches(const std::filesystem::path &directory) {
+    for (auto it = watches.begin(); it != watches.end();) {
+        if (isContained(directory, it->second)) {
+            inotify_rm_watch(inotifyFd, it->first);
+            it = watches.erase(it);
+        } else {
+            it++;
+        }
+    }
+}
+
+void FileWatcher::run() {
+    Changes pending;
+    auto firstEvent = std::chrono::steady_clock::now();
+    auto lastEvent = firstEvent;
+
+    alignas(inotify_event) char buffer[64 * 1024];
+
+    while (true) {
+        int timeout = -1;
+        if (!pending.empty()) {
+            auto deadline = std::min(lastEvent + delay, firstEvent + delay * MAXIMUM_DELAY_FACTOR);
+            auto now = std::chrono::steady_clock::now();
+            if (now >= deadline) {
+                deliver(pending);
+                continue;
+            }
+            timeout = static_cast<int>(std::chrono::ceil<std::chrono::milliseconds>(deadline - now).count());
+        }
+
+        pollfd fds[2] = {{inotifyFd, POLLIN, 0},
+                         {stopFd,    POLLIN, 0}};
+        if (poll(fds, 2, timeout) < 0) {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        if (fds[1].revents != 0) {
+            break;
+        }
+        if ((fds[0].revents & POLLIN) == 0) {
+            continue;
+        }
+
+        auto length = read(inotifyFd, buffer, sizeof(buffer));
+        if (length <= 0) {
+            continue;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (pending.empty()) {
+            firstEvent = now;
+        }
+        lastEvent = now;
+
+        for (auto *ptr = buffer; ptr < buffer + length;) {
+            auto *event = reinterpret_cast<const inotify_event *>(ptr);
+            ptr += sizeof(inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                pending.overflow = true;
+                continue;
+            }
+
+            auto it = watches.find(event->wd);
+            if (it == watches.end()) {
+                continue; // The watch was removed while the event was queued
+            }
+
+            if (event->mask & IN_IGNORED) {
+                watches.erase(it);
+                continue;
+            }
+
+            if (event->len == 0) {
+                // Events of the watched directory itself are reported through its parent,
+                // except for the watched root directories which have no watched parent.
+                if ((event->mask & (IN_DELETE_SELF | IN_MOVE_SELF)) && directories.count(it->second) != 0) {
+                    pending.addRemoved(it->second);
+                }
+                continue;
+            }
+
+            auto path = it->second / event->name;
+            if (event->mask & IN_ISDIR) {
+                if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+                    if (!isHidden(path))
+                        addWatches(path, &pending);
+                } else if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                    removeWatches(path);
+                    pending.addRemoved(path);
+                }
+            } else if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                pending.addRemoved(path);
+            } else {
+                pending.addModified(path);
+            }
+        }
+    }
+}
+
+#else
+
+void FileWatcher::start(const std::set<std::filesystem::path> &value, Listener callback) {
+    stop();
+
+    directories.clear();
+    for (auto &directory: value) {
+        directories.insert(normalizeDirectory(directory));
+    }
+    listener = std::move(callback);
+    stopRequested = false;
+
+    // The snapshot is created before returning so that no change after start() is missed
+    snapshot = createSnapshot();
+    thread = std::thread([this]() {
+        run();
+    });
+}
+
+void FileWatcher::stop() {
+    if (thread.joinable()) {
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            stopRequested = true;
+        }
+        stopCondition.notify_all();
+        thread.join();
+    }
+}
+
+FileWatcher::Snapshot FileWatcher::createSnapshot() const {
+    Snapshot ret;
+    for (auto &directory: directories) {
+        std::error_code error;
+        auto it = std::filesystem::recursive_directory_iterator(directory, error);
+        for (; !error && it != std::filesystem::recursive_directory_iterator(); it.increment(error)) {
+            if (it->is_directory(error)) {
+                if (isHidden(it->path()))
+                    it.disable_recursion_pending();
+                continue;
+            }
+            ret[it->path()] = it->last_write_time(error);
+        }
+    }
+    return ret;
+}
+
+void FileWatcher::run() {
+    // Without a platform notification api the directories are polled,
+    // the interval is larger than the delay because every poll walks all directories.
+    auto interval = delay * 4;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopCondition.wait_for(lock, interval, [this]() { return stopRequested; })) {
+        lock.unlock();
+        auto current = createSnapshot();
+        Changes changes;
+        for (auto &pair: current) {
+            auto it = snapshot.find(pair.first);
+            if (it == snapshot.end() || it->second != pair.second) {
+                changes.addModified(pair.first);
+            }
+        }
+        for (auto &pair: snapshot) {
+            if (current.find(pair.first) == current.end()) {
+                changes.addRemoved(pair.first);
+            }
+        }
+        snapshot = std::move(current);
+        deliver(changes);
+        lock.lock();
+    }
+}
+
+#endif
@@ -0,0 +1,142 @@
+/**
+ *  xEditor - Editor and tools for creating games
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XEDITOR_FILEWATCHER_HPP
+#define XEDITOR_FILEWATCHER_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+
+/**
+ * Watches directory trees on a background thread and reports the changed paths in debounced batches.
+ *
+ * On linux the watcher is backed by inotify, other platforms compare snapshots of the modification times.
+ * Hidden directories (eg. .git or the editor cache directory) are not watched.
+ */
+class FileWatcher {
+public:
+    struct Changes {
+        std::set<std::filesystem::path> modified; // The created or modified files
+        std::set<std::filesystem::path> removed; // The removed files or directories
+        bool overflow = false; // If true events were lost and consumers should rescan all files
+
+        bool empty() const {
+            return modified.empty() && removed.empty() && !overflow;
+        }
+
+        void addModified(const std::filesystem::path &path) {
+            removed.erase(path);
+            modified.insert(path);
+        }
+
+        void addRemoved(const std::filesystem::path &path) {
+            modified.erase(path);
+            removed.insert(path);
+        }
+
+        void merge(const Changes &other) {
+            for (auto &path: other.removed) {
+                addRemoved(path);
+            }
+            for (auto &path: other.modified) {
+                addModified(path);
+            }
+            overflow = overflow || other.overflow;
+        }
+
+        /**
+         * @return The changes of the paths which are contained in one of the directories
+         */
+        Changes filter(const std::set<std::filesystem::path> &directories) const;
+    };
+
+    /**
+     * Called on the watcher thread.
+     */
+    typedef std::function<void(const Changes &)> Listener;
+
+    /**
+     * @param delay The changes are reported once no event was received for this duration
+     */
+    explicit FileWatcher(std::chrono::milliseconds delay = std::chrono::milliseconds(250));
+
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher &other) = delete;
+
+    FileWatcher &operator=(const FileWatcher &other) = delete;
+
+    /**
+     * Start watching the directories recursively, stops the previous watch.
+     *
+     * Throws std::runtime_error if the platform watcher cannot be created.
+     *
+     * @param directories
+     * @param listener
+     */
+    void start(const std::set<std::filesystem::path> &directories, Listener listener);
+
+    /**
+     * Stop watching and join the watcher thread, pending changes are discarded.
+     * The listener is not invoked after stop returns.
+     */
+    void stop();
+
+    bool isRunning() const {
+        return thread.joinable();
+    }
+
+private:
+    void run();
+
+    void deliver(Changes &changes);
+
+#ifdef __linux__
+    void addWatches(const std::filesystem::path &directory, Changes *changes);
+
+    void removeWatches(const std::filesystem::path &directory);
+
+    int inotifyFd = -1;
+    int stopFd = -1;
+    std::map<int, std::filesystem::path> watches;
+#else
+    typedef std::map<std::filesystem::path, std::filesystem::file_time_type> Snapshot;
+
+    Snapshot createSnapshot() const;
+
+    Snapshot snapshot;
+
+    std::mutex mutex;
+    std::condition_variable stopCondition;
+    bool stopRequested = false;
+#endif
+
+    std::chrono::milliseconds delay;
+    std::set<std::filesystem::path> directories;
+    Listener listener;
+    std::thread thread;
+};
+
+#endif //XEDITOR_FILEWATCHER_HPP
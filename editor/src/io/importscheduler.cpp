@@ -0,0 +1,167 @@
+/**
+ *  xEditor - Editor and tools for creating games
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "io/importscheduler.hpp"
+
+void ImportScheduler::Request::cancel() {
+    if (task) {
+        scheduler->release(task);
+        task = nullptr;
+        scheduler = nullptr;
+    }
+}
+
+ImportScheduler::ImportScheduler(size_t threadCount)
+        : threadCount(std::max<size_t>(1, threadCount)) {}
+
+ImportScheduler::~ImportScheduler() {
+    stop();
+}
+
+void ImportScheduler::start(Importer imp, Listener lis) {
+    stop();
+    importer = std::move(imp);
+    listener = std::move(lis);
+    stopRequested = false;
+    for (auto i = 0u; i < threadCount; i++) {
+        threads.emplace_back([this]() { run(); });
+    }
+}
+
+void ImportScheduler::stop() {
+    std::map<QueueKey, std::shared_ptr<Task>> cancelled;
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        stopRequested = true;
+        cancelled = std::move(queue);
+        queue.clear();
+        for (auto &pair: cancelled) {
+            tasks.erase(pair.second->file);
+        }
+    }
+    condition.notify_all();
+    for (auto &pair: cancelled) {
+        pair.second->promise.set_exception(std::make_exception_ptr(Cancelled()));
+    }
+    for (auto &thread: threads) {
+        thread.join();
+    }
+    threads.clear();
+    importer = {};
+    listener = {};
+}
+
+ImportScheduler::Request ImportScheduler::schedule(const std::filesystem::path &file, Priority priority) {
+    Request ret;
+    ret.scheduler = this;
+
+    std::lock_guard<std::mutex> guard(mutex);
+    auto path = file.lexically_normal();
+    auto it = tasks.find(path);
+    if (it != tasks.end()) {
+        auto &task = it->second;
+        if (!task->running && priority < task->key.first) {
+            queue.erase(task->key);
+            task->key.first = priority;
+            queue[task->key] = task;
+            condition.notify_one();
+        }
+        task->requests++;
+        ret.task = task;
+        ret.future = task->future;
+        return ret;
+    }
+
+    auto task = std::make_shared<Task>();
+    task->file = path;
+    task->key = {priority, requestCounter++};
+    task->requests = 1;
+    task->future = task->promise.get_future().share();
+    ret.task = task;
+    ret.future = task->future;
+
+    if (threads.empty() || stopRequested) {
+        task->promise.set_exception(std::make_exception_ptr(Cancelled()));
+        return ret;
+    }
+
+    tasks[path] = task;
+    queue[task->key] = task;
+    condition.notify_one();
+    return ret;
+}
+
+size_t ImportScheduler::getQueuedCount() const {
+    std::lock_guard<std::mutex> guard(mutex);
+    return queue.size();
+}
+
+void ImportScheduler::run() {
+    while (true) {
+        std::shared_ptr<Task> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this]() { return stopRequested || !queue.empty(); });
+            if (stopRequested)
+                return;
+            auto it = queue.begin();
+            task = it->second;
+            queue.erase(it);
+            task->running = true;
+        }
+
+        std::exception_ptr exception;
+        try {
+            importer(task->file);
+        } catch (...) {
+            exception = std::current_exception();
+        }
+
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            auto it = tasks.find(task->file);
+            if (it != tasks.end() && it->second == task)
+                tasks.erase(it);
+        }
+
+        if (exception) {
+            task->promise.set_exception(exception);
+        } else {
+            task->promise.set_value();
+        }
+
+        if (listener) {
+            listener(task->file);
+        }
+    }
+}
+
+void ImportScheduler::release(const std::shared_ptr<Task> &task) {
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        if (task->requests == 0 || --task->requests > 0 || task->running)
+            return;
+        auto it = tasks.find(task->file);
+        if (it == tasks.end() || it->second != task)
+            return; // Finished or cancelled by stop
+        tasks.erase(it);
+        queue.erase(task->key);
+    }
+    task->promise.set_exception(std::make_exception_ptr(Cancelled()));
+}
@@ -0,0 +1,200 @@
+/**
+ *  xEditor - Editor and tools for creating games
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XEDITOR_IMPORTSCHEDULER_HPP
+#define XEDITOR_IMPORTSCHEDULER_HPP
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * Imports files on a pool of worker threads in the order of the priority of the requests.
+ *
+ * Concurrent requests of the same file share one import, the import runs with the highest requested priority.
+ */
+class ImportScheduler {
+public:
+    enum Priority {
+        PRIORITY_VIEWPORT = 0, // Referenced by the scene which is visible in the viewport
+        PRIORITY_INSPECTOR = 1, // Referenced by the entity which is selected in the inspector
+        PRIORITY_PREFETCH = 2, // Imported in the background before it is used
+    };
+
+    /**
+     * The exception which is stored in the future of an import that was cancelled before it started.
+     */
+    class Cancelled : public std::runtime_error {
+    public:
+        Cancelled() : std::runtime_error("Import cancelled") {}
+    };
+
+    /**
+     * Imports the file, called on a worker thread.
+     * Exceptions are stored in the future of the request.
+     */
+    typedef std::function<void(const std::filesystem::path &)> Importer;
+
+    /**
+     * Called on the worker thread after the import of a file finished or failed.
+     */
+    typedef std::function<void(const std::filesystem::path &)> Listener;
+
+private:
+    struct Task;
+
+public:
+    /**
+     * A request for the import of a file, the scheduler must outlive the request.
+     */
+    class Request {
+    public:
+        Request() = default;
+
+        Request(const Request &other) = delete;
+
+        Request &operator=(const Request &other) = delete;
+
+        Request(Request &&other) noexcept = default;
+
+        Request &operator=(Request &&other) noexcept = default;
+
+        /**
+         * @return The future which becomes ready when the import finished, failed or was cancelled
+         */
+        const std::shared_future<void> &getFuture() const {
+            return future;
+        }
+
+        /**
+         * @return True if the import finished, failed or was cancelled
+         */
+        bool isReady() const {
+            return future.valid() && future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+        }
+
+        /**
+         * Withdraw the request, the import is cancelled if it has not started and no other request for the file exists.
+         */
+        void cancel();
+
+        explicit operator bool() const {
+            return task != nullptr;
+        }
+
+    private:
+        friend class ImportScheduler;
+
+        ImportScheduler *scheduler = nullptr;
+        std::shared_ptr<Task> task;
+        std::shared_future<void> future;
+    };
+
+    /**
+     * @param threadCount The number of worker threads
+     */
+    explicit ImportScheduler(size_t threadCount = getDefaultThreadCount());
+
+    ~ImportScheduler();
+
+    ImportScheduler(const ImportScheduler &other) = delete;
+
+    ImportScheduler &operator=(const ImportScheduler &other) = delete;
+
+    /**
+     * Start the worker threads, stops the previously started workers.
+     *
+     * @param importer
+     * @param listener
+     */
+    void start(Importer importer, Listener listener);
+
+    /**
+     * Cancel the queued imports and join the worker threads after the running imports finished.
+     * The listener is not invoked after stop returns.
+     */
+    void stop();
+
+    bool isRunning() const {
+        return !threads.empty();
+    }
+
+    /**
+     * Queue the import of the file.
+     *
+     * If the file is already queued or being imported the request shares the pending import,
+     * a queued import is moved forward if the priority is higher than the priority of the previous requests.
+     * If the scheduler is not running the future of the request is cancelled.
+     *
+     * @param file
+     * @param priority
+     * @return The request which can be cancelled
+     */
+    Request schedule(const std::filesystem::path &file, Priority priority);
+
+    /**
+     * @return The number of imports which have not started yet
+     */
+    size_t getQueuedCount() const;
+
+    static size_t getDefaultThreadCount() {
+        return std::max(1u, std::thread::hardware_concurrency() / 2);
+    }
+
+private:
+    typedef std::pair<Priority, uint64_t> QueueKey; // Ordered by priority and then by the order of the requests
+
+    struct Task {
+        std::filesystem::path file;
+        QueueKey key;
+        bool running = false;
+        size_t requests = 0; // The number of requests which have not been cancelled
+        std::promise<void> promise;
+        std::shared_future<void> future;
+    };
+
+    void run();
+
+    void release(const std::shared_ptr<Task> &task);
+
+    size_t threadCount;
+
+    Importer importer;
+    Listener listener;
+    std::vector<std::thread> threads;
+
+    mutable std::mutex mutex;
+    std::condition_variable condition;
+    bool stopRequested = false;
+    uint64_t requestCounter = 0;
+    std::map<QueueKey, std::shared_ptr<Task>> queue;
+    std::map<std::filesystem::path, std::shared_ptr<Task>> tasks; // The queued and running tasks by file
+};
+
+#endif //XEDITOR_IMPORTSCHEDULER_HPP
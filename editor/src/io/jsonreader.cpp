@@ -0,0 +1,320 @@
+/**
+ *  xEditor - Editor and tools for creating games
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "io/jsonreader.hpp"
+
+#include <charconv>
+#include <map>
+#include <stdexcept>
+
+using namespace xng;
+
+static bool isWhitespace(int c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static void appendCodePoint(std::string &str, uint32_t codePoint) {
+    if (codePoint < 0x80) {
+        str.push_back(static_cast<char>(codePoint));
+    } else if (codePoint < 0x800) {
+        str.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+        str.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    } else if (codePoint < 0x10000) {
+        str.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+        str.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+        str.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    } else {
+        str.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+        str.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+        str.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+        str.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    }
+}
+
+JsonReader::JsonReader(std::istream &stream)
+        : buffer(*stream.rdbuf()) {}
+
+int JsonReader::peek() {
+    auto c = buffer.sgetc();
+    while (isWhitespace(c)) {
+        buffer.sbumpc();
+        offset++;
+        c = buffer.sgetc();
+    }
+    return c;
+}
+
+int JsonReader::get() {
+    auto c = buffer.sbumpc();
+    if (c != std::char_traits<char>::eof())
+        offset++;
+    return c;
+}
+
+void JsonReader::expect(char c) {
+    if (peek() != c)
+        error(std::string("Expected '") + c + "'");
+    get();
+}
+
+void JsonReader::expectLiteral(const char *literal) {
+    for (auto *c = literal; *c != 0; c++) {
+        if (get() != *c)
+            error(std::string("Expected ") + literal);
+    }
+}
+
+void JsonReader::error(const std::string &message) const {
+    throw std::runtime_error("Invalid json at offset " + std::to_string(offset) + ": " + message);
+}
+
+Message JsonReader::readValue() {
+    switch (peek()) {
+        case '{': {
+            std::map<std::string, Message> dictionary;
+            std::string key;
+            beginObject();
+            while (nextMember(key)) {
+                dictionary[key] = readValue();
+            }
+            return Message(dictionary);
+        }
+        case '[': {
+            std::vector<Message> list;
+            beginArray();
+            while (nextElement()) {
+                list.emplace_back(readValue());
+            }
+            return Message(list);
+        }
+        case '"':
+            return Message(readString());
+        case 't':
+            expectLiteral("true");
+            return Message(1LL);
+        case 'f':
+            expectLiteral("false");
+            return Message(0LL);
+        case 'n':
+            expectLiteral("null");
+            return {};
+        default:
+            return readNumber();
+    }
+}
+
+void JsonReader::skipValue() {
+    switch (peek()) {
+        case '{': {
+            std::string key;
+            beginObject();
+            while (nextMember(key)) {
+                skipValue();
+            }
+            break;
+        }
+        case '[':
+            beginArray();
+            while (nextElement()) {
+                skipValue();
+            }
+            break;
+        case '"':
+            skipString();
+            break;
+        case 't':
+            expectLiteral("true");
+            break;
+        case 'f':
+            expectLiteral("false");
+            break;
+        case 'n':
+            expectLiteral("null");
+            break;
+        default:
+            readNumber();
+            break;
+    }
+}
+
+void JsonReader::beginObject() {
+    expect('{');
+    containers.push_back(true);
+}
+
+bool JsonReader::nextMember(std::string &key) {
+    if (containers.empty())
+        error("Not inside an object");
+    if (peek() == '}') {
+        get();
+        containers.pop_back();
+        return false;
+    }
+    if (!containers.back())
+        expect(',');
+    containers.back() = false;
+    if (peek() != '"')
+        error("Expected member key");
+    key = readString();
+    expect(':');
+    return true;
+}
+
+void JsonReader::beginArray() {
+    expect('[');
+    containers.push_back(true);
+}
+
+bool JsonReader::nextElement() {
+    if (containers.empty())
+        error("Not inside an array");
+    if (peek() == ']') {
+        get();
+        containers.pop_back();
+        return false;
+    }
+    if (!containers.back())
+        expect(',');
+    containers.back() = false;
+    return true;
+}
+
+uint32_t JsonReader::readHex() {
+    uint32_t ret = 0;
+    for (int i = 0; i < 4; i++) {
+        auto c = get();
+        ret <<= 4;
+        if (c >= '0' && c <= '9')
+            ret |= c - '0';
+        else if (c >= 'a' && c <= 'f')
+            ret |= c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F')
+            ret |= c - 'A' + 10;
+        else
+            error("Invalid unicode escape");
+    }
+    return ret;
+}
+
+std::string JsonReader::readString() {
+    expect('"');
+    std::string ret;
+    while (true) {
+        auto c = get();
+        if (c == std::char_traits<char>::eof())
+            error("Unterminated string");
+        if (c == '"')
+            return ret;
+        if (c != '\\') {
+            ret.push_back(static_cast<char>(c));
+            continue;
+        }
+        switch (get()) {
+            case '"':
+                ret.push_back('"');
+                break;
+            case '\\':
+                ret.push_back('\\');
+                break;
+            case '/':
+                ret.push_back('/');
+                break;
+            case 'b':
+                ret.push_back('\b');
+                break;
+            case 'f':
+                ret.push_back('\f');
+                break;
+            case 'n':
+                ret.push_back('\n');
+                break;
+            case 'r':
+                ret.push_back('\r');
+                break;
+            case 't':
+                ret.push_back('\t');
+                break;
+            case 'u': {
+                auto codePoint = readHex();
+                if (codePoint >= 0xD800 && codePoint < 0xDC00) {
+                    expectLiteral("\\u");
+                    auto low = readHex();
+                    if (low < 0xDC00 || low >= 0xE000)
+                        error("Invalid surrogate pair");
+                    codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                }
+                appendCodePoint(ret, codePoint);
+                break;
+            }
+            default:
+                error("Invalid escape sequence");
+        }
+    }
+}
+
+void JsonReader::skipString() {
+    expect('"');
+    while (true) {
+        auto c = get();
+        if (c == std::char_traits<char>::eof())
+            error("Unterminated string");
+        if (c == '"')
+            return;
+        if (c == '\\')
+            get();
+    }
+}
+
+Message JsonReader::readNumber() {
+    std::string str;
+    bool integer = true;
+    while (true) {
+        auto c = buffer.sgetc();
+        if ((c >= '0' && c <= '9') || c == '-' || c == '+') {
+            str.push_back(static_cast<char>(c));
+        } else if (c == '.' || c == 'e' || c == 'E') {
+            str.push_back(static_cast<char>(c));
+            integer = false;
+        } else {
+            break;
+        }
+        get();
+    }
+    if (str.empty())
+        error("Unexpected character");
+
+    // from_chars is used because strtod depends on the locale which the QApplication sets from the environment
+    auto *begin = str.data();
+    auto *end = str.data() + str.size();
+    if (integer) {
+        long long value;
+        auto result = std::from_chars(begin, end, value);
+        if (result.ec == std::errc() && result.ptr == end)
+            return Message(value);
+        unsigned long long unsignedValue;
+        result = std::from_chars(begin, end, unsignedValue);
+        if (result.ec == std::errc() && result.ptr == end)
+            return Message(unsignedValue);
+    }
+    double value;
+    auto result = std::from_chars(begin, end, value);
+    if (result.ec != std::errc() || result.ptr != end)
+        error("Invalid number " + str);
+    return Message(value);
+}
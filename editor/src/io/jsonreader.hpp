@@ -0,0 +1,99 @@
+/**
+ *  xEditor - Editor and tools for creating games
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XEDITOR_JSONREADER_HPP
+#define XEDITOR_JSONREADER_HPP
+
+#include <istream>
+#include <string>
+#include <vector>
+
+#include "xng/xng.hpp"
+
+/**
+ * A pull parser for json text which allows callers to walk objects and arrays member by member
+ * and only build messages for the values they are interested in.
+ *
+ * Integers are returned as signed integers unless they do not fit into a long long,
+ * booleans are returned as the integers 1 and 0.
+ *
+ * Throws std::runtime_error on malformed input.
+ */
+class JsonReader {
+public:
+    explicit JsonReader(std::istream &stream);
+
+    /**
+     * @return The next non whitespace character without consuming it or EOF
+     */
+    int peek();
+
+    /**
+     * Read the next value into a message.
+     */
+    xng::Message readValue();
+
+    /**
+     * Consume the next value without building a message.
+     */
+    void skipValue();
+
+    void beginObject();
+
+    /**
+     * Consume the key of the next member of the current object,
+     * the caller must read or skip the value of the member before calling nextMember again.
+     *
+     * @param key Set to the key of the member
+     * @return False if the end of the object was consumed
+     */
+    bool nextMember(std::string &key);
+
+    void beginArray();
+
+    /**
+     * The caller must read or skip the element before calling nextElement again.
+     *
+     * @return False if the end of the array was consumed
+     */
+    bool nextElement();
+
+private:
+    int get();
+
+    void expect(char c);
+
+    void expectLiteral(const char *literal);
+
+    [[noreturn]] void error(const std::string &message) const;
+
+    std::string readString();
+
+    void skipString();
+
+    xng::Message readNumber();
+
+    uint32_t readHex();
+
+    std::streambuf &buffer;
+    size_t offset = 0;
+    std::vector<bool> containers; // True for every open container which has not yet returned an element or member
+};
+
+#endif //XEDITOR_JSONREADER_HPP
@@ -0,0 +1,150 @@
+/**
+ *  xEditor - Editor and tools for creating games
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "io/lazyscene.hpp"
+
+#include <limits>
+
+using namespace xng;
+
+static const char *ENTITIES_MEMBER = "entities";
+
+static void createComponent(EntityScene &scene, const EntityHandle &entity, const std::string &type, const Message &message) {
+    ComponentRegistry::instance().getDeserializer(type)(scene, entity, message);
+}
+
+LazyScene::LazyScene(const std::filesystem::path &path)
+        : file(path),
+          transformPool(std::numeric_limits<size_t>::max()) {
+    reader = std::make_unique<BinarySceneReader>(file.view());
+
+    auto transformType = ComponentRegistry::instance().getNameFromType(typeid(TransformComponent));
+    auto &types = reader->getComponentTypes();
+    for (size_t i = 0; i < types.size(); i++) {
+        if (reader->isTypedPool(i) && types.at(i) == transformType) {
+            transformPool = i;
+            break;
+        }
+    }
+}
+
+bool LazyScene::isSupported() const {
+    if (!reader->hasEntities())
+        return false;
+    for (auto &entity: reader->getEntities()) {
+        // Entities with other members than the name and a list of typed components have to be deserialized as a whole
+        if (entity.flags & ~BinaryScene::ENTITY_COMPONENT_LIST)
+            return false;
+        if (entity.properties.getType() != Message::DICTIONARY || !entity.properties.asDictionary().empty())
+            return false;
+        for (auto &component: entity.components) {
+            if (!reader->isTypedPool(component.pool))
+                return false;
+        }
+    }
+    return true;
+}
+
+Message LazyScene::readProperties() const {
+    auto properties = reader->readProperties();
+    std::map<std::string, Message> members;
+    if (properties.getType() == Message::DICTIONARY) {
+        members = properties.asDictionary();
+    }
+    members.erase(ENTITIES_MEMBER);
+    return Message(members);
+}
+
+std::vector<EntityHandle> LazyScene::populate(EntityScene &scene) {
+    auto members = readProperties().asDictionary();
+    members[ENTITIES_MEMBER] = Message(std::vector<Message>());
+    scene << Message(members);
+
+    auto &entities = reader->getEntities();
+    std::vector<EntityHandle> handles;
+    handles.reserve(entities.size());
+    for (auto &entity: entities) {
+        handles.emplace_back(entity.hasName ? scene.createEntity(entity.name).getHandle()
+                                            : scene.createEntity().getHandle());
+    }
+
+    // The transforms are created after all entities so that the parents exist when the hierarchy is built
+    for (size_t i = 0; i < entities.size(); i++) {
+        auto &entity = entities.at(i);
+        auto remaining = false;
+        for (auto &component: entity.components) {
+            if (component.pool == transformPool) {
+                createComponent(scene,
+                                handles.at(i),
+                                reader->getComponentTypes().at(transformPool),
+                                reader->readListComponent(component));
+            } else {
+                remaining = true;
+            }
+        }
+        if (remaining) {
+            pending[handles.at(i)] = i;
+        }
+    }
+    return handles;
+}
+
+void LazyScene::materialize(EntityScene &scene, const EntityHandle &entity) {
+    auto it = pending.find(entity);
+    if (it == pending.end())
+        return;
+    auto index = it->second;
+    pending.erase(it);
+    materialize(scene, entity, index);
+}
+
+std::vector<EntityHandle> LazyScene::materialize(EntityScene &scene, std::chrono::milliseconds budget) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<EntityHandle> ret;
+    while (!pending.empty()) {
+        auto it = pending.begin();
+        auto entity = it->first;
+        auto index = it->second;
+        pending.erase(it);
+        materialize(scene, entity, index);
+        ret.emplace_back(entity);
+        if (std::chrono::steady_clock::now() - start >= budget)
+            break;
+    }
+    return ret;
+}
+
+void LazyScene::materializeAll(EntityScene &scene) {
+    while (!pending.empty()) {
+        auto it = pending.begin();
+        auto entity = it->first;
+        auto index = it->second;
+        pending.erase(it);
+        materialize(scene, entity, index);
+    }
+}
+
+void LazyScene::materialize(EntityScene &scene, const EntityHandle &entity, size_t index) {
+    auto &types = reader->getComponentTypes();
+    for (auto &component: reader->getEntities().at(index).components) {
+        if (component.pool == transformPool)
+            continue; // Created by populate
+        createComponent(scene, entity, types.at(component.pool), reader->readListComponent(component));
+    }
+}
@@ -0,0 +1,109 @@
+/**
+ *  xEditor - Editor and tools for creating games
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XEDITOR_LAZYSCENE_HPP
+#define XEDITOR_LAZYSCENE_HPP
+
+#include <chrono>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "xng/xng.hpp"
+
+#include "io/binaryscene.hpp"
+
+#include "headertool/mappedfile.hpp"
+
+/**
+ * Loads a binary scene from its entity index and materializes the components of the entities on demand.
+ *
+ * populate creates every entity of the index with its name and transform component
+ * so that the hierarchy can be displayed without decoding the other component pools.
+ * The remaining components of an entity are read from the file when the entity is materialized.
+ *
+ * The file stays mapped until the LazyScene is destroyed.
+ */
+class LazyScene {
+public:
+    /**
+     * Throws std::runtime_error if the file cannot be mapped or is not a valid binary scene.
+     */
+    explicit LazyScene(const std::filesystem::path &path);
+
+    /**
+     * @return False if the scene contains entities which can only be loaded by deserializing the entity message
+     */
+    bool isSupported() const;
+
+    /**
+     * @return The members of the scene message except the entities list
+     */
+    xng::Message readProperties() const;
+
+    /**
+     * Deserialize the scene properties and create the entities of the index with their name and transform.
+     *
+     * @return The created entities in the order of the entities list of the file
+     */
+    std::vector<xng::EntityHandle> populate(xng::EntityScene &scene);
+
+    /**
+     * @return True if all entities have been materialized
+     */
+    bool isComplete() const {
+        return pending.empty();
+    }
+
+    bool isMaterialized(const xng::EntityHandle &entity) const {
+        return pending.find(entity) == pending.end();
+    }
+
+    /**
+     * Create the remaining components of the entity if it has not been materialized yet.
+     */
+    void materialize(xng::EntityScene &scene, const xng::EntityHandle &entity);
+
+    /**
+     * Materialize entities in index order until the time budget is used up.
+     *
+     * @return The materialized entities
+     */
+    std::vector<xng::EntityHandle> materialize(xng::EntityScene &scene, std::chrono::milliseconds budget);
+
+    void materializeAll(xng::EntityScene &scene);
+
+    /**
+     * Stop tracking an entity which has been destroyed before it was materialized.
+     */
+    void remove(const xng::EntityHandle &entity) {
+        pending.erase(entity);
+    }
+
+private:
+    void materialize(xng::EntityScene &scene, const xng::EntityHandle &entity, size_t index);
+
+    xng::MappedFile file;
+    std::unique_ptr<BinarySceneReader> reader;
+    size_t transformPool;
+    std::map<xng::EntityHandle, size_t> pending; // The index of the entities which have not been materialized yet
+};
+
+#endif //XEDITOR_LAZYSCENE_HPP
@@ -62,13 +62,39 @@ namespace Paths {
         return "plugin/";
     }
 
-    static inline QString pluginLibraryFileName() {
-        return xng::Library::getPlatformFilePrefix() + QString("plugin") + xng::Library::getPlatformFileExtension();
+    static inline QString projectCacheDirectory() {
+        return ".xeditor/";
+    }
+
+    static inline QString headerIndexFileName() {
+        return "header-index.bin";
+    }
+
+    static inline QString accessTraceFileName() {
+        return "access-trace.txt";
+    }
+
+    static inline QString pakManifestDirectory() {
+        return "bundles/";
+    }
+
+    static inline QString derivedDataDirectory() {
+        return "derived/";
     }
 
-    static inline std::filesystem::path generatedHeaderFileName(const std::filesystem::path &filename){
-        auto name = filename;
-        return name.replace_extension().string() + ".generated" + filename.extension().string();
+    /**
+     * @return The path of the header tool executable which is installed next to the editor executable
+     */
+    static inline std::filesystem::path headerToolExecutablePath() {
+#ifdef _WIN32
+        return QCoreApplication::applicationDirPath().toStdString() + "/xheadertool.exe";
+#else
+        return QCoreApplication::applicationDirPath().toStdString() + "/xheadertool";
+#endif
+    }
+
+    static inline QString pluginLibraryFileName() {
+        return xng::Library::getPlatformFilePrefix() + QString("plugin") + xng::Library::getPlatformFileExtension();
     }
 }
 #endif //XNG_EDITOR_PATHS_HPP
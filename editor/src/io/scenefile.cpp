@@ -0,0 +1,79 @@
+/**
+ *  xEditor - Editor and tools for creating games
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "io/scenefile.hpp"
+
+#include <fstream>
+#include <stdexcept>
+
+#include "io/binaryscene.hpp"
+#include "io/fileutil.hpp"
+#include "xng/io/protocol/jsonprotocol.hpp"
+#include "headertool/mappedfile.hpp"
+
+using namespace xng;
+
+SceneFile::Format SceneFile::detectFormat(const std::filesystem::path &path) {
+    std::ifstream fs(path, std::ifstream::binary);
+    if (!fs)
+        throw std::runtime_error("Failed to open scene file: " + path.string());
+    char magic[4]{};
+    fs.read(magic, sizeof(magic));
+    return BinaryScene::isBinaryScene({magic, static_cast<size_t>(fs.gcount())}) ? FORMAT_BINARY : FORMAT_JSON;
+}
+
+SceneFile::Format SceneFile::getFormatFromExtension(const std::filesystem::path &path) {
+    return path.extension().string() == getExtension(FORMAT_BINARY) ? FORMAT_BINARY : FORMAT_JSON;
+}
+
+std::string SceneFile::getExtension(SceneFile::Format format) {
+    switch (format) {
+        case FORMAT_BINARY:
+            return ".xscene";
+        case FORMAT_JSON:
+        default:
+            return ".json";
+    }
+}
+
+Message SceneFile::read(const std::filesystem::path &path) {
+    if (detectFormat(path) == FORMAT_BINARY) {
+        MappedFile file(path);
+        return BinarySceneReader(file.view()).read();
+    } else {
+        std::ifstream fs(path);
+        return JsonProtocol().deserialize(fs);
+    }
+}
+
+void SceneFile::write(const std::filesystem::path &path, const Message &scene, SceneFile::Format format) {
+    FileUtil::writeAtomic(path, [&scene, format](std::ostream &stream) {
+        if (format == FORMAT_BINARY) {
+            BinarySceneWriter(stream).write(scene);
+        } else {
+            JsonProtocol().serialize(stream, scene);
+        }
+    });
+}
+
+void SceneFile::convert(const std::filesystem::path &input,
+                        const std::filesystem::path &output,
+                        SceneFile::Format format) {
+    write(output, read(input), format);
+}
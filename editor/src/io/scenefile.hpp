@@ -0,0 +1,71 @@
+/**
+ *  xEditor - Editor and tools for creating games
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XEDITOR_SCENEFILE_HPP
+#define XEDITOR_SCENEFILE_HPP
+
+#include <filesystem>
+#include <string>
+
+#include "xng/xng.hpp"
+
+/**
+ * Reads and writes scene files in either the json or the binary scene format.
+ *
+ * The format of existing files is detected from their content, the extension is only used to select
+ * the format of new files.
+ */
+class SceneFile {
+public:
+    enum Format {
+        FORMAT_JSON,
+        FORMAT_BINARY
+    };
+
+    /**
+     * @return The format of the existing scene file at path
+     */
+    static Format detectFormat(const std::filesystem::path &path);
+
+    /**
+     * @return FORMAT_BINARY if path has the binary scene extension otherwise FORMAT_JSON
+     */
+    static Format getFormatFromExtension(const std::filesystem::path &path);
+
+    static std::string getExtension(Format format);
+
+    /**
+     * Throws std::runtime_error if the file cannot be read or parsed.
+     *
+     * @return The scene message stored in the file at path
+     */
+    static xng::Message read(const std::filesystem::path &path);
+
+    /**
+     * Atomically write the scene message to path.
+     */
+    static void write(const std::filesystem::path &path, const xng::Message &scene, Format format);
+
+    /**
+     * Read the scene file at input in any format and write it to output in the specified format.
+     */
+    static void convert(const std::filesystem::path &input, const std::filesystem::path &output, Format format);
+};
+
+#endif //XEDITOR_SCENEFILE_HPP
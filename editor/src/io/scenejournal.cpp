@@ -0,0 +1,426 @@
+/**
+ *  xEditor - Editor and tools for creating games
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "io/scenejournal.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <map>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "io/binaryio.hpp"
+#include "io/binaryscene.hpp"
+#include "io/fileutil.hpp"
+#include "io/scenefile.hpp"
+
+#include "headertool/contenthash.hpp"
+#include "headertool/mappedfile.hpp"
+
+using namespace xng;
+
+static const char JOURNAL_MAGIC[4] = {'X', 'J', 'N', 'L'};
+
+static const size_t RECORD_HEADER_SIZE = sizeof(uint32_t) + sizeof(uint64_t);
+
+namespace {
+    struct Header {
+        uint64_t sceneSize = 0;
+        int64_t sceneTime = 0;
+        std::vector<uint64_t> entities;
+    };
+}
+
+static Header readHeader(BinaryReader &reader) {
+    if (reader.readBytes(sizeof(JOURNAL_MAGIC)) != std::string_view(JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC)))
+        throw std::runtime_error("Invalid scene journal");
+    if (reader.read<uint32_t>() != SceneJournal::VERSION)
+        throw std::runtime_error("Unsupported scene journal version");
+    Header ret;
+    ret.sceneSize = reader.read<uint64_t>();
+    ret.sceneTime = reader.read<int64_t>();
+    auto count = reader.readVarInt();
+    for (auto i = 0u; i < count; i++) {
+        ret.entities.emplace_back(reader.readVarInt());
+    }
+    return ret;
+}
+
+/**
+ * @param payload Set to the payload of the next record
+ * @return False at the end of the journal or if the next record was not completely written
+ */
+static bool readRecord(BinaryReader &reader, size_t size, std::string_view &payload) {
+    if (size - reader.getOffset() < RECORD_HEADER_SIZE)
+        return false;
+    auto payloadSize = reader.read<uint32_t>();
+    auto hash = reader.read<uint64_t>();
+    if (payloadSize > size - reader.getOffset())
+        return false;
+    payload = reader.readBytes(payloadSize);
+    return hashContent(payload) == hash;
+}
+
+/**
+ * The size and write time identify the version of the scene file which the journal applies to.
+ */
+static std::pair<uint64_t, int64_t> getSceneStamp(const std::filesystem::path &sceneFile) {
+    return {std::filesystem::file_size(sceneFile),
+            static_cast<int64_t>(std::filesystem::last_write_time(sceneFile).time_since_epoch().count())};
+}
+
+static std::string createHeader(const std::filesystem::path &sceneFile, const std::vector<uint64_t> &entities) {
+    auto stamp = getSceneStamp(sceneFile);
+    std::string ret;
+    BinaryWriter writer(ret);
+    writer.writeBytes({JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC)});
+    writer.write<uint32_t>(SceneJournal::VERSION);
+    writer.write<uint64_t>(stamp.first);
+    writer.write<int64_t>(stamp.second);
+    writer.writeVarInt(entities.size());
+    for (auto &entity: entities) {
+        writer.writeVarInt(entity);
+    }
+    return ret;
+}
+
+#ifdef _WIN32
+static int openAppend(const std::filesystem::path &path) {
+    return _wopen(path.wstring().c_str(), _O_WRONLY | _O_APPEND | _O_BINARY);
+}
+
+static bool writeFile(int fd, std::string_view data) {
+    while (!data.empty()) {
+        auto count = _write(fd, data.data(), static_cast<unsigned int>(std::min<size_t>(data.size(), INT_MAX)));
+        if (count <= 0)
+            return false;
+        data = data.substr(static_cast<size_t>(count));
+    }
+    return true;
+}
+
+static bool syncFile(int fd) {
+    return _commit(fd) == 0;
+}
+
+static void closeFile(int fd) {
+    _close(fd);
+}
+#else
+static int openAppend(const std::filesystem::path &path) {
+    return ::open(path.c_str(), O_WRONLY | O_APPEND | O_CLOEXEC);
+}
+
+static bool writeFile(int fd, std::string_view data) {
+    while (!data.empty()) {
+        auto count = ::write(fd, data.data(), data.size());
+        if (count < 0 && errno == EINTR)
+            continue;
+        if (count <= 0)
+            return false;
+        data = data.substr(static_cast<size_t>(count));
+    }
+    return true;
+}
+
+static bool syncFile(int fd) {
+    return ::fsync(fd) == 0;
+}
+
+static void closeFile(int fd) {
+    ::close(fd);
+}
+#endif
+
+std::filesystem::path SceneJournal::getJournalPath(const std::filesystem::path &sceneFile) {
+    auto ret = sceneFile;
+    ret += ".journal";
+    return ret;
+}
+
+bool SceneJournal::canRecover(const std::filesystem::path &sceneFile) {
+    auto path = getJournalPath(sceneFile);
+    std::error_code error;
+    if (!std::filesystem::exists(path, error))
+        return false;
+    try {
+        MappedFile file(path);
+        BinaryReader reader(file.view());
+        auto header = readHeader(reader);
+        return getSceneStamp(sceneFile) == std::make_pair(header.sceneSize, header.sceneTime)
+               && !reader.atEnd();
+    } catch (const std::exception &) {
+        return false;
+    }
+}
+
+SceneJournal::Recovery SceneJournal::recover(const std::filesystem::path &sceneFile) {
+    MappedFile file(getJournalPath(sceneFile));
+    auto data = file.view();
+    BinaryReader reader(data);
+    auto header = readHeader(reader);
+    if (getSceneStamp(sceneFile) != std::make_pair(header.sceneSize, header.sceneTime))
+        throw std::runtime_error("The scene file was modified after the journal was started");
+
+    auto scene = SceneFile::read(sceneFile);
+    if (scene.getType() != Message::DICTIONARY
+        || !scene.has("entities")
+        || scene["entities"].getType() != Message::LIST) {
+        throw std::runtime_error("The scene file does not contain an entities list");
+    }
+
+    // The entities of the scene file are not copied, the journaled entities are stored separately by slot
+    const auto &entities = scene["entities"].asList();
+    std::map<size_t, Message> journaled;
+    auto slotCount = entities.size();
+    if (entities.size() != header.entities.size())
+        throw std::runtime_error("The journal does not match the entities of the scene file");
+
+    std::map<uint64_t, size_t> slots; // The index in entities by entity id
+    for (auto i = 0u; i < header.entities.size(); i++) {
+        slots[header.entities[i]] = i;
+    }
+
+    std::string_view payload;
+    while (readRecord(reader, data.size(), payload)) {
+        BinaryReader record(payload);
+        switch (record.read<uint8_t>()) {
+            case RECORD_CREATE: {
+                auto id = record.readVarInt();
+                slots[id] = slotCount;
+                journaled[slotCount++] = BinaryScene::readMessage(record);
+                break;
+            }
+            case RECORD_UPDATE: {
+                auto it = slots.find(record.readVarInt());
+                if (it != slots.end())
+                    journaled[it->second] = BinaryScene::readMessage(record);
+                break;
+            }
+            case RECORD_DESTROY:
+                slots.erase(record.readVarInt());
+                break;
+            case RECORD_REMAP: {
+                std::map<uint64_t, size_t> remapped;
+                auto count = record.readVarInt();
+                for (auto i = 0u; i < count; i++) {
+                    auto previous = record.readVarInt();
+                    auto id = record.readVarInt();
+                    auto it = slots.find(previous);
+                    if (it != slots.end())
+                        remapped[id] = it->second;
+                }
+                slots = std::move(remapped);
+                break;
+            }
+            default:
+                throw std::runtime_error("Invalid scene journal record type");
+        }
+    }
+
+    std::map<size_t, uint64_t> ids;
+    for (auto &pair: slots) {
+        ids[pair.second] = pair.first;
+    }
+
+    Recovery ret;
+    std::vector<Message> recovered;
+    recovered.reserve(ids.size());
+    for (auto &pair: ids) {
+        auto it = journaled.find(pair.first);
+        if (it != journaled.end())
+            recovered.emplace_back(std::move(it->second));
+        else
+            recovered.emplace_back(entities.at(pair.first));
+        ret.entities.emplace_back(pair.second);
+    }
+
+    std::map<std::string, Message> members;
+    for (auto &pair: scene.asDictionary()) {
+        if (pair.first != "entities")
+            members.insert(pair);
+    }
+    members["entities"] = Message(recovered);
+    ret.scene = Message(members);
+    return ret;
+}
+
+SceneJournal::~SceneJournal() {
+    try {
+        close();
+    } catch (const std::exception &) {
+        // The records which could not be written are lost
+    }
+}
+
+void SceneJournal::start(const std::filesystem::path &file, const std::vector<uint64_t> &entities) {
+    close();
+    open(file, createHeader(file, entities), {});
+}
+
+void SceneJournal::resume(const std::filesystem::path &file,
+                          const std::vector<uint64_t> &previous,
+                          const std::vector<uint64_t> &entities) {
+    if (previous.size() != entities.size())
+        throw std::runtime_error("The recovered entities do not match the journal");
+
+    close();
+
+    std::string records;
+    {
+        MappedFile journal(getJournalPath(file));
+        records = std::string(journal.view());
+    }
+
+    std::string payload;
+    BinaryWriter writer(payload);
+    writer.write<uint8_t>(RECORD_REMAP);
+    writer.writeVarInt(entities.size());
+    for (auto i = 0u; i < entities.size(); i++) {
+        writer.writeVarInt(previous[i]);
+        writer.writeVarInt(entities[i]);
+    }
+
+    // The journal is rewritten without a torn record at the end so that the remap record is not ignored
+    BinaryReader reader(records);
+    readHeader(reader);
+    auto end = reader.getOffset();
+    std::string_view record;
+    while (readRecord(reader, records.size(), record)) {
+        end = reader.getOffset();
+    }
+    records.resize(end);
+
+    open(file, {}, records);
+
+    appendRecord(payload);
+    sync();
+}
+
+void SceneJournal::compact(const std::filesystem::path &file, const std::vector<uint64_t> &entities, uint64_t mark) {
+    sync();
+
+    std::string records;
+    if (isOpen() && mark < fileSize) {
+        MappedFile journal(journalFile);
+        records = std::string(journal.view().substr(mark));
+    }
+
+    auto previousFile = journalFile;
+    close();
+    open(file, createHeader(file, entities), records);
+
+    if (!previousFile.empty() && previousFile != journalFile) {
+        std::error_code error;
+        std::filesystem::remove(previousFile, error);
+    }
+}
+
+void SceneJournal::close() {
+    if (!isOpen())
+        return;
+    try {
+        sync();
+    } catch (...) {
+        closeFile(fd);
+        fd = -1;
+        pending.clear();
+        throw;
+    }
+    closeFile(fd);
+    fd = -1;
+    fileSize = 0;
+}
+
+void SceneJournal::discard() {
+    if (isOpen()) {
+        closeFile(fd);
+        fd = -1;
+        fileSize = 0;
+        pending.clear();
+    }
+    if (!journalFile.empty()) {
+        std::error_code error;
+        std::filesystem::remove(journalFile, error);
+    }
+    sceneFile.clear();
+    journalFile.clear();
+}
+
+void SceneJournal::appendCreate(uint64_t entity, const Message &message) {
+    std::string payload;
+    BinaryWriter writer(payload);
+    writer.write<uint8_t>(RECORD_CREATE);
+    writer.writeVarInt(entity);
+    BinaryScene::writeMessage(writer, message);
+    appendRecord(payload);
+}
+
+void SceneJournal::appendUpdate(uint64_t entity, const Message &message) {
+    std::string payload;
+    BinaryWriter writer(payload);
+    writer.write<uint8_t>(RECORD_UPDATE);
+    writer.writeVarInt(entity);
+    BinaryScene::writeMessage(writer, message);
+    appendRecord(payload);
+}
+
+void SceneJournal::appendDestroy(uint64_t entity) {
+    std::string payload;
+    BinaryWriter writer(payload);
+    writer.write<uint8_t>(RECORD_DESTROY);
+    writer.writeVarInt(entity);
+    appendRecord(payload);
+}
+
+void SceneJournal::sync() {
+    if (!isOpen() || pending.empty())
+        return;
+    if (!writeFile(fd, pending) || !syncFile(fd))
+        throw std::runtime_error("Failed to write scene journal: " + journalFile.string());
+    fileSize += pending.size();
+    pending.clear();
+}
+
+void SceneJournal::open(const std::filesystem::path &file, const std::string &header, std::string_view records) {
+    sceneFile = file;
+    journalFile = getJournalPath(file);
+    FileUtil::writeAtomic(journalFile, header + std::string(records));
+    fd = openAppend(journalFile);
+    if (fd < 0)
+        throw std::runtime_error("Failed to open scene journal: " + journalFile.string());
+    fileSize = header.size() + records.size();
+}
+
+void SceneJournal::appendRecord(const std::string &payload) {
+    if (!isOpen())
+        throw std::runtime_error("Scene journal is not open");
+    BinaryWriter writer(pending);
+    writer.write<uint32_t>(static_cast<uint32_t>(payload.size()));
+    writer.write<uint64_t>(hashContent(payload));
+    writer.writeBytes(payload);
+}
@@ -0,0 +1,166 @@
+/**
+ *  xEditor - Editor and tools for creating games
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XEDITOR_SCENEJOURNAL_HPP
+#define XEDITOR_SCENEJOURNAL_HPP
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "xng/xng.hpp"
+
+/**
+ * An append only log of the entity modifications made since a scene file was saved,
+ * the unsaved modifications can be recovered by replaying the journal on top of the scene file.
+ *
+ * Entities are identified by ids which are only valid while the journal is written,
+ * the header maps the ids to the entities of the scene file by their index in the entities list.
+ *
+ * Layout, all fixed size integers are little endian:
+ *
+ *  Header      "XJNL" magic, uint32 version,
+ *              uint64 scene file size, int64 scene file write time,
+ *              varint entity count followed by the varint id of every entity of the scene file
+ *  Records     uint32 size, uint64 content hash of the payload, payload:
+ *                  uint8 type
+ *                  RECORD_CREATE   varint id, entity message
+ *                  RECORD_UPDATE   varint id, entity message
+ *                  RECORD_DESTROY  varint id
+ *                  RECORD_REMAP    varint count followed by the varint old and new id of every entity,
+ *                                  entities which are not remapped are destroyed
+ *
+ * Entity messages are encoded with BinaryScene::writeMessage.
+ * Records are buffered and written and synced to disk in batches by sync().
+ * A record with an invalid size or hash ends the journal because it was not completely written.
+ */
+class SceneJournal {
+public:
+    static const uint32_t VERSION = 1;
+
+    enum RecordType : uint8_t {
+        RECORD_CREATE,
+        RECORD_UPDATE,
+        RECORD_DESTROY,
+        RECORD_REMAP
+    };
+
+    struct Recovery {
+        xng::Message scene; // The scene message with the journal applied
+        std::vector<uint64_t> entities; // The journal ids of the entities of the scene message in list order
+    };
+
+    static std::filesystem::path getJournalPath(const std::filesystem::path &sceneFile);
+
+    /**
+     * @return True if the journal of the scene file contains records and the scene file was not modified
+     * after the journal was started
+     */
+    static bool canRecover(const std::filesystem::path &sceneFile);
+
+    /**
+     * Read the scene file and apply the records of its journal.
+     *
+     * Throws std::runtime_error if the journal cannot be read or does not belong to the scene file.
+     */
+    static Recovery recover(const std::filesystem::path &sceneFile);
+
+    SceneJournal() = default;
+
+    ~SceneJournal();
+
+    SceneJournal(const SceneJournal &other) = delete;
+
+    SceneJournal &operator=(const SceneJournal &other) = delete;
+
+    /**
+     * Start a new journal on top of the scene file, replaces an existing journal of the scene file.
+     *
+     * @param entities The ids of the entities in the order of the entities list of the scene file
+     */
+    void start(const std::filesystem::path &sceneFile, const std::vector<uint64_t> &entities);
+
+    /**
+     * Continue appending to the journal of a recovered scene.
+     *
+     * @param previous The ids of the entities returned by recover()
+     * @param entities The new ids of the same entities
+     */
+    void resume(const std::filesystem::path &sceneFile,
+                const std::vector<uint64_t> &previous,
+                const std::vector<uint64_t> &entities);
+
+    /**
+     * Start a new journal on top of the saved scene file and keep the records appended after mark,
+     * the journal of the previous scene file is removed.
+     *
+     * @param entities The ids of the entities in the order of the entities list of the saved scene file
+     * @param mark The value of getSize() when the saved scene was copied
+     */
+    void compact(const std::filesystem::path &sceneFile, const std::vector<uint64_t> &entities, uint64_t mark);
+
+    /**
+     * Sync and close the journal, the journal file is kept.
+     */
+    void close();
+
+    /**
+     * Close and remove the journal file.
+     */
+    void discard();
+
+    bool isOpen() const {
+        return fd >= 0;
+    }
+
+    const std::filesystem::path &getSceneFile() const {
+        return sceneFile;
+    }
+
+    /**
+     * @return The size of the journal including the records which have not been synced
+     */
+    uint64_t getSize() const {
+        return fileSize + pending.size();
+    }
+
+    void appendCreate(uint64_t entity, const xng::Message &message);
+
+    void appendUpdate(uint64_t entity, const xng::Message &message);
+
+    void appendDestroy(uint64_t entity);
+
+    /**
+     * Write the appended records and flush them to disk.
+     */
+    void sync();
+
+private:
+    void open(const std::filesystem::path &file, const std::string &header, std::string_view records);
+
+    void appendRecord(const std::string &payload);
+
+    std::filesystem::path sceneFile;
+    std::filesystem::path journalFile;
+    int fd = -1;
+    uint64_t fileSize = 0;
+    std::string pending;
+};
+
+#endif //XEDITOR_SCENEJOURNAL_HPP
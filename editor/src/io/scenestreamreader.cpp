@@ -0,0 +1,105 @@
+/**
+ *  xEditor - Editor and tools for creating games
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "io/scenestreamreader.hpp"
+
+#include <map>
+
+using namespace xng;
+
+static const char *ENTITIES_MEMBER = "entities";
+
+SceneStreamReader::SceneStreamReader(const std::filesystem::path &path)
+        : format(SceneFile::detectFormat(path)) {
+    std::map<std::string, Message> members;
+    bool hasEntities = false;
+
+    if (format == SceneFile::FORMAT_BINARY) {
+        file = MappedFile(path);
+        binaryReader = std::make_unique<BinarySceneReader>(file.view());
+        properties = binaryReader->readProperties();
+        hasEntities = binaryReader->hasEntities();
+        if (hasEntities && properties.getType() == Message::DICTIONARY) {
+            members = properties.asDictionary();
+        }
+    } else {
+        stream.open(path);
+        if (!stream)
+            throw std::runtime_error("Failed to open scene file: " + path.string());
+
+        jsonReader = std::make_unique<JsonReader>(stream);
+        if (jsonReader->peek() != '{') {
+            // Not a scene dictionary, there are no entities to stream
+            properties = jsonReader->readValue();
+            return;
+        }
+
+        std::string key;
+        jsonReader->beginObject();
+        while (jsonReader->nextMember(key)) {
+            if (key == ENTITIES_MEMBER && jsonReader->peek() == '[') {
+                jsonReader->skipValue();
+                hasEntities = true;
+            } else {
+                members[key] = jsonReader->readValue();
+            }
+        }
+        if (!hasEntities) {
+            properties = Message(members);
+            return;
+        }
+
+        // Seek to the beginning of the entities list for the second pass
+        stream.clear();
+        stream.seekg(0);
+        jsonReader = std::make_unique<JsonReader>(stream);
+        jsonReader->beginObject();
+        while (jsonReader->nextMember(key)) {
+            if (key == ENTITIES_MEMBER && jsonReader->peek() == '[') {
+                jsonReader->beginArray();
+                readingEntities = true;
+                break;
+            }
+            jsonReader->skipValue();
+        }
+    }
+
+    if (hasEntities) {
+        members[ENTITIES_MEMBER] = Message(std::vector<Message>());
+        properties = Message(members);
+    }
+}
+
+bool SceneStreamReader::next(Message &entity) {
+    if (binaryReader) {
+        if (!binaryReader->hasEntities() || entityIndex >= binaryReader->getEntities().size())
+            return false;
+        entity = binaryReader->readEntity(entityIndex++);
+        return true;
+    } else {
+        if (!readingEntities)
+            return false;
+        if (!jsonReader->nextElement()) {
+            readingEntities = false;
+            return false;
+        }
+        entity = jsonReader->readValue();
+        return true;
+    }
+}
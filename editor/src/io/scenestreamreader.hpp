@@ -0,0 +1,86 @@
+/**
+ *  xEditor - Editor and tools for creating games
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XEDITOR_SCENESTREAMREADER_HPP
+#define XEDITOR_SCENESTREAMREADER_HPP
+
+#include <filesystem>
+#include <fstream>
+#include <memory>
+
+#include "xng/xng.hpp"
+
+#include "io/scenefile.hpp"
+#include "io/jsonreader.hpp"
+#include "io/binaryscene.hpp"
+
+#include "headertool/mappedfile.hpp"
+
+/**
+ * Reads the entities of a scene file one at a time so that a scene can be loaded without holding
+ * the message of the whole scene in memory.
+ *
+ * Json scenes are read twice, the first pass collects the scene members other than the entities
+ * and the second pass parses the entities as they are requested.
+ * Binary scenes decode the entities from the mapped file on request.
+ *
+ * Usage:
+ *  SceneStreamReader reader(path);
+ *  scene << reader.getProperties();
+ *  Message entity;
+ *  while (reader.next(entity))
+ *      scene.deserializeEntity(entity);
+ *
+ * Throws std::runtime_error if the file cannot be read or parsed.
+ */
+class SceneStreamReader {
+public:
+    explicit SceneStreamReader(const std::filesystem::path &path);
+
+    SceneFile::Format getFormat() const {
+        return format;
+    }
+
+    /**
+     * @return The scene message with an empty entities list
+     */
+    const xng::Message &getProperties() const {
+        return properties;
+    }
+
+    /**
+     * @param entity Set to the message of the next entity
+     * @return False if there are no more entities
+     */
+    bool next(xng::Message &entity);
+
+private:
+    SceneFile::Format format;
+    xng::Message properties;
+
+    std::ifstream stream;
+    std::unique_ptr<JsonReader> jsonReader;
+    bool readingEntities = false;
+
+    xng::MappedFile file;
+    std::unique_ptr<BinarySceneReader> binaryReader;
+    size_t entityIndex = 0;
+};
+
+#endif //XEDITOR_SCENESTREAMREADER_HPP
@@ -0,0 +1,113 @@
+/**
+ *  xEditor - Editor and tools for creating games
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "project/accesstrace.hpp"
+
+#include <fstream>
+#include <sstream>
+
+#include "io/fileutil.hpp"
+
+static const std::string URI_SCHEME_SEPARATOR = "://";
+
+/**
+ * @return The path relative to the bundle directory in the form of the pak entry names
+ */
+static std::string normalizePath(const std::string &path) {
+    auto ret = std::filesystem::path(path).lexically_normal().generic_string();
+    while (!ret.empty() && ret.front() == '/') {
+        ret.erase(0, 1);
+    }
+    return ret;
+}
+
+void AccessTrace::start() {
+    std::lock_guard<std::mutex> guard(mutex);
+    accesses.clear();
+    recorded.clear();
+    recording = true;
+}
+
+void AccessTrace::record(const std::string &scheme, const std::string &path) {
+    if (!recording)
+        return;
+    auto entry = std::make_pair(scheme, normalizePath(path));
+    std::lock_guard<std::mutex> guard(mutex);
+    if (recorded.insert(entry).second) {
+        accesses.emplace_back(std::move(entry));
+    }
+}
+
+std::vector<std::string> AccessTrace::getPaths(const std::string &scheme) const {
+    std::lock_guard<std::mutex> guard(mutex);
+    std::vector<std::string> ret;
+    for (auto &access: accesses) {
+        if (access.first == scheme)
+            ret.emplace_back(access.second);
+    }
+    return ret;
+}
+
+size_t AccessTrace::size() const {
+    std::lock_guard<std::mutex> guard(mutex);
+    return accesses.size();
+}
+
+void AccessTrace::load(const std::filesystem::path &file) {
+    std::ifstream fs(file);
+    if (!fs) {
+        throw std::runtime_error("Failed to open access trace " + file.string());
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        accesses.clear();
+        recorded.clear();
+    }
+
+    std::string line;
+    while (std::getline(fs, line)) {
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        if (line.empty() || line.front() == '#')
+            continue;
+        auto separator = line.find(URI_SCHEME_SEPARATOR);
+        if (separator == std::string::npos) {
+            throw std::runtime_error("Invalid access trace entry " + line + " in " + file.string());
+        }
+        auto entry = std::make_pair(line.substr(0, separator),
+                                    normalizePath(line.substr(separator + URI_SCHEME_SEPARATOR.size())));
+        std::lock_guard<std::mutex> guard(mutex);
+        if (recorded.insert(entry).second) {
+            accesses.emplace_back(std::move(entry));
+        }
+    }
+}
+
+void AccessTrace::save(const std::filesystem::path &file) const {
+    std::stringstream stream;
+    stream << "# Files of the asset bundles in first access order\n";
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        for (auto &access: accesses) {
+            stream << access.first << URI_SCHEME_SEPARATOR << access.second << "\n";
+        }
+    }
+    FileUtil::writeAtomic(file, stream.str());
+}
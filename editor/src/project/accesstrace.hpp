@@ -0,0 +1,92 @@
+/**
+ *  xEditor - Editor and tools for creating games
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XEDITOR_ACCESSTRACE_HPP
+#define XEDITOR_ACCESSTRACE_HPP
+
+#include <atomic>
+#include <filesystem>
+#include <mutex>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * The order in which the files of the asset bundles are first accessed.
+ *
+ * The packager stores the entries of a pak in this order so that reading the resources at startup is sequential.
+ *
+ * The trace file is a text file with one scheme://path uri per line in first access order,
+ * empty lines and lines starting with # are ignored.
+ */
+class AccessTrace {
+public:
+    /**
+     * Clear the recorded accesses and start recording.
+     */
+    void start();
+
+    void stop() {
+        recording = false;
+    }
+
+    bool isRecording() const {
+        return recording;
+    }
+
+    /**
+     * Record the access of a file while recording, only the first access of a file is recorded.
+     * Can be called from any thread.
+     *
+     * @param scheme The scheme of the bundle
+     * @param path The path of the file relative to the bundle directory
+     */
+    void record(const std::string &scheme, const std::string &path);
+
+    /**
+     * @param scheme
+     * @return The paths of the files of the bundle with the scheme in first access order
+     */
+    std::vector<std::string> getPaths(const std::string &scheme) const;
+
+    /**
+     * @return The number of recorded files
+     */
+    size_t size() const;
+
+    /**
+     * Replace the recorded accesses with the contents of the trace file.
+     *
+     * Throws std::runtime_error if the file cannot be read.
+     *
+     * @param file
+     */
+    void load(const std::filesystem::path &file);
+
+    void save(const std::filesystem::path &file) const;
+
+private:
+    std::atomic<bool> recording = false;
+    mutable std::mutex mutex;
+    std::vector<std::pair<std::string, std::string>> accesses; // The scheme and path of the files in first access order
+    std::set<std::pair<std::string, std::string>> recorded;
+};
+
+#endif //XEDITOR_ACCESSTRACE_HPP
@@ -34,6 +34,9 @@ struct AssetBundle : public Messageable {
 
     bool compress = true;
     bool encrypt = false;
+    bool seekable = false; // Let readers decode the chunks of files on demand so that they can be read at any offset without decoding the whole file
+    bool referencedOnly = false; // Only package the scenes and the files which are referenced by scenes
+    bool preloadHints = false; // Write the table of the files in the access trace which readers can prefetch
     xng::AES::Key key{};
 
     std::string directory; // The name of the directory which is bundled into name.pak relative to the project directory
@@ -44,6 +47,9 @@ struct AssetBundle : public Messageable {
 
         message.value("compress", compress, true);
         message.value("encrypt", encrypt, false);
+        message.value("seekable", seekable, false);
+        message.value("referencedOnly", referencedOnly, false);
+        message.value("preloadHints", preloadHints, false);
         message.value("key", key, std::string());
 
         message.value("directory", directory, std::string());
@@ -58,6 +64,9 @@ struct AssetBundle : public Messageable {
 
         message["compress"] = compress;
         message["encrypt"] = encrypt;
+        message["seekable"] = seekable;
+        message["referencedOnly"] = referencedOnly;
+        message["preloadHints"] = preloadHints;
         message["key"] = key;
 
         message["directory"] = directory;
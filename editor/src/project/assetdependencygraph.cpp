@@ -0,0 +1,229 @@
+/**
+ *  xEditor - Editor and tools for creating games
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "project/assetdependencygraph.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+#include "xng/io/protocol/jsonprotocol.hpp"
+
+#include "headertool/variabletype.hpp"
+
+#include "project/resourcereferences.hpp"
+
+#include "io/scenefile.hpp"
+
+static const std::string URI_SCHEME_SEPARATOR = "://";
+
+/**
+ * @return True if the type is a ResourceHandle or Uri or a container of them
+ */
+static bool isResourceType(const ComponentMetadata::TypeMetadata &type) {
+    switch (getVariableType(type.typeName)) {
+        case TYPE_RESOURCE_HANDLE:
+        case TYPE_URI:
+            return true;
+        case TYPE_VECTOR:
+        case TYPE_MAP:
+            return std::any_of(type.templateArguments.begin(),
+                               type.templateArguments.end(),
+                               [](const ComponentMetadata::TypeMetadata &argument) {
+                                   return isResourceType(argument);
+                               });
+        default:
+            return false;
+    }
+}
+
+static std::string readFile(const std::filesystem::path &file) {
+    std::ifstream fs(file, std::ifstream::binary);
+    if (!fs)
+        throw std::runtime_error("Failed to open " + file.string());
+    std::stringstream stream;
+    stream << fs.rdbuf();
+    return stream.str();
+}
+
+AssetDependencyGraph::AssetDependencyGraph(std::map<std::string, std::filesystem::path> archives,
+                                           std::map<std::string, ComponentMetadata> metadata)
+        : archives(std::move(archives)), metadata(std::move(metadata)) {}
+
+void AssetDependencyGraph::addDirectory(const std::filesystem::path &directory) {
+    for (auto &file: listBundleFiles(directory)) {
+        if (scenes.find(file) != scenes.end())
+            continue;
+
+        if (file.extension() == SceneFile::getExtension(SceneFile::FORMAT_BINARY)) {
+            EntityScene scene;
+            scene << SceneFile::read(file);
+            addScene(file, scene);
+            continue;
+        }
+
+        if (file.extension() != ".json")
+            continue;
+
+        auto data = readFile(file);
+
+        std::stringstream importStream(data);
+        auto bundle = JsonImporter().read(importStream, file.extension(), file.string(), nullptr);
+        if (bundle.getAll<EntityScene>().empty())
+            continue;
+
+        // Scene files are read the same way EditorWindow::loadScene opens them
+        std::stringstream sceneStream(data);
+        EntityScene scene;
+        scene << JsonProtocol().deserialize(sceneStream);
+        addScene(file, scene);
+    }
+}
+
+void AssetDependencyGraph::addScene(const std::filesystem::path &file, const EntityScene &scene) {
+    auto path = file.lexically_normal();
+    scenes.insert(path);
+    visited.insert(path);
+    dependencies[path];
+
+    for (auto &reference: getResourceReferences(scene)) {
+        addReference(path, reference.uri, false);
+    }
+    for (auto &pair: scene.getPool<GenericComponent>()) {
+        for (auto &component: pair.second.components) {
+            auto it = metadata.find(component.first);
+            if (it == metadata.end()) {
+                // Without metadata only values which are recognizable as bundle uris are considered
+                addReferences(path, component.second, true);
+                continue;
+            }
+            if (component.second.getType() != Message::DICTIONARY)
+                continue;
+            for (auto &member: it->second.members) {
+                if (isResourceType(member.type) && component.second.has(member.instanceName.c_str())) {
+                    addReferences(path, component.second[member.instanceName.c_str()], false);
+                }
+            }
+        }
+    }
+}
+
+const std::set<std::filesystem::path> &AssetDependencyGraph::getDependencies(const std::filesystem::path &file) const {
+    static const std::set<std::filesystem::path> empty;
+    auto it = dependencies.find(file.lexically_normal());
+    if (it == dependencies.end()) {
+        return empty;
+    } else {
+        return it->second;
+    }
+}
+
+std::set<std::filesystem::path> AssetDependencyGraph::getReferencedFiles() const {
+    std::set<std::filesystem::path> ret;
+    std::vector<std::filesystem::path> stack(scenes.begin(), scenes.end());
+    while (!stack.empty()) {
+        auto file = std::move(stack.back());
+        stack.pop_back();
+        if (!ret.insert(file).second)
+            continue;
+        for (auto &dependency: getDependencies(file)) {
+            if (ret.find(dependency) == ret.end())
+                stack.emplace_back(dependency);
+        }
+    }
+    return ret;
+}
+
+std::vector<std::filesystem::path> AssetDependencyGraph::getUnreferencedFiles(const std::filesystem::path &directory) const {
+    auto referenced = getReferencedFiles();
+    std::vector<std::filesystem::path> ret;
+    for (auto &file: listBundleFiles(directory)) {
+        if (referenced.find(file) == referenced.end())
+            ret.emplace_back(file);
+    }
+    return ret;
+}
+
+void AssetDependencyGraph::writeReport(std::ostream &stream, const std::filesystem::path &directory) const {
+    auto base = directory.lexically_normal();
+    auto unreferenced = getUnreferencedFiles(directory);
+    stream << "Unreferenced files in " << base.string() << " (" << unreferenced.size() << "):\n";
+    for (auto &file: unreferenced) {
+        stream << "    " << file.lexically_relative(base).generic_string() << "\n";
+    }
+    for (auto &pair: unresolved) {
+        auto relative = pair.first.lexically_relative(base);
+        if (relative.empty() || *relative.begin() == "..")
+            continue;
+        stream << "Unresolved references in " << relative.generic_string() << ":\n";
+        for (auto &uri: pair.second) {
+            stream << "    " << uri << "\n";
+        }
+    }
+}
+
+void AssetDependencyGraph::addReference(const std::filesystem::path &file, const std::string &uri, bool requireScheme) {
+    if (uri.empty())
+        return;
+
+    // Strings which do not start with the scheme of a bundle are not considered to be uris
+    if (requireScheme) {
+        auto separator = uri.find(URI_SCHEME_SEPARATOR);
+        if (separator == std::string::npos || archives.find(uri.substr(0, separator)) == archives.end())
+            return;
+    }
+
+    auto candidate = resolveResourceUri(uri, archives, requireScheme);
+    if (!candidate.empty()) {
+        dependencies[file].insert(candidate);
+        if (candidate.extension() == ".json")
+            addResourceFile(candidate);
+        return;
+    }
+
+    unresolved[file].insert(uri);
+}
+
+void AssetDependencyGraph::addReferences(const std::filesystem::path &file, const Message &message, bool requireScheme) {
+    switch (message.getType()) {
+        case Message::STRING:
+            addReference(file, message.asString(), requireScheme);
+            break;
+        case Message::LIST:
+            for (auto &element: message.asList()) {
+                addReferences(file, element, requireScheme);
+            }
+            break;
+        case Message::DICTIONARY:
+            for (auto &pair: message.asDictionary()) {
+                addReferences(file, pair.second, requireScheme);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+void AssetDependencyGraph::addResourceFile(const std::filesystem::path &file) {
+    if (!visited.insert(file).second)
+        return;
+    dependencies[file];
+    std::stringstream stream(readFile(file));
+    addReferences(file, JsonProtocol().deserialize(stream), true);
+}
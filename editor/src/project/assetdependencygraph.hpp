@@ -0,0 +1,123 @@
+/**
+ *  xEditor - Editor and tools for creating games
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XEDITOR_ASSETDEPENDENCYGRAPH_HPP
+#define XEDITOR_ASSETDEPENDENCYGRAPH_HPP
+
+#include <filesystem>
+#include <map>
+#include <ostream>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "xng/xng.hpp"
+
+#include "headertool/componentmetadata.hpp"
+
+using namespace xng;
+
+/**
+ * Records which files of the asset bundles are referenced by the saved scenes of a project.
+ *
+ * The json files in the bundle directories which contain a scene are the roots of the graph.
+ * References are collected from the resource handles of the built-in components and from the members
+ * of generic components whose metadata declares a ResourceHandle or Uri type.
+ * Referenced json resource files are followed to the uris which they contain.
+ */
+class AssetDependencyGraph {
+public:
+    /**
+     * @param archives The bundle directories by the scheme under which they are accessible
+     * @param metadata The metadata of the generic components, the members of generic components without metadata
+     *                 are searched for strings which contain a uri of a bundle scheme
+     */
+    AssetDependencyGraph(std::map<std::string, std::filesystem::path> archives,
+                         std::map<std::string, ComponentMetadata> metadata);
+
+    /**
+     * Add the scenes in the directory and the files which they reference.
+     *
+     * Throws std::runtime_error if a json file cannot be parsed.
+     *
+     * @param directory
+     */
+    void addDirectory(const std::filesystem::path &directory);
+
+    /**
+     * Add the scene and the files which it references.
+     *
+     * @param file The file from which the scene was loaded
+     * @param scene
+     */
+    void addScene(const std::filesystem::path &file, const EntityScene &scene);
+
+    /**
+     * @param file
+     * @return The files which are directly referenced by the file
+     */
+    const std::set<std::filesystem::path> &getDependencies(const std::filesystem::path &file) const;
+
+    const std::set<std::filesystem::path> &getScenes() const {
+        return scenes;
+    }
+
+    /**
+     * @return The scenes and all files which are directly or indirectly referenced by them
+     */
+    std::set<std::filesystem::path> getReferencedFiles() const;
+
+    /**
+     * @param directory
+     * @return The files in the directory which are not referenced by any scene
+     */
+    std::vector<std::filesystem::path> getUnreferencedFiles(const std::filesystem::path &directory) const;
+
+    /**
+     * @return The uris which do not resolve to a file by the file which contains them
+     */
+    const std::map<std::filesystem::path, std::set<std::string>> &getUnresolvedReferences() const {
+        return unresolved;
+    }
+
+    /**
+     * Write the unreferenced files of the directory and the unresolved references as text.
+     *
+     * @param stream
+     * @param directory
+     */
+    void writeReport(std::ostream &stream, const std::filesystem::path &directory) const;
+
+private:
+    void addReference(const std::filesystem::path &file, const std::string &uri, bool requireScheme);
+
+    void addReferences(const std::filesystem::path &file, const Message &message, bool requireScheme);
+
+    void addResourceFile(const std::filesystem::path &file);
+
+    std::map<std::string, std::filesystem::path> archives;
+    std::map<std::string, ComponentMetadata> metadata;
+
+    std::set<std::filesystem::path> scenes;
+    std::set<std::filesystem::path> visited; // The json files which were searched for references
+    std::map<std::filesystem::path, std::set<std::filesystem::path>> dependencies;
+    std::map<std::filesystem::path, std::set<std::string>> unresolved;
+};
+
+#endif //XEDITOR_ASSETDEPENDENCYGRAPH_HPP
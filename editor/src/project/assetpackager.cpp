@@ -0,0 +1,486 @@
+/**
+ *  xEditor - Editor and tools for creating games
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "project/assetpackager.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <unordered_map>
+
+#include "headertool/contenthash.hpp"
+
+#include "io/binaryio.hpp"
+
+#include "project/pakmanifest.hpp"
+
+static const char PAK_MAGIC[4] = {'X', 'P', 'A', 'K'};
+
+static const size_t INITIALIZATION_VECTOR_SIZE = 16;
+
+struct PackageEntry {
+    std::filesystem::path path;
+    std::string name;
+    uint64_t originalSize = 0;
+    int64_t modificationTime = 0;
+    const PakManifest::Entry *previous = nullptr; // The entry of the file in the manifest of the previous pak
+    bool reused = false; // True if the file is unmodified and the stored data is copied from the previous pak
+    size_t firstItem = 0;
+    size_t itemCount = 0;
+    uint64_t offset = 0;
+    uint64_t size = 0;
+    std::vector<PakManifest::Chunk> chunks; // The chunks of the written entry which are recorded in the manifest
+};
+
+// A chunk of a file which is read and compressed by a worker
+struct PackageItem {
+    size_t entry = 0;
+    uint64_t offset = 0; // The offset in the file or the offset of the stored data in the previous pak if the entry is reused
+    size_t size = 0;
+    uint64_t hash = 0;
+    std::string iv; // The initialization vector of the chunk if it is encrypted
+    bool ready = false;
+    std::vector<char> data;
+};
+
+// The location of a compressed or encrypted chunk in the previous pak
+struct StoredChunk {
+    uint64_t originalSize = 0;
+    uint64_t offset = 0;
+    uint64_t size = 0;
+    std::string iv;
+};
+
+/**
+ * @return The hash of the bundle settings which change the stored data of a file
+ */
+static uint64_t hashSettings(const AssetBundle &bundle, size_t chunkSize) {
+    std::string buffer;
+    BinaryWriter writer(buffer);
+    writer.write<uint32_t>(AssetPackager::VERSION);
+    writer.write<uint8_t>(bundle.compress);
+    writer.write<uint8_t>(bundle.encrypt);
+    writer.write<uint64_t>(bundle.encrypt ? xng::hashContent(bundle.key) : 0);
+    writer.write<uint64_t>(chunkSize);
+    return xng::hashContent(buffer);
+}
+
+/**
+ * Read the range of the file, the stream is opened on first use so that workers can reuse it for multiple reads.
+ */
+static std::vector<char> readRange(std::ifstream &fs,
+                                   const std::filesystem::path &path,
+                                   uint64_t offset,
+                                   size_t size) {
+    std::vector<char> ret(size);
+    if (size == 0)
+        return ret;
+    if (!fs.is_open())
+        fs.open(path, std::ifstream::binary);
+    fs.clear();
+    fs.seekg(static_cast<std::streamoff>(offset));
+    if (!fs.read(ret.data(), static_cast<std::streamsize>(size))) {
+        throw std::runtime_error("Failed to read " + path.string());
+    }
+    return ret;
+}
+
+/**
+ * Load the manifest and clear it if it does not describe the current pak file or was written with different settings.
+ */
+static void loadManifest(PakManifest &manifest,
+                         const std::filesystem::path &manifestFile,
+                         const std::filesystem::path &pakFile,
+                         uint64_t settingsHash) {
+    if (!manifest.load(manifestFile))
+        return;
+    std::error_code error;
+    auto size = std::filesystem::file_size(pakFile, error);
+    if (error
+        || manifest.settingsHash != settingsHash
+        || manifest.pakSize != size
+        || manifest.pakModificationTime != std::filesystem::last_write_time(pakFile, error).time_since_epoch().count()
+        || error) {
+        manifest.clear();
+    }
+}
+
+static std::string createInitializationVector(std::mt19937_64 &random) {
+    std::string ret(INITIALIZATION_VECTOR_SIZE, '\0');
+    for (auto &c: ret) {
+        c = static_cast<char>(random());
+    }
+    return ret;
+}
+
+static std::vector<PackageEntry> collectEntries(const std::filesystem::path &directory,
+                                                const std::function<bool(const std::filesystem::path &)> &filter) {
+    std::vector<PackageEntry> ret;
+    for (auto it = std::filesystem::recursive_directory_iterator(directory);
+         it != std::filesystem::recursive_directory_iterator();
+         it++) {
+        auto name = it->path().filename().string();
+        if (!name.empty() && name.front() == '.') {
+            if (it->is_directory())
+                it.disable_recursion_pending();
+            continue;
+        }
+        if (!it->is_regular_file() || (filter && !filter(it->path())))
+            continue;
+        auto &entry = ret.emplace_back();
+        entry.path = it->path();
+        entry.name = it->path().lexically_relative(directory).generic_string();
+        entry.originalSize = it->file_size();
+        entry.modificationTime = it->last_write_time().time_since_epoch().count();
+    }
+    std::sort(ret.begin(), ret.end(), [](const PackageEntry &lhs, const PackageEntry &rhs) {
+        return lhs.name < rhs.name;
+    });
+    return ret;
+}
+
+/**
+ * Move the entries in the access order to the front in this order, the other entries stay in path order.
+ *
+ * @return The number of entries in the access order
+ */
+static size_t applyAccessOrder(std::vector<PackageEntry> &entries, const std::vector<std::string> &accessOrder) {
+    std::unordered_map<std::string, size_t> ranks;
+    for (auto &path: accessOrder) {
+        ranks.emplace(path, ranks.size());
+    }
+    auto rank = [&ranks](const PackageEntry &entry) {
+        auto it = ranks.find(entry.name);
+        return it == ranks.end() ? ranks.size() : it->second;
+    };
+    std::stable_sort(entries.begin(), entries.end(), [&rank](const PackageEntry &lhs, const PackageEntry &rhs) {
+        return rank(lhs) < rank(rhs);
+    });
+    return static_cast<size_t>(std::count_if(entries.begin(), entries.end(), [&](const PackageEntry &entry) {
+        return rank(entry) < ranks.size();
+    }));
+}
+
+AssetPackager::AssetPackager(xng::CryptoDriver &crypto, unsigned int threadCount, size_t chunkSize)
+        : crypto(crypto),
+          threadCount(threadCount),
+          chunkSize(std::max<size_t>(1, chunkSize)) {
+    if (this->threadCount == 0) {
+        this->threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+}
+
+AssetPackager::Result AssetPackager::package(const AssetBundle &bundle,
+                                             const std::filesystem::path &directory,
+                                             const std::filesystem::path &outputFile,
+                                             const PackageOptions &options) {
+    cancelled = false;
+
+    Result ret;
+
+    auto entries = collectEntries(directory, options.filter);
+    auto preloadCount = applyAccessOrder(entries, options.accessOrder);
+
+    auto settingsHash = hashSettings(bundle, chunkSize);
+    PakManifest previous;
+    if (!options.manifestFile.empty()) {
+        loadManifest(previous, options.manifestFile, outputFile, settingsHash);
+    }
+
+    // The compressed or encrypted chunks of the previous pak by content hash
+    std::unordered_map<uint64_t, StoredChunk> storedChunks;
+    if (bundle.compress || bundle.encrypt) {
+        for (auto &pair: previous.getEntries()) {
+            for (auto &chunk: pair.second.chunks) {
+                storedChunks[chunk.hash] = {chunk.originalSize,
+                                            pair.second.offset + chunk.offset,
+                                            chunk.size,
+                                            chunk.iv};
+            }
+        }
+    }
+
+    std::atomic<size_t> reusedFiles = 0;
+    std::atomic<size_t> reusedChunks = 0;
+
+    // Split the files into chunks, every file has at least one chunk so that empty files produce valid gzip data.
+    // Unmodified files are a single item which copies the stored data from the previous pak.
+    std::vector<PackageItem> items;
+    for (auto i = 0u; i < entries.size(); i++) {
+        auto &entry = entries.at(i);
+        entry.previous = previous.find(entry.name);
+        entry.firstItem = items.size();
+        if (entry.previous
+            && entry.previous->fileSize == entry.originalSize
+            && entry.previous->modificationTime == entry.modificationTime) {
+            entry.reused = true;
+            auto &item = items.emplace_back();
+            item.entry = i;
+            item.offset = entry.previous->offset;
+            item.size = static_cast<size_t>(entry.previous->size);
+            reusedFiles++;
+        } else {
+            uint64_t offset = 0;
+            do {
+                auto &item = items.emplace_back();
+                item.entry = i;
+                item.offset = offset;
+                item.size = static_cast<size_t>(std::min<uint64_t>(chunkSize, entry.originalSize - offset));
+                offset += item.size;
+            } while (offset < entry.originalSize);
+        }
+        entry.itemCount = items.size() - entry.firstItem;
+        ret.fileCount++;
+        ret.inputBytes += entry.originalSize;
+    }
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::exception_ptr exception;
+    bool failed = false;
+    size_t writeItem = 0; // The first item which has not been written yet
+    std::atomic<size_t> nextItem = 0;
+
+    // The number of items which can be processed ahead of the writer, limits the memory used for the compressed data
+    const size_t window = threadCount * 4;
+
+    auto fail = [&](std::exception_ptr e) {
+        std::lock_guard<std::mutex> guard(mutex);
+        if (!exception)
+            exception = std::move(e);
+        failed = true;
+        condition.notify_all();
+    };
+
+    auto work = [&]() {
+        auto gzip = bundle.compress ? crypto.createGzip() : nullptr;
+        auto aes = bundle.encrypt ? crypto.createAES() : nullptr;
+        std::mt19937_64 workerRandom(std::random_device{}());
+        std::ifstream previousPak;
+        for (auto i = nextItem++; i < items.size(); i = nextItem++) {
+            auto &item = items.at(i);
+            auto &entry = entries.at(item.entry);
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                condition.wait(lock, [&]() { return failed || i < writeItem + window; });
+                if (failed)
+                    return;
+            }
+            try {
+                if (cancelled)
+                    throw std::runtime_error("Packaging was cancelled");
+
+                std::vector<char> data;
+                uint64_t hash = 0;
+                std::string iv;
+                if (entry.reused) {
+                    data = readRange(previousPak, outputFile, item.offset, item.size);
+                } else {
+                    std::ifstream fs;
+                    auto buffer = readRange(fs, entry.path, item.offset, item.size);
+                    hash = xng::hashContent({buffer.data(), buffer.size()});
+                    auto matched = false;
+                    auto it = storedChunks.find(hash);
+                    if (it != storedChunks.end() && it->second.originalSize == item.size) {
+                        // The content hash is not collision resistant, the stored chunk is only reused
+                        // if it decodes to the same bytes
+                        data = readRange(previousPak, outputFile, it->second.offset, it->second.size);
+                        iv = it->second.iv;
+                        auto decoded = aes ? aes->decrypt(bundle.key, iv, data) : data;
+                        if (gzip)
+                            decoded = gzip->decompress(decoded);
+                        matched = decoded == buffer;
+                    }
+                    if (matched) {
+                        reusedChunks++;
+                    } else {
+                        data = gzip ? gzip->compress(buffer) : std::move(buffer);
+                        if (aes) {
+                            iv = createInitializationVector(workerRandom);
+                            data = aes->encrypt(bundle.key, iv, data);
+                        }
+                    }
+                }
+
+                std::lock_guard<std::mutex> guard(mutex);
+                item.hash = hash;
+                item.iv = std::move(iv);
+                item.data = std::move(data);
+                item.ready = true;
+                condition.notify_all();
+            } catch (...) {
+                fail(std::current_exception());
+                return;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (auto i = 0u; i < std::min<size_t>(threadCount, items.size()); i++) {
+        threads.emplace_back(work);
+    }
+
+    auto tmpFile = outputFile;
+    tmpFile += ".tmp";
+
+    // Write the data of the entries in order while the workers process the following items
+    try {
+        if (outputFile.has_parent_path())
+            std::filesystem::create_directories(outputFile.parent_path());
+
+        std::ofstream fs;
+        fs.exceptions(std::ofstream::badbit | std::ofstream::failbit);
+        fs.open(tmpFile, std::ofstream::binary | std::ofstream::trunc);
+
+        uint64_t offset = 0;
+        auto write = [&fs, &offset](const char *data, size_t size) {
+            fs.write(data, static_cast<std::streamsize>(size));
+            offset += size;
+        };
+
+        std::string header;
+        BinaryWriter headerWriter(header);
+        headerWriter.writeBytes({PAK_MAGIC, sizeof(PAK_MAGIC)});
+        headerWriter.write<uint32_t>(VERSION);
+        write(header.data(), header.size());
+
+        for (auto &entry: entries) {
+            entry.offset = offset;
+            for (auto i = entry.firstItem; i < entry.firstItem + entry.itemCount; i++) {
+                auto &item = items.at(i);
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    condition.wait(lock, [&]() { return failed || item.ready; });
+                    if (failed)
+                        break;
+                }
+                if (!entry.reused) {
+                    entry.chunks.push_back({item.hash,
+                                            item.size,
+                                            offset - entry.offset,
+                                            item.data.size(),
+                                            item.iv});
+                }
+                write(item.data.data(), item.data.size());
+                item.data = {};
+                std::lock_guard<std::mutex> guard(mutex);
+                writeItem = i + 1;
+                condition.notify_all();
+            }
+            entry.size = offset - entry.offset;
+            if (entry.reused) {
+                entry.chunks = entry.previous->chunks;
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            if (failed) {
+                std::rethrow_exception(exception);
+            }
+        }
+
+        uint8_t flags = 0;
+        if (bundle.compress)
+            flags |= ENTRY_COMPRESSED;
+        if (bundle.encrypt)
+            flags |= ENTRY_ENCRYPTED;
+        if (bundle.seekable)
+            flags |= ENTRY_CHUNKED;
+
+        std::string table;
+        BinaryWriter tableWriter(table);
+        tableWriter.writeVarInt(entries.size());
+        for (auto &entry: entries) {
+            tableWriter.writeString(entry.name);
+            tableWriter.write<uint64_t>(entry.offset);
+            tableWriter.write<uint64_t>(entry.size);
+            tableWriter.write<uint64_t>(entry.originalSize);
+            tableWriter.write<uint8_t>(flags);
+            tableWriter.writeVarInt(chunkSize);
+            tableWriter.writeVarInt(entry.chunks.size());
+            for (auto &chunk: entry.chunks) {
+                tableWriter.write<uint64_t>(chunk.offset);
+                if (bundle.encrypt) {
+                    tableWriter.writeString(chunk.iv);
+                }
+            }
+        }
+
+        if (bundle.preloadHints) {
+            tableWriter.writeVarInt(preloadCount);
+            for (auto i = 0u; i < preloadCount; i++) {
+                tableWriter.writeVarInt(i);
+            }
+        } else {
+            tableWriter.writeVarInt(0);
+        }
+
+        std::string footer;
+        BinaryWriter footerWriter(footer);
+        footerWriter.write<uint64_t>(offset);
+        footerWriter.write<uint64_t>(table.size());
+        footerWriter.writeBytes({PAK_MAGIC, sizeof(PAK_MAGIC)});
+
+        write(table.data(), table.size());
+        write(footer.data(), footer.size());
+        fs.close();
+
+        for (auto &thread: threads) {
+            thread.join();
+        }
+
+        std::filesystem::rename(tmpFile, outputFile);
+
+        ret.outputBytes = offset;
+    } catch (...) {
+        fail(std::current_exception());
+        for (auto &thread: threads) {
+            if (thread.joinable())
+                thread.join();
+        }
+        std::error_code error;
+        std::filesystem::remove(tmpFile, error);
+        throw;
+    }
+
+    ret.reusedFileCount = reusedFiles;
+    ret.reusedChunkCount = reusedChunks;
+
+    if (!options.manifestFile.empty()) {
+        // If saving fails the previous manifest does not match the new pak file and is ignored on the next run
+        PakManifest manifest;
+        manifest.settingsHash = settingsHash;
+        manifest.pakSize = ret.outputBytes;
+        manifest.pakModificationTime = std::filesystem::last_write_time(outputFile).time_since_epoch().count();
+        for (auto &entry: entries) {
+            manifest.set(entry.name, {entry.originalSize,
+                                      entry.modificationTime,
+                                      entry.offset,
+                                      entry.size,
+                                      std::move(entry.chunks)});
+        }
+        manifest.save(options.manifestFile);
+    }
+
+    return ret;
+}
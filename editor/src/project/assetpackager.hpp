@@ -0,0 +1,146 @@
+/**
+ *  xEditor - Editor and tools for creating games
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XEDITOR_ASSETPACKAGER_HPP
+#define XEDITOR_ASSETPACKAGER_HPP
+
+#include <atomic>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "xng/crypto/cryptodriver.hpp"
+
+#include "project/assetbundle.hpp"
+
+struct PackageOptions {
+    std::filesystem::path manifestFile; // The path of the manifest of the pak file, if empty no data is reused
+    std::function<bool(const std::filesystem::path &)> filter; // If set only the files for which it returns true are packaged
+    std::vector<std::string> accessOrder; // The paths of files in first access order which are stored first in this order
+};
+
+/**
+ * Packages the files in the directory of an asset bundle into a pak file.
+ *
+ * The files are read in chunks on a pool of worker threads, each chunk is compressed and encrypted independently
+ * and the output is streamed to the pak file in access order followed by the remaining files in path order.
+ *
+ * The template project reads the pak files with the AssetPak archive in source/assetpak.hpp.
+ *
+ * Pak layout, all integers are little endian:
+ *
+ *  Header      "XPAK" magic, uint32 version
+ *  Data        The stored data of the entries
+ *  Entry table varint entry count followed by the entries in the order of their data:
+ *                  string path         The path relative to the bundle directory with forward slashes
+ *                  uint64 offset       The offset of the stored data from the beginning of the file
+ *                  uint64 size         The size of the stored data
+ *                  uint64 originalSize The size of the file
+ *                  uint8 flags         ENTRY_COMPRESSED | ENTRY_ENCRYPTED | ENTRY_CHUNKED
+ *                  Chunk index
+ *                      varint chunkSize    The uncompressed size of all chunks except the last
+ *                      varint chunkCount
+ *                      chunkCount times:
+ *                          uint64 offset   The offset of the stored chunk from the offset of the entry
+ *                          string iv       The initialization vector of the chunk if the entry is encrypted
+ *  Preload     varint count followed by the varint indices of the entries in first access order,
+ *              the count is 0 unless the bundle enables preload hints
+ *  Footer      uint64 entry table offset, uint64 size of the entry and preload tables, "XPAK" magic
+ *
+ * Strings are stored as a varint length followed by the bytes.
+ *
+ * Every chunk is compressed to a gzip member and then encrypted with the key of the bundle and its own
+ * initialization vector. A stored chunk ends at the offset of the next chunk or the end of the entry,
+ * so readers can locate the chunk containing an offset from the chunk index and decode it on its own.
+ * The entries of seekable bundles are flagged as chunked, readers decode them on demand while reading and seeking
+ * instead of decoding the whole file when it is opened.
+ *
+ * When a manifest file is passed the packager records the content hash and stored location of every chunk
+ * and reuses the stored data of the previous pak on the next run:
+ *  - Files with unchanged size and modification time are copied from the previous pak without being read.
+ *  - Compressed or encrypted chunks whose content hash is found in the manifest are copied instead of
+ *    compressed and encrypted again, after decoding the stored chunk and comparing it with the file data.
+ * The manifest is ignored if the pak file or the packaging settings changed since it was written.
+ *
+ * The entries of files in the access order are stored contiguously at the start of the data so that
+ * reading them at startup is sequential, the preload table lists them for readers which prefetch the range.
+ */
+class AssetPackager {
+public:
+    static const uint32_t VERSION = 5;
+
+    enum EntryFlags : uint8_t {
+        ENTRY_COMPRESSED = 1 << 0,
+        ENTRY_ENCRYPTED = 1 << 1,
+        ENTRY_CHUNKED = 1 << 2
+    };
+
+    struct Result {
+        size_t fileCount = 0;
+        uint64_t inputBytes = 0; // The combined size of the packaged files
+        uint64_t outputBytes = 0; // The size of the written pak file
+        size_t reusedFileCount = 0; // The number of files which were copied from the previous pak
+        size_t reusedChunkCount = 0; // The number of changed file chunks which were copied from the previous pak
+    };
+
+    /**
+     * @param crypto The driver used to create the compression and encryption instances of the workers
+     * @param threadCount The number of worker threads, 0 uses the number of hardware threads
+     * @param chunkSize The number of bytes of a file which are read and compressed by a worker at once,
+     *                  and the uncompressed size of the stored chunks
+     */
+    explicit AssetPackager(xng::CryptoDriver &crypto,
+                           unsigned int threadCount = 0,
+                           size_t chunkSize = 1024 * 1024);
+
+    /**
+     * Package all files in the directory into the pak file.
+     *
+     * The pak is written to a temporary file which replaces outputFile once all files were packaged.
+     * Hidden files and directories are not packaged.
+     *
+     * Throws std::runtime_error if a file cannot be read or the output cannot be written.
+     *
+     * @param bundle The bundle settings
+     * @param directory The bundle directory
+     * @param outputFile The path of the pak file
+     * @param options
+     * @return
+     */
+    Result package(const AssetBundle &bundle,
+                   const std::filesystem::path &directory,
+                   const std::filesystem::path &outputFile,
+                   const PackageOptions &options = {});
+
+    /**
+     * Cancel a running package() call which then throws, Can be called from any thread.
+     */
+    void cancel() {
+        cancelled = true;
+    }
+
+private:
+    xng::CryptoDriver &crypto;
+    unsigned int threadCount;
+    size_t chunkSize;
+    std::atomic<bool> cancelled = false;
+};
+
+#endif //XEDITOR_ASSETPACKAGER_HPP
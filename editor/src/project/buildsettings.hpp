@@ -100,16 +100,24 @@ struct BuildSettings : public Messageable {
 
         std::filesystem::create_directories(dir);
 
+        QStringList arguments = {projectDir.string().c_str(),
+                                 "-DEXE_NAME=" + QString(gameTargetName.c_str()),
+                                 "-DPLUGIN_NAME=" + QString(pluginTargetName.c_str()),
+                                 "-DSRC_DIR=" + QString(concatCmakeList(sourceDirectories).c_str()),
+                                 "-DINC_DIR=" + QString(concatCmakeList(includeDirectories).c_str()),
+                                 "-DLNK_DIR=" + QString(concatCmakeList(linkDirectories).c_str()),
+                                 "-DLINK=" + QString(concatCmakeList(linkedLibraries).c_str())};
+
+        // Let the build regenerate the component headers with the header tool that ships with the editor
+        auto headerTool = Paths::headerToolExecutablePath();
+        if (std::filesystem::exists(headerTool)) {
+            arguments.append("-DHEADER_TOOL=" + QString(headerTool.string().c_str()));
+        }
+
         QProcess process;
         process.setWorkingDirectory(dir.string().c_str());
         process.setProgram(cmakeCommand.c_str());
-        process.setArguments({projectDir.string().c_str(),
-                              "-DEXE_NAME=" + QString(gameTargetName.c_str()),
-                              "-DPLUGIN_NAME=" + QString(pluginTargetName.c_str()),
-                              "-DSRC_DIR=" + QString(concatCmakeList(sourceDirectories).c_str()),
-                              "-DINC_DIR=" + QString(concatCmakeList(includeDirectories).c_str()),
-                              "-DLNK_DIR=" + QString(concatCmakeList(linkDirectories).c_str()),
-                              "-DLINK=" + QString(concatCmakeList(linkedLibraries).c_str())});
+        process.setArguments(arguments);
         process.start();
         process.waitForFinished();
         output = process.readAllStandardOutput().toStdString();
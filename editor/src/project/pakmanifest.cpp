@@ -0,0 +1,124 @@
+/**
+ *  xEditor - Editor and tools for creating games
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "project/pakmanifest.hpp"
+
+#include "headertool/mappedfile.hpp"
+
+#include "io/binaryio.hpp"
+#include "io/fileutil.hpp"
+
+static const uint32_t MANIFEST_MAGIC = 0x4D4B5058; // XPKM
+
+bool PakManifest::load(const std::filesystem::path &file) {
+    clear();
+
+    if (!std::filesystem::exists(file)) {
+        return false;
+    }
+
+    try {
+        xng::MappedFile data(file);
+        BinaryReader reader(data.view());
+        if (reader.read<uint32_t>() != MANIFEST_MAGIC
+            || reader.read<uint32_t>() != VERSION) {
+            return false;
+        }
+        settingsHash = reader.read<uint64_t>();
+        pakSize = reader.read<uint64_t>();
+        pakModificationTime = reader.read<int64_t>();
+        auto count = reader.readVarInt();
+        for (auto i = 0u; i < count; i++) {
+            auto name = reader.readString();
+            Entry entry;
+            entry.fileSize = reader.read<uint64_t>();
+            entry.modificationTime = reader.read<int64_t>();
+            entry.offset = reader.read<uint64_t>();
+            entry.size = reader.read<uint64_t>();
+            auto chunkCount = reader.readVarInt();
+            for (auto c = 0u; c < chunkCount; c++) {
+                Chunk chunk;
+                chunk.hash = reader.read<uint64_t>();
+                chunk.originalSize = reader.readVarInt();
+                chunk.offset = reader.readVarInt();
+                chunk.size = reader.readVarInt();
+                chunk.iv = reader.readString();
+                entry.chunks.emplace_back(chunk);
+            }
+            entries[name] = std::move(entry);
+        }
+    } catch (const std::exception &e) {
+        clear();
+        return false;
+    }
+
+    return true;
+}
+
+void PakManifest::save(const std::filesystem::path &file) const {
+    std::string buffer;
+    BinaryWriter writer(buffer);
+
+    writer.write<uint32_t>(MANIFEST_MAGIC);
+    writer.write<uint32_t>(VERSION);
+    writer.write<uint64_t>(settingsHash);
+    writer.write<uint64_t>(pakSize);
+    writer.write<int64_t>(pakModificationTime);
+    writer.writeVarInt(entries.size());
+    for (auto &pair: entries) {
+        writer.writeString(pair.first);
+        writer.write<uint64_t>(pair.second.fileSize);
+        writer.write<int64_t>(pair.second.modificationTime);
+        writer.write<uint64_t>(pair.second.offset);
+        writer.write<uint64_t>(pair.second.size);
+        writer.writeVarInt(pair.second.chunks.size());
+        for (auto &chunk: pair.second.chunks) {
+            writer.write<uint64_t>(chunk.hash);
+            writer.writeVarInt(chunk.originalSize);
+            writer.writeVarInt(chunk.offset);
+            writer.writeVarInt(chunk.size);
+            writer.writeString(chunk.iv);
+        }
+    }
+
+    if (file.has_parent_path())
+        std::filesystem::create_directories(file.parent_path());
+
+    FileUtil::writeAtomic(file, buffer);
+}
+
+const PakManifest::Entry *PakManifest::find(const std::string &name) const {
+    auto it = entries.find(name);
+    if (it == entries.end()) {
+        return nullptr;
+    } else {
+        return &it->second;
+    }
+}
+
+void PakManifest::set(const std::string &name, Entry entry) {
+    entries[name] = std::move(entry);
+}
+
+void PakManifest::clear() {
+    entries.clear();
+    settingsHash = 0;
+    pakSize = 0;
+    pakModificationTime = 0;
+}
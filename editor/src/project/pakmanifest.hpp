@@ -0,0 +1,94 @@
+/**
+ *  xEditor - Editor and tools for creating games
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XEDITOR_PAKMANIFEST_HPP
+#define XEDITOR_PAKMANIFEST_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * Records the content of a packaged pak file so that the next packaging run can reuse the stored data
+ * of unchanged files and chunks instead of compressing and encrypting them again.
+ */
+class PakManifest {
+public:
+    /**
+     * Increment when the manifest layout changes to discard previously written manifests.
+     */
+    static const uint32_t VERSION = 3;
+
+    struct Chunk {
+        uint64_t hash = 0; // The content hash of the uncompressed chunk
+        uint64_t originalSize = 0;
+        uint64_t offset = 0; // The offset of the stored chunk relative to the entry
+        uint64_t size = 0; // The size of the stored chunk
+        std::string iv; // The initialization vector of the chunk if it was encrypted
+    };
+
+    struct Entry {
+        uint64_t fileSize = 0;
+        int64_t modificationTime = 0;
+        uint64_t offset = 0; // The offset of the stored data in the pak file
+        uint64_t size = 0; // The size of the stored data
+        std::vector<Chunk> chunks;
+    };
+
+    /**
+     * Load the manifest from the file.
+     * If the file does not exist, is corrupted or was written by a different version the manifest is cleared.
+     *
+     * @param file
+     * @return True if the manifest was loaded
+     */
+    bool load(const std::filesystem::path &file);
+
+    /**
+     * Write the manifest to the file by writing to a temporary file and renaming it.
+     *
+     * @param file
+     */
+    void save(const std::filesystem::path &file) const;
+
+    /**
+     * @param name
+     * @return The entry of the file or nullptr if the file is not in the manifest
+     */
+    const Entry *find(const std::string &name) const;
+
+    void set(const std::string &name, Entry entry);
+
+    void clear();
+
+    const std::map<std::string, Entry> &getEntries() const {
+        return entries;
+    }
+
+    uint64_t settingsHash = 0; // The hash of the packaging settings which affect the stored data
+    uint64_t pakSize = 0; // The size of the pak file which the manifest describes
+    int64_t pakModificationTime = 0; // The modification time of the pak file which the manifest describes
+
+private:
+    std::map<std::string, Entry> entries;
+};
+
+#endif //XEDITOR_PAKMANIFEST_HPP
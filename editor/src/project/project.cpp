@@ -23,11 +23,458 @@
 
 #include "xng/io/protocol/jsonprotocol.hpp"
 #include "xng/io/archive/directoryarchive.hpp"
+#include "xng/driver/driverregistry.hpp"
 
 #include <filesystem>
 #include <fstream>
 
 #include "io/paths.hpp"
+#include "io/fileutil.hpp"
+
+#include "project/assetpackager.hpp"
+#include "project/templateheaders.hpp"
+#include "project/tracingarchive.hpp"
+
+static const char *TEMPLATE_ASSET_PAK = R"###(
+#ifndef NEWPROJECT_ASSETPAK_HPP
+#define NEWPROJECT_ASSETPAK_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+
+#include "xng/xng.hpp"
+
+using namespace xng;
+
+/**
+ * Reads the pak files which the editor packages from the asset bundles of the project into the data directory.
+ * The layout of the pak files is documented in project/assetpackager.hpp of the editor sources.
+ *
+ * Files of seekable bundles are opened as streams which decode the chunk containing the read position on demand,
+ * other files are decoded completely when they are opened.
+ * The stored data of the files in the preload table of the pak is read with a single sequential read
+ * when the pak is opened and released once a file was decoded or the stream of a seekable file is destroyed.
+ * The streams keep the pak alive, so it has to be created with std::make_shared.
+ */
+class AssetPak : public Archive, public std::enable_shared_from_this<AssetPak> {
+public:
+    static const uint32_t VERSION = 5;
+
+    enum EntryFlags : uint8_t {
+        ENTRY_COMPRESSED = 1 << 0,
+        ENTRY_ENCRYPTED = 1 << 1,
+        ENTRY_CHUNKED = 1 << 2
+    };
+
+    /**
+     * @param stream The stream of the pak file
+     * @param crypto The driver which creates the gzip and aes instances of the decoded chunks, must outlive the pak
+     * @param key The key of the asset bundle if it is encrypted
+     */
+    AssetPak(std::unique_ptr<std::istream> stream, CryptoDriver &crypto, AES::Key key = {})
+            : stream(std::move(stream)),
+              crypto(crypto),
+              key(std::move(key)) {
+        auto header = readRange(0, HEADER_SIZE);
+        TableReader headerReader(header);
+        if (headerReader.readBytes(MAGIC.size()) != MAGIC) {
+            throw std::runtime_error("Invalid asset pak");
+        }
+        if (headerReader.read<uint32_t>() != VERSION) {
+            throw std::runtime_error("Unsupported asset pak version");
+        }
+
+        this->stream->seekg(0, std::istream::end);
+        auto fileSize = static_cast<uint64_t>(this->stream->tellg());
+        if (fileSize < HEADER_SIZE + FOOTER_SIZE) {
+            throw std::runtime_error("Invalid asset pak");
+        }
+        auto footer = readRange(fileSize - FOOTER_SIZE, FOOTER_SIZE);
+        TableReader footerReader(footer);
+        auto tableOffset = footerReader.read<uint64_t>();
+        auto tableSize = footerReader.read<uint64_t>();
+        if (footerReader.readBytes(MAGIC.size()) != MAGIC || tableOffset + tableSize > fileSize - FOOTER_SIZE) {
+            throw std::runtime_error("Invalid asset pak");
+        }
+
+        auto table = readRange(tableOffset, tableSize);
+        TableReader reader(table);
+        auto count = reader.readVarInt();
+        std::vector<Entry *> entryIndex;
+        for (auto i = 0u; i < count; i++) {
+            auto path = reader.readString();
+            Entry entry;
+            entry.offset = reader.read<uint64_t>();
+            entry.size = reader.read<uint64_t>();
+            entry.originalSize = reader.read<uint64_t>();
+            entry.flags = reader.read<uint8_t>();
+            entry.chunkSize = reader.readVarInt();
+            auto chunkCount = reader.readVarInt();
+            for (auto c = 0u; c < chunkCount; c++) {
+                Chunk chunk;
+                chunk.offset = reader.read<uint64_t>();
+                if (entry.flags & ENTRY_ENCRYPTED) {
+                    chunk.iv = reader.readString();
+                }
+                entry.chunks.emplace_back(std::move(chunk));
+            }
+            if (entry.chunkSize == 0 || entry.chunks.empty()) {
+                throw std::runtime_error("Invalid asset pak entry: " + path);
+            }
+            auto &inserted = entries[path];
+            inserted = std::move(entry);
+            entryIndex.emplace_back(&inserted);
+        }
+
+        std::vector<const Entry *> preload;
+        auto preloadCount = reader.readVarInt();
+        for (auto i = 0u; i < preloadCount; i++) {
+            preload.emplace_back(entryIndex.at(reader.readVarInt()));
+        }
+        prefetch(preload);
+    }
+
+    std::unique_ptr<std::istream> open(const std::string &path) override {
+        auto it = entries.find(normalizePath(path));
+        if (it == entries.end()) {
+            throw std::runtime_error("Asset pak entry not found: " + path);
+        }
+        auto &entry = it->second;
+
+        if (entry.flags & ENTRY_CHUNKED) {
+            return std::make_unique<ChunkStream>(shared_from_this(), entry);
+        }
+
+        std::string ret;
+        ret.reserve(entry.originalSize);
+        for (auto i = 0u; i < entry.chunks.size(); i++) {
+            auto chunk = decodeChunk(entry, i);
+            ret.append(chunk.data(), chunk.size());
+        }
+        releasePreloaded(entry);
+        if (ret.size() != entry.originalSize) {
+            throw std::runtime_error("Invalid asset pak entry: " + path);
+        }
+        return std::make_unique<std::istringstream>(std::move(ret));
+    }
+
+    bool exists(const std::string &path) override {
+        return entries.find(normalizePath(path)) != entries.end();
+    }
+
+private:
+    struct Chunk {
+        uint64_t offset = 0;
+        std::string iv;
+    };
+
+    struct Entry {
+        uint64_t offset = 0;
+        uint64_t size = 0;
+        uint64_t originalSize = 0;
+        uint8_t flags = 0;
+        uint64_t chunkSize = 0;
+        std::vector<Chunk> chunks;
+    };
+
+    // Decodes the chunk which contains the read position when reading or seeking
+    class ChunkBuffer : public std::streambuf {
+    public:
+        ChunkBuffer(std::shared_ptr<AssetPak> pak, const Entry &entry)
+                : pak(std::move(pak)), entry(entry) {}
+
+        ~ChunkBuffer() override {
+            pak->releasePreloaded(entry);
+        }
+
+    protected:
+        int_type underflow() override {
+            while (gptr() == egptr()) {
+                if (!load(loadedChunk == NO_CHUNK ? 0 : loadedChunk + 1)) {
+                    return traits_type::eof();
+                }
+            }
+            return traits_type::to_int_type(*gptr());
+        }
+
+        pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override {
+            off_type base;
+            if (dir == std::ios_base::beg) {
+                base = 0;
+            } else if (dir == std::ios_base::cur) {
+                base = static_cast<off_type>(chunkStart + (gptr() - eback()));
+            } else {
+                base = static_cast<off_type>(entry.originalSize);
+            }
+            return seekpos(pos_type(base + off), which);
+        }
+
+        pos_type seekpos(pos_type pos, std::ios_base::openmode which) override {
+            auto position = static_cast<off_type>(pos);
+            if (!(which & std::ios_base::in)
+                || position < 0
+                || static_cast<uint64_t>(position) > entry.originalSize) {
+                return pos_type(off_type(-1));
+            }
+            auto offset = static_cast<uint64_t>(position);
+            if (offset == entry.originalSize) {
+                data.clear();
+                loadedChunk = entry.chunks.size();
+                chunkStart = entry.originalSize;
+                setg(data.data(), data.data(), data.data());
+                return pos;
+            }
+            auto index = static_cast<size_t>(offset / entry.chunkSize);
+            if (index != loadedChunk && !load(index)) {
+                return pos_type(off_type(-1));
+            }
+            setg(eback(), eback() + (offset - chunkStart), egptr());
+            return pos;
+        }
+
+    private:
+        static const size_t NO_CHUNK = SIZE_MAX;
+
+        bool load(size_t index) {
+            if (index >= entry.chunks.size()) {
+                return false;
+            }
+            data = pak->decodeChunk(entry, index);
+            loadedChunk = index;
+            chunkStart = index * entry.chunkSize;
+            setg(data.data(), data.data(), data.data() + data.size());
+            return true;
+        }
+
+        std::shared_ptr<AssetPak> pak;
+        const Entry &entry;
+        std::vector<char> data;
+        size_t loadedChunk = NO_CHUNK;
+        uint64_t chunkStart = 0;
+    };
+
+    class ChunkStream : public std::istream {
+    public:
+        ChunkStream(std::shared_ptr<AssetPak> pak, const Entry &entry)
+                : std::istream(nullptr), buffer(std::move(pak), entry) {
+            rdbuf(&buffer);
+        }
+
+    private:
+        ChunkBuffer buffer;
+    };
+
+    // Reads the little endian integers, variable length integers and strings of the pak tables
+    class TableReader {
+    public:
+        explicit TableReader(const std::string &data) : data(data) {}
+
+        template<typename T>
+        T read() {
+            auto bytes = readBytes(sizeof(T));
+            uint64_t ret = 0;
+            for (auto i = 0u; i < sizeof(T); i++) {
+                ret |= static_cast<uint64_t>(static_cast<uint8_t>(bytes[i])) << (i * 8);
+            }
+            return static_cast<T>(ret);
+        }
+
+        uint64_t readVarInt() {
+            uint64_t ret = 0;
+            for (int shift = 0; shift < 64; shift += 7) {
+                auto byte = read<uint8_t>();
+                ret |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0) {
+                    return ret;
+                }
+            }
+            throw std::runtime_error("Invalid asset pak");
+        }
+
+        std::string readString() {
+            return readBytes(readVarInt());
+        }
+
+        std::string readBytes(uint64_t count) {
+            if (count > data.size() - offset) {
+                throw std::runtime_error("Invalid asset pak");
+            }
+            auto ret = data.substr(offset, count);
+            offset += count;
+            return ret;
+        }
+
+    private:
+        const std::string &data;
+        size_t offset = 0;
+    };
+
+    static inline const std::string MAGIC = "XPAK";
+    static const uint64_t HEADER_SIZE = 8;
+    static const uint64_t FOOTER_SIZE = 20;
+
+    static std::string normalizePath(const std::string &path) {
+        auto ret = std::filesystem::path(path).lexically_normal().generic_string();
+        while (!ret.empty() && ret.front() == '/') {
+            ret.erase(0, 1);
+        }
+        return ret;
+    }
+
+    std::vector<char> decodeChunk(const Entry &entry, size_t index) {
+        auto &chunk = entry.chunks.at(index);
+        auto end = index + 1 < entry.chunks.size() ? entry.chunks.at(index + 1).offset : entry.size;
+        if (chunk.offset > end || end > entry.size) {
+            throw std::runtime_error("Invalid asset pak chunk");
+        }
+
+        std::vector<char> ret;
+        {
+            // Only the stream is shared, the chunks are decoded in parallel by the calling threads
+            std::lock_guard<std::mutex> guard(mutex);
+            auto it = preloaded.find(&entry);
+            if (it != preloaded.end()) {
+                ret.assign(it->second.begin() + static_cast<std::ptrdiff_t>(chunk.offset),
+                           it->second.begin() + static_cast<std::ptrdiff_t>(end));
+            } else {
+                auto stored = readRange(entry.offset + chunk.offset, end - chunk.offset);
+                ret.assign(stored.begin(), stored.end());
+            }
+        }
+        if (entry.flags & ENTRY_ENCRYPTED) {
+            ret = crypto.createAES()->decrypt(key, chunk.iv, ret);
+        }
+        if (entry.flags & ENTRY_COMPRESSED) {
+            ret = crypto.createGzip()->decompress(ret);
+        }
+        return ret;
+    }
+
+    void releasePreloaded(const Entry &entry) {
+        std::lock_guard<std::mutex> guard(mutex);
+        preloaded.erase(&entry);
+    }
+
+    /**
+     * Read the stored data of the entries, the packager stores them contiguously so the range is read at once.
+     */
+    void prefetch(const std::vector<const Entry *> &preload) {
+        if (preload.empty()) {
+            return;
+        }
+        auto begin = preload.front()->offset;
+        auto end = begin;
+        for (auto *entry: preload) {
+            begin = std::min(begin, entry->offset);
+            end = std::max(end, entry->offset + entry->size);
+        }
+        std::lock_guard<std::mutex> guard(mutex);
+        auto data = readRange(begin, end - begin);
+        for (auto *entry: preload) {
+            preloaded[entry] = data.substr(entry->offset - begin, entry->size);
+        }
+    }
+
+    std::string readRange(uint64_t offset, uint64_t size) {
+        std::string ret(size, '\0');
+        stream->clear();
+        stream->seekg(static_cast<std::streamoff>(offset));
+        if (!stream->read(ret.data(), static_cast<std::streamsize>(size))) {
+            throw std::runtime_error("Failed to read asset pak");
+        }
+        return ret;
+    }
+
+    std::unique_ptr<std::istream> stream;
+    CryptoDriver &crypto;
+    AES::Key key;
+
+    std::mutex mutex;
+    std::unordered_map<std::string, Entry> entries;
+    std::unordered_map<const Entry *, std::string> preloaded; // The stored data of the prefetched entries
+};
+
+#endif //NEWPROJECT_ASSETPAK_HPP
+)###";
+
+static const char *TEMPLATE_ACCESS_TRACE = R"###(
+#ifndef NEWPROJECT_ACCESSTRACE_HPP
+#define NEWPROJECT_ACCESSTRACE_HPP
+
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <set>
+
+#include "xng/xng.hpp"
+
+using namespace xng;
+
+/**
+ * Writes the first access of every asset file to a trace file, one scheme://path line per file.
+ *
+ * The editor reads the trace from access-trace.txt in the project directory when building
+ * and stores the traced files first in the pak files, in first access order.
+ */
+class AccessTrace {
+public:
+    explicit AccessTrace(const std::filesystem::path &file)
+            : stream(file, std::ofstream::trunc) {
+        if (!stream) {
+            throw std::runtime_error("Failed to open access trace " + file.string());
+        }
+        stream << "# Files of the asset bundles in first access order\n";
+        stream.flush();
+    }
+
+    /**
+     * Can be called from any thread, every line is flushed so that the trace is complete if the game crashes.
+     */
+    void record(const std::string &scheme, const std::string &path) {
+        std::lock_guard<std::mutex> guard(mutex);
+        if (recorded.insert(scheme + "://" + path).second) {
+            stream << scheme << "://" << path << "\n";
+            stream.flush();
+        }
+    }
+
+private:
+    std::mutex mutex;
+    std::ofstream stream;
+    std::set<std::string> recorded;
+};
+
+/**
+ * Records the opened files of an archive in the access trace.
+ */
+class TracingArchive : public Archive {
+public:
+    TracingArchive(std::string scheme, std::shared_ptr<Archive> archive, std::shared_ptr<AccessTrace> trace)
+            : scheme(std::move(scheme)), archive(std::move(archive)), trace(std::move(trace)) {}
+
+    std::unique_ptr<std::istream> open(const std::string &path) override {
+        auto ret = archive->open(path);
+        trace->record(scheme, path);
+        return ret;
+    }
+
+    bool exists(const std::string &path) override {
+        return archive->exists(path);
+    }
+
+private:
+    std::string scheme;
+    std::shared_ptr<Archive> archive;
+    std::shared_ptr<AccessTrace> trace;
+};
+
+#endif //NEWPROJECT_ACCESSTRACE_HPP
+)###";
 
 static const char *TEMPLATE_GAME_CLASS = R"###(
 #ifndef NEWPROJECT_GAME_HPP
@@ -35,23 +482,30 @@ static const char *TEMPLATE_GAME_CLASS = R"###(
 
 #include "xng/xng.hpp"
 
+#include "assetpak.hpp"
+#include "accesstrace.hpp"
+
 using namespace xng;
 
 class Game : public Application {
 public:
     Game(int argc, char *argv[])
             : Application(argc, argv),
-              dataArchive(std::make_unique<DirectoryArchive>(std::filesystem::current_path() / "data/")),
-              assetPakStream(dataArchive->open("assets.pak")),
               cryptoDriver(DriverRegistry::load<CryptoDriver>("cryptopp")),
-              zip(cryptoDriver->createGzip()),
-              sha(cryptoDriver->createSHA()),
-              assetPakArchive(std::make_shared<PakArchive>(
-                      std::vector<std::reference_wrapper<std::istream>>({*assetPakStream}),
-                      false,
-                      *zip,
-                      *sha)){
-        ResourceRegistry::getDefaultRegistry().addArchive("assets", assetPakArchive); // The default project settings set the assets/ directory as an asset bundle. It is made available under the "assets" scheme.
+              dataArchive(std::make_unique<DirectoryArchive>(std::filesystem::current_path() / "data/")),
+              assetPakArchive(std::make_shared<AssetPak>(dataArchive->open("Assets.pak"), *cryptoDriver)) {
+        std::shared_ptr<Archive> assetArchive = assetPakArchive;
+
+        // Run the game with --trace-assets <project directory>/access-trace.txt to record the order in which the assets are opened.
+        // The editor stores the traced files first in the pak files of the next build.
+        for (auto i = 1; i + 1 < argc; i++) {
+            if (std::string(argv[i]) == "--trace-assets") {
+                accessTrace = std::make_shared<AccessTrace>(argv[i + 1]);
+                assetArchive = std::make_shared<TracingArchive>("assets", assetArchive, accessTrace);
+            }
+        }
+
+        ResourceRegistry::getDefaultRegistry().addArchive("assets", assetArchive); // The default project settings set the assets/ directory as an asset bundle. It is made available under the "assets" scheme.
     }
 
     void start() override {
@@ -74,13 +528,11 @@ private:
 
     SystemRuntime systemRuntime;
 
-    std::unique_ptr<GZip> zip;
-    std::unique_ptr<SHA> sha;
-
     std::unique_ptr<DirectoryArchive> dataArchive;
 
-    std::unique_ptr<std::istream> assetPakStream;
-    std::shared_ptr<PakArchive> assetPakArchive;
+    std::shared_ptr<AssetPak> assetPakArchive; // Pass the key of the bundle to the AssetPak if the bundle is encrypted
+
+    std::shared_ptr<AccessTrace> accessTrace;
 };
 
 #endif //NEWPROJECT_GAME_HPP
@@ -101,6 +553,9 @@ static const char *TEMPLATE_PLUGIN_MAIN = R"###(
     which will allow them to be used in the editor play mode.
 
     For creating components in the scene it is not required to register components.
+
+    When the project is built with the header tool the plugin also exports the metadata of the components
+    in the source directories, which the editor reads instead of parsing the sources while the plugin is up to date.
 **/
 
 void load() {
@@ -119,7 +574,7 @@ void unload() {
 )###";
 
 static const char *TEMPLATE_CMAKE_LISTS = R"###(
-cmake_minimum_required(VERSION 3.0.0)
+cmake_minimum_required(VERSION 3.20)
 
 project(NewProject)
 
@@ -145,6 +600,9 @@ endif ()
 if (NOT DEFINED LINK)
     set(LINK xengine) # Link libraries
 endif ()
+if (NOT DEFINED HEADER_TOOL)
+    find_program(HEADER_TOOL xheadertool) # The header tool executable which generates the component headers
+endif ()
 
 file(GLOB_RECURSE SRC ${SRC_DIR}*.c ${SRC_DIR}*.cpp)
 
@@ -174,6 +632,46 @@ add_library(${PLUGIN_NAME} SHARED ${PLUGIN_SRC})
 target_include_directories(${PLUGIN_NAME} PUBLIC ${INC_DIR})
 target_link_directories(${PLUGIN_NAME} PUBLIC ${LNK_DIR})
 target_link_libraries(${PLUGIN_NAME} ${LINK})
+
+# Regenerate the generated header of every changed component header before compiling
+if (HEADER_TOOL)
+    file(GLOB_RECURSE COMPONENT_HEADERS CONFIGURE_DEPENDS ${SRC_DIR}*.h ${SRC_DIR}*.hpp)
+    list(FILTER COMPONENT_HEADERS EXCLUDE REGEX "\\.generated\\.[^/]*$")
+    set(COMPONENT_STAMPS)
+    foreach (HEADER ${COMPONENT_HEADERS})
+        file(RELATIVE_PATH HEADER_NAME ${CMAKE_CURRENT_SOURCE_DIR} ${HEADER})
+        set(STAMP ${CMAKE_CURRENT_BINARY_DIR}/headertool/${HEADER_NAME}.stamp)
+        # The generated header is written next to the header, component.hpp -> component.generated.hpp.
+        # It is declared as a byproduct of the headers which declared components when the project was configured,
+        # the header tool keeps it in place when the components are removed so that the byproduct always exists.
+        set(GENERATED_HEADER)
+        file(STRINGS ${HEADER} HEADER_COMPONENTS REGEX "XCOMPONENT")
+        if (HEADER_COMPONENTS)
+            get_filename_component(HEADER_DIR ${HEADER} DIRECTORY)
+            get_filename_component(HEADER_BASE ${HEADER} NAME_WLE)
+            get_filename_component(HEADER_EXT ${HEADER} LAST_EXT)
+            set(GENERATED_HEADER ${HEADER_DIR}/${HEADER_BASE}.generated${HEADER_EXT})
+        endif ()
+        add_custom_command(OUTPUT ${STAMP}
+                BYPRODUCTS ${GENERATED_HEADER}
+                COMMAND ${HEADER_TOOL} --quiet --stamp ${STAMP} --depfile ${STAMP}.d ${HEADER}
+                DEPENDS ${HEADER} ${HEADER_TOOL}
+                DEPFILE ${STAMP}.d
+                COMMENT "Generating component header for ${HEADER_NAME}")
+        list(APPEND COMPONENT_STAMPS ${STAMP})
+    endforeach ()
+    add_custom_target(${EXE_NAME}_headers DEPENDS ${COMPONENT_STAMPS})
+    add_dependencies(${EXE_NAME} ${EXE_NAME}_headers)
+    add_dependencies(${PLUGIN_NAME} ${EXE_NAME}_headers)
+
+    # Export the metadata of all components from the plugin so that the editor does not have to parse the sources
+    set(COMPONENT_METADATA ${CMAKE_CURRENT_BINARY_DIR}/headertool/componentmetadata.generated.cpp)
+    add_custom_command(OUTPUT ${COMPONENT_METADATA}
+            COMMAND ${HEADER_TOOL} --quiet --index ${CMAKE_CURRENT_BINARY_DIR}/headertool/index.bin --metadata ${COMPONENT_METADATA} ${COMPONENT_HEADERS}
+            DEPENDS ${COMPONENT_STAMPS} ${HEADER_TOOL}
+            COMMENT "Generating component metadata")
+    target_sources(${PLUGIN_NAME} PRIVATE ${COMPONENT_METADATA})
+endif ()
 )###";
 
 void Project::createNewProject(const std::filesystem::path &outputDir) {
@@ -231,6 +729,9 @@ void Project::createNewProject(const std::filesystem::path &outputDir) {
     auto sourceDirectoryPath = outputDir;
     sourceDirectoryPath.append("source/");
 
+    auto headerToolDirectoryPath = sourceDirectoryPath;
+    headerToolDirectoryPath.append("headertool/");
+
     auto assetDirectoryPath = outputDir;
     assetDirectoryPath.append("assets/");
 
@@ -246,13 +747,30 @@ void Project::createNewProject(const std::filesystem::path &outputDir) {
     auto gameHeaderPath = sourceDirectoryPath;
     gameHeaderPath.append("game.hpp");
 
+    auto assetPakHeaderPath = sourceDirectoryPath;
+    assetPakHeaderPath.append("assetpak.hpp");
+
+    auto accessTraceHeaderPath = sourceDirectoryPath;
+    accessTraceHeaderPath.append("accesstrace.hpp");
+
     auto pluginMainPath = pluginDirectoryPath;
     pluginMainPath.append("main.cpp");
 
+    // The runtime of the generated component headers, which include it from the include directory of the project
+    auto headerToolRuntimePath = headerToolDirectoryPath;
+    headerToolRuntimePath.append("headertoolruntime.hpp");
+
+    auto variableTypePath = headerToolDirectoryPath;
+    variableTypePath.append("variabletype.hpp");
+
     if (!std::filesystem::create_directories(sourceDirectoryPath)) {
         throw std::runtime_error("Failed to create directory: " + sourceDirectoryPath.string());
     }
 
+    if (!std::filesystem::create_directories(headerToolDirectoryPath)) {
+        throw std::runtime_error("Failed to create directory: " + headerToolDirectoryPath.string());
+    }
+
     if (!std::filesystem::create_directories(assetDirectoryPath)) {
         throw std::runtime_error("Failed to create directory: " + assetDirectoryPath.string());
     }
@@ -284,10 +802,30 @@ void Project::createNewProject(const std::filesystem::path &outputDir) {
     fs.flush();
     fs.close();
 
+    fs.open(assetPakHeaderPath, std::fstream::out);
+    fs << TEMPLATE_ASSET_PAK;
+    fs.flush();
+    fs.close();
+
+    fs.open(accessTraceHeaderPath, std::fstream::out);
+    fs << TEMPLATE_ACCESS_TRACE;
+    fs.flush();
+    fs.close();
+
     fs.open(pluginMainPath, std::fstream::out);
     fs << TEMPLATE_PLUGIN_MAIN;
     fs.flush();
     fs.close();
+
+    fs.open(headerToolRuntimePath, std::fstream::out);
+    fs << TEMPLATE_HEADERTOOL_RUNTIME;
+    fs.flush();
+    fs.close();
+
+    fs.open(variableTypePath, std::fstream::out);
+    fs << TEMPLATE_VARIABLE_TYPE;
+    fs.flush();
+    fs.close();
 }
 
 void Project::load(const std::filesystem::path &dir) {
@@ -305,12 +843,16 @@ void Project::load(const std::filesystem::path &dir) {
     settings = {};
     settings << msg;
 
-    // Create and register asset bundle archives
+    // Create and register asset bundle archives, the accesses are recorded while an access trace is running
+    accessTrace = std::make_shared<AccessTrace>();
     for (auto &bundle: settings.assetBundles) {
         auto bundleDir = dir;
         bundleDir.append(bundle.directory);
         ResourceRegistry::getDefaultRegistry().addArchive(bundle.scheme,
-                                                          std::make_shared<xng::DirectoryArchive>(bundleDir));
+                                                          std::make_shared<TracingArchive>(
+                                                                  bundle.scheme,
+                                                                  std::make_shared<xng::DirectoryArchive>(bundleDir),
+                                                                  accessTrace));
     }
 
     directory = dir;
@@ -324,6 +866,8 @@ bool Project::unload() {
         for (auto &bundle: settings.assetBundles) {
             ResourceRegistry::getDefaultRegistry().removeArchive(bundle.scheme);
         }
+        accessTrace->stop();
+        accessTrace = nullptr;
         directory = std::filesystem::path();
         settings = {};
         return true;
@@ -334,10 +878,63 @@ bool Project::isLoaded() {
     return !directory.empty();
 }
 
-void Project::compile(const BuildSettings &settings) const {
-    // Package asset bundles
+void Project::startAccessTrace() {
+    if (!accessTrace) {
+        throw std::runtime_error("No project loaded");
+    }
+    accessTrace->start();
+}
+
+size_t Project::stopAccessTrace() {
+    if (!accessTrace || !accessTrace->isRecording()) {
+        return 0;
+    }
+    accessTrace->stop();
+    accessTrace->save(getAccessTraceFilePath());
+    return accessTrace->size();
+}
+
+bool Project::isTracingAccess() const {
+    return accessTrace && accessTrace->isRecording();
+}
+
+void Project::compile(const BuildSettings &settings, const std::map<std::string, ComponentMetadata> &metadata) const {
+    auto graph = buildDependencyGraph(metadata);
+    auto referenced = graph.getReferencedFiles();
+
+    AccessTrace trace;
+    if (std::filesystem::exists(getAccessTraceFilePath())) {
+        trace.load(getAccessTraceFilePath());
+    }
+
+    // Package asset bundles into the data directory of the build from which the Game class of the template opens them
+    auto crypto = DriverRegistry::load<CryptoDriver>("cryptopp");
+    AssetPackager packager(*crypto);
+    auto buildDirectory = settings.getBuildDirectory(directory);
+    auto dataDirectory = std::filesystem::path(buildDirectory).append("data");
+    for (auto &bundle: this->settings.assetBundles) {
+        auto bundleDirectory = getProjectDirectory().append(bundle.directory);
+
+        std::filesystem::create_directories(buildDirectory);
+        FileUtil::writeAtomic(std::filesystem::path(buildDirectory).append(bundle.name + ".unreferenced.txt"),
+                              [&graph, &bundleDirectory](std::ostream &stream) {
+                                  graph.writeReport(stream, bundleDirectory);
+                              });
+
+        PackageOptions options;
+        options.manifestFile = getPakManifestFilePath(settings, bundle);
+        options.accessOrder = trace.getPaths(bundle.scheme);
+        if (bundle.referencedOnly) {
+            options.filter = [&referenced](const std::filesystem::path &file) {
+                return referenced.find(file.lexically_normal()) != referenced.end();
+            };
+        }
 
-    // Copy pak files to output dir
+        packager.package(bundle,
+                         bundleDirectory,
+                         std::filesystem::path(dataDirectory).append(bundle.name + ".pak"),
+                         options);
+    }
 
     // Run cmake
 
@@ -346,6 +943,14 @@ void Project::compile(const BuildSettings &settings) const {
     // Copy library binaries
 }
 
+AssetDependencyGraph Project::buildDependencyGraph(const std::map<std::string, ComponentMetadata> &metadata) const {
+    AssetDependencyGraph ret(getBundleDirectories(), metadata);
+    for (auto &bundle: settings.assetBundles) {
+        ret.addDirectory(getProjectDirectory().append(bundle.directory));
+    }
+    return ret;
+}
+
 void Project::save() const {
     auto settingsFile = std::filesystem::path(directory).append(Paths::projectSettingsFilename().toStdString().c_str());
     std::ofstream fs(settingsFile.string());
@@ -378,6 +983,38 @@ std::filesystem::path Project::getPluginLibraryFilePath() const {
     return getPluginDirectory().append(Paths::pluginLibraryFileName().toStdString().c_str());
 }
 
+std::filesystem::path Project::getCacheDirectory() const {
+    return std::filesystem::path(directory).append(Paths::projectCacheDirectory().toStdString().c_str());
+}
+
+std::filesystem::path Project::getHeaderIndexFilePath() const {
+    return getCacheDirectory().append(Paths::headerIndexFileName().toStdString().c_str());
+}
+
+std::filesystem::path Project::getAccessTraceFilePath() const {
+    return getProjectDirectory().append(Paths::accessTraceFileName().toStdString().c_str());
+}
+
+std::filesystem::path Project::getPakManifestFilePath(const BuildSettings &buildSettings,
+                                                     const AssetBundle &bundle) const {
+    return getCacheDirectory()
+            .append(Paths::pakManifestDirectory().toStdString().c_str())
+            .append(buildSettings.name)
+            .append(bundle.name + ".manifest");
+}
+
+std::map<std::string, std::filesystem::path> Project::getBundleDirectories() const {
+    std::map<std::string, std::filesystem::path> ret;
+    for (auto &bundle: settings.assetBundles) {
+        ret[bundle.scheme] = getProjectDirectory().append(bundle.directory);
+    }
+    return ret;
+}
+
+std::filesystem::path Project::getDerivedDataDirectory() const {
+    return getCacheDirectory().append(Paths::derivedDataDirectory().toStdString().c_str());
+}
+
 std::set<std::filesystem::path> Project::getSourceDirectories() const {
     std::set<std::filesystem::path> ret;
     for (auto &buildSettings: settings.buildSettings) {
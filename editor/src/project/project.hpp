@@ -25,6 +25,8 @@
 
 #include "project/buildsettings.hpp"
 #include "project/projectsettings.hpp"
+#include "project/assetdependencygraph.hpp"
+#include "project/accesstrace.hpp"
 
 #include "xng/io/archive.hpp"
 
@@ -61,12 +63,42 @@ public:
 
     bool isLoaded();
 
+    /**
+     * Start recording the files which are opened through the asset bundle archives.
+     */
+    void startAccessTrace();
+
+    /**
+     * Stop recording and write the access trace file which is used to order the files when packaging.
+     *
+     * @return The number of recorded files
+     */
+    size_t stopAccessTrace();
+
+    bool isTracingAccess() const;
+
     /**
      * Compile the project using the specified settings
      *
+     * Writes a report of the files which are not referenced by any scene of each asset bundle to the build directory.
+     *
      * @param settings
+     * @param metadata The metadata of the generic components used to find the assets referenced by scenes
      */
-    void compile(const BuildSettings &settings) const;
+    void compile(const BuildSettings &settings, const std::map<std::string, ComponentMetadata> &metadata) const;
+
+    /**
+     * Build the dependency graph of the scenes in the asset bundle directories.
+     *
+     * @param metadata The metadata of the generic components
+     * @return
+     */
+    AssetDependencyGraph buildDependencyGraph(const std::map<std::string, ComponentMetadata> &metadata) const;
+
+    /**
+     * @return The directories of the asset bundles by the scheme under which they are accessible
+     */
+    std::map<std::string, std::filesystem::path> getBundleDirectories() const;
 
     /**
      * Save the project settings.
@@ -85,6 +117,28 @@ public:
 
     std::filesystem::path getPluginLibraryFilePath() const;
 
+    /**
+     * @return The directory containing editor generated data which can be deleted at any time.
+     */
+    std::filesystem::path getCacheDirectory() const;
+
+    std::filesystem::path getHeaderIndexFilePath() const;
+
+    /**
+     * @return The path of the trace of the order in which the asset bundle files are accessed
+     */
+    std::filesystem::path getAccessTraceFilePath() const;
+
+    /**
+     * @return The path of the manifest which records the packaged contents of the bundle for the build settings.
+     */
+    std::filesystem::path getPakManifestFilePath(const BuildSettings &buildSettings, const AssetBundle &bundle) const;
+
+    /**
+     * @return The directory of the derived data cache which stores the imported asset bundle resources
+     */
+    std::filesystem::path getDerivedDataDirectory() const;
+
     /**
      * @return The sourceDirectories and includeDirectories entries of all build settings appended to the project directory.
      */
@@ -102,6 +156,7 @@ public:
 private:
     std::filesystem::path directory;
     ProjectSettings settings;
+    std::shared_ptr<AccessTrace> accessTrace; // Shared with the archives of the asset bundles
 };
 
 #endif //XEDITOR_PROJECT_HPP
@@ -35,12 +35,14 @@ struct ProjectSettings : public Messageable {
     std::vector<AssetBundle> assetBundles{}; // The asset bundles
     std::vector<BuildSettings> buildSettings; // The user created build settings.
     std::set<std::string> componentDirectories; // The list of directories that are scanned with the header tool
+    int derivedDataCacheSize = 1024; // The size limit of the cache of imported resources in megabytes
 
     Messageable &operator<<(const Message &message) override {
         message.value("name", name, std::string());
         message.value("assetBundles", assetBundles);
         message.value("buildSettings", buildSettings);
         message.value("componentDirectories", componentDirectories);
+        message.value("derivedDataCacheSize", derivedDataCacheSize, 1024);
         return *this;
     }
 
@@ -51,6 +53,7 @@ struct ProjectSettings : public Messageable {
         assetBundles >> message["assetBundles"];
         buildSettings >> message["buildSettings"];
         componentDirectories >> message["componentDirectories"];
+        derivedDataCacheSize >> message["derivedDataCacheSize"];
 
         return message;
     }
@@ -0,0 +1,180 @@
+/**
+ *  xEditor - Editor and tools for creating games
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "project/resourcereferences.hpp"
+
+#include <algorithm>
+
+static const std::string URI_SCHEME_SEPARATOR = "://";
+
+template<typename C, typename T>
+static void addReference(std::vector<ResourceReference> &references,
+                         const EntityHandle &entity,
+                         const C &,
+                         const ResourceHandle<T> &handle) {
+    auto uri = handle.getUri().toString();
+    if (!uri.empty()) {
+        references.emplace_back(ResourceReference{entity, typeid(C), std::move(uri)});
+    }
+}
+
+static void addReferences(std::vector<ResourceReference> &ret,
+                          const EntityHandle &entity,
+                          const SpriteComponent &component) {
+    addReference(ret, entity, component, component.sprite);
+}
+
+static void addReferences(std::vector<ResourceReference> &ret,
+                          const EntityHandle &entity,
+                          const SpriteAnimationComponent &component) {
+    addReference(ret, entity, component, component.animation);
+}
+
+static void addReferences(std::vector<ResourceReference> &ret,
+                          const EntityHandle &entity,
+                          const ButtonComponent &component) {
+    addReference(ret, entity, component, component.sprite);
+    addReference(ret, entity, component, component.spriteHover);
+    addReference(ret, entity, component, component.spritePressed);
+}
+
+static void addReferences(std::vector<ResourceReference> &ret,
+                          const EntityHandle &entity,
+                          const TextComponent &component) {
+    addReference(ret, entity, component, component.font);
+}
+
+static void addReferences(std::vector<ResourceReference> &ret,
+                          const EntityHandle &entity,
+                          const AudioSourceComponent &component) {
+    addReference(ret, entity, component, component.audio);
+}
+
+static void addReferences(std::vector<ResourceReference> &ret,
+                          const EntityHandle &entity,
+                          const SkinnedMeshComponent &component) {
+    addReference(ret, entity, component, component.mesh);
+}
+
+template<typename T>
+static void addPoolReferences(std::vector<ResourceReference> &ret, const EntityScene &scene) {
+    for (auto &pair: scene.getPool<T>()) {
+        addReferences(ret, pair.first, pair.second);
+    }
+}
+
+template<typename T>
+static void addEntityReferences(std::vector<ResourceReference> &ret,
+                                const EntityScene &scene,
+                                const EntityHandle &entity) {
+    if (scene.checkComponent<T>(entity))
+        addReferences(ret, entity, scene.getComponent<T>(entity));
+}
+
+std::vector<ResourceReference> getResourceReferences(const EntityScene &scene) {
+    std::vector<ResourceReference> ret;
+    addPoolReferences<SpriteComponent>(ret, scene);
+    addPoolReferences<SpriteAnimationComponent>(ret, scene);
+    addPoolReferences<ButtonComponent>(ret, scene);
+    addPoolReferences<TextComponent>(ret, scene);
+    addPoolReferences<AudioSourceComponent>(ret, scene);
+    addPoolReferences<SkinnedMeshComponent>(ret, scene);
+    return ret;
+}
+
+std::vector<ResourceReference> getResourceReferences(const EntityScene &scene, const EntityHandle &entity) {
+    std::vector<ResourceReference> ret;
+    addEntityReferences<SpriteComponent>(ret, scene, entity);
+    addEntityReferences<SpriteAnimationComponent>(ret, scene, entity);
+    addEntityReferences<ButtonComponent>(ret, scene, entity);
+    addEntityReferences<TextComponent>(ret, scene, entity);
+    addEntityReferences<AudioSourceComponent>(ret, scene, entity);
+    addEntityReferences<SkinnedMeshComponent>(ret, scene, entity);
+    return ret;
+}
+
+std::filesystem::path resolveResourceUri(const std::string &uri,
+                                         const std::map<std::string, std::filesystem::path> &archives,
+                                         bool requireScheme) {
+    if (uri.empty())
+        return {};
+
+    std::string scheme;
+    std::string path = uri;
+    auto separator = uri.find(URI_SCHEME_SEPARATOR);
+    if (separator != std::string::npos) {
+        scheme = uri.substr(0, separator);
+        path = uri.substr(separator + URI_SCHEME_SEPARATOR.size());
+    } else if (requireScheme) {
+        return {};
+    }
+
+    if (requireScheme && archives.find(scheme) == archives.end())
+        return {};
+
+    // Remove the asset name which follows the file path
+    auto assetSeparator = path.rfind(':');
+    if (assetSeparator != std::string::npos && path.find('/', assetSeparator) == std::string::npos) {
+        path = path.substr(0, assetSeparator);
+    }
+    while (!path.empty() && path.front() == '/') {
+        path.erase(0, 1);
+    }
+    if (path.empty())
+        return {};
+
+    // Uris without a scheme are looked up in every bundle
+    std::vector<std::filesystem::path> candidates;
+    if (scheme.empty()) {
+        for (auto &pair: archives) {
+            candidates.emplace_back(std::filesystem::path(pair.second).append(path).lexically_normal());
+        }
+    } else {
+        auto it = archives.find(scheme);
+        if (it != archives.end()) {
+            candidates.emplace_back(std::filesystem::path(it->second).append(path).lexically_normal());
+        }
+    }
+
+    for (auto &candidate: candidates) {
+        if (std::filesystem::is_regular_file(candidate))
+            return candidate;
+    }
+    return {};
+}
+
+std::vector<std::filesystem::path> listBundleFiles(const std::filesystem::path &directory) {
+    std::vector<std::filesystem::path> ret;
+    if (!std::filesystem::is_directory(directory))
+        return ret;
+    for (auto it = std::filesystem::recursive_directory_iterator(directory);
+         it != std::filesystem::recursive_directory_iterator();
+         it++) {
+        auto name = it->path().filename().string();
+        if (!name.empty() && name.front() == '.') {
+            if (it->is_directory())
+                it.disable_recursion_pending();
+            continue;
+        }
+        if (it->is_regular_file())
+            ret.emplace_back(it->path().lexically_normal());
+    }
+    std::sort(ret.begin(), ret.end());
+    return ret;
+}
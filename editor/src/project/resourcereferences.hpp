@@ -0,0 +1,76 @@
+/**
+ *  xEditor - Editor and tools for creating games
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XEDITOR_RESOURCEREFERENCES_HPP
+#define XEDITOR_RESOURCEREFERENCES_HPP
+
+#include <filesystem>
+#include <map>
+#include <string>
+#include <typeindex>
+#include <vector>
+
+#include "xng/xng.hpp"
+
+using namespace xng;
+
+/**
+ * A resource uri which is referenced by a built-in component.
+ */
+struct ResourceReference {
+    EntityHandle entity;
+    std::type_index component;
+    std::string uri;
+};
+
+/**
+ * @param scene
+ * @return The non empty resource uris referenced by the built-in components of the scene
+ */
+std::vector<ResourceReference> getResourceReferences(const EntityScene &scene);
+
+/**
+ * @param scene
+ * @param entity
+ * @return The non empty resource uris referenced by the built-in components of the entity
+ */
+std::vector<ResourceReference> getResourceReferences(const EntityScene &scene, const EntityHandle &entity);
+
+/**
+ * Resolve a resource uri to a file in the asset bundle directories.
+ *
+ * The asset name which follows the file path (eg. "scheme://model.fbx:mesh") is removed,
+ * uris without a scheme are looked up in every bundle.
+ *
+ * @param uri
+ * @param archives The bundle directories by the scheme under which they are accessible
+ * @param requireScheme If true only uris with the scheme of one of the archives are resolved
+ * @return The existing file or an empty path if the uri does not resolve
+ */
+std::filesystem::path resolveResourceUri(const std::string &uri,
+                                         const std::map<std::string, std::filesystem::path> &archives,
+                                         bool requireScheme);
+
+/**
+ * @param directory
+ * @return The sorted regular files in the directory, hidden files and directories are skipped
+ */
+std::vector<std::filesystem::path> listBundleFiles(const std::filesystem::path &directory);
+
+#endif //XEDITOR_RESOURCEREFERENCES_HPP
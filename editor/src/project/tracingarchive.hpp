@@ -0,0 +1,54 @@
+/**
+ *  xEditor - Editor and tools for creating games
+ *  Copyright (C) 2023  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XEDITOR_TRACINGARCHIVE_HPP
+#define XEDITOR_TRACINGARCHIVE_HPP
+
+#include <memory>
+#include <utility>
+
+#include "xng/io/archive.hpp"
+
+#include "project/accesstrace.hpp"
+
+/**
+ * Records the files which are opened through the wrapped archive in the access trace while it is recording.
+ */
+class TracingArchive : public xng::Archive {
+public:
+    TracingArchive(std::string scheme, std::shared_ptr<xng::Archive> archive, std::shared_ptr<AccessTrace> trace)
+            : scheme(std::move(scheme)), archive(std::move(archive)), trace(std::move(trace)) {}
+
+    std::unique_ptr<std::istream> open(const std::string &path) override {
+        auto ret = archive->open(path);
+        trace->record(scheme, path);
+        return ret;
+    }
+
+    bool exists(const std::string &path) override {
+        return archive->exists(path);
+    }
+
+private:
+    std::string scheme;
+    std::shared_ptr<xng::Archive> archive;
+    std::shared_ptr<AccessTrace> trace;
+};
+
+#endif //XEDITOR_TRACINGARCHIVE_HPP
@@ -98,8 +98,15 @@ public:
     }
 
     void setScene(const EntityScene &value) {
+        setScene(std::make_shared<EntityScene>(value));
+    }
+
+    /**
+     * @param value The scene which is rendered, must not be modified by the caller afterwards
+     */
+    void setScene(std::shared_ptr<EntityScene> value) {
         std::lock_guard<std::mutex> guard(mutex);
-        scene = std::make_shared<EntityScene>(value);
+        scene = std::move(value);
         sceneChanged = true;
     }
 
@@ -26,107 +26,7 @@
 #include <QSpinBox>
 
 #include "headertool/componentmetadata.hpp"
-
-/**
-* The list of supported types for XVARIABLE invocations
-*/
-enum VariableType {
-    // Fundamental Types
-    TYPE_CHAR,
-    TYPE_SHORT,
-    TYPE_INT,
-    TYPE_LONG,
-    TYPE_BOOL,
-    TYPE_FLOAT,
-    TYPE_DOUBLE,
-
-    // Standard Types
-    TYPE_STRING,
-
-    // Standard Containers
-    TYPE_VECTOR,
-    TYPE_MAP,
-
-    // xEngine Types
-    TYPE_RESOURCE_HANDLE,
-    TYPE_URI,
-    TYPE_ENTITY_NAME,
-
-    //      - Assets -
-    TYPE_AUDIO,
-    TYPE_COLOR,
-    TYPE_IMAGE,
-    TYPE_LIGHT,
-    TYPE_MATERIAL,
-    TYPE_MESH,
-    TYPE_SHADER,
-    TYPE_SKYBOX,
-    TYPE_SPRITE,
-    TYPE_TEXTURE,
-    TYPE_SPRITE_ANIMATION,
-
-    //      - Math -
-    TYPE_GRID,
-    TYPE_MATRIX,
-    TYPE_RECTANGLE,
-    TYPE_TRANSFORM,
-    TYPE_VECTOR2,
-    TYPE_VECTOR3,
-    TYPE_VECTOR4,
-};
-
-/**
- * The corresponding names for the supported types.
- * Only single word fundamental types are supported.
- * For standard types the full name space must be specified,
- * for xEngine types the xng:: namespace specification is optional.
- */
-const std::map<std::string, VariableType> typeNameMapping = {
-        {"char",                 TYPE_CHAR},
-        {"short",                TYPE_SHORT},
-        {"int",                  TYPE_INT},
-        {"long",                 TYPE_LONG},
-        {"bool",                 TYPE_BOOL},
-        {"float",                TYPE_FLOAT},
-        {"double",               TYPE_FLOAT},
-
-        {"std::string",          TYPE_STRING},
-
-        {"std::vector",          TYPE_VECTOR},
-        {"std::map",             TYPE_MAP},
-
-        {"ResourceHandle",       TYPE_RESOURCE_HANDLE},
-        {"xng::ResourceHandle",  TYPE_RESOURCE_HANDLE},
-        {"Uri",                  TYPE_URI},
-        {"xng::Uri",             TYPE_URI},
-        {"EntityName",           TYPE_ENTITY_NAME},
-        {"xng::EntityName",      TYPE_ENTITY_NAME},
-
-        {"Audio",                TYPE_AUDIO},
-        {"xng::Audio",           TYPE_AUDIO},
-        {"ColorRGBA",            TYPE_COLOR},
-        {"xng::ColorRGBA",       TYPE_COLOR},
-        {"ColorRGB",             TYPE_COLOR},
-        {"xng::ColorRGB",        TYPE_COLOR},
-        {"ImageRGBA",            TYPE_IMAGE},
-        {"xng::ImageRGBA",       TYPE_IMAGE},
-        {"Light",                TYPE_LIGHT},
-        {"xng::Light",           TYPE_LIGHT},
-        {"Material",             TYPE_MATERIAL},
-        {"xng::Material",        TYPE_MATERIAL},
-        {"Mesh",                 TYPE_MESH},
-        {"xng::Mesh",            TYPE_MESH},
-        {"Shader",               TYPE_SHADER},
-        {"xng::Shader",          TYPE_SHADER},
-        {"Skybox",               TYPE_SKYBOX},
-        {"xng::Skybox",          TYPE_SKYBOX},
-        {"Sprite",               TYPE_SPRITE},
-        {"xng::Sprite",          TYPE_SPRITE},
-        {"Texture",              TYPE_TEXTURE},
-        {"xng::Texture",         TYPE_TEXTURE},
-        {"SpriteAnimation",      TYPE_SPRITE_ANIMATION},
-        {"xng::SpriteAnimation", TYPE_SPRITE_ANIMATION},
-};
+#include "headertool/variabletype.hpp"
 
 class MemberWidget : public QWidget {
 Q_OBJECT
@@ -147,11 +147,14 @@ signals:
 
     void destroyComponent(const Entity &entity, const std::string &typeName);
 
+    void entitySelected(const Entity &entity);
+
 private slots:
 
     void selectEntity(Entity entity) {
         selectedEntity = entity;
         entityEditWidget->setEntity(selectedEntity, availableMetadata);
+        emit entitySelected(selectedEntity);
     }
 
     void destroyEntity() {
@@ -260,6 +263,7 @@ private slots:
             selectedEntity = xng::Entity(ent, *scene);
         }
         entityEditWidget->setEntity(selectedEntity, availableMetadata);
+        emit entitySelected(selectedEntity);
     }
 
     void contextMenuRequested(const QPoint &pos) {
@@ -27,10 +27,15 @@
 #include <QScrollArea>
 #include <QScrollBar>
 #include <QCoreApplication>
+#include <algorithm>
 #include <utility>
+#include <set>
 
 #include "render/offscreenrenderer.hpp"
 
+#include "io/importscheduler.hpp"
+#include "project/resourcereferences.hpp"
+
 class SceneRenderWidget : public QWidget {
 Q_OBJECT
 public:
@@ -64,8 +69,101 @@ public:
         });
     }
 
-    void setScene(const EntityScene &scene) {
-        ren.setScene(scene);
+    /**
+     * Render the scene and collect the resource references of all entities.
+     * Call after the scene was replaced or changed as a whole, single entity changes are passed to updateEntity.
+     *
+     * @param value The scene of the editor, the widget renders copies of it
+     */
+    void setScene(std::shared_ptr<const EntityScene> value) {
+        scene = std::move(value);
+        updateReferences();
+        render();
+    }
+
+    /**
+     * Update the resource references of the entity and render the scene.
+     *
+     * @param entity An entity which was created, changed or destroyed
+     */
+    void updateEntity(const EntityHandle &entity) {
+        if (importScheduler != nullptr && scene)
+            updateReferences(entity);
+        render();
+    }
+
+    /**
+     * Update the resource references of the entities and render the scene once.
+     */
+    void updateEntities(const std::vector<EntityHandle> &entities) {
+        if (importScheduler != nullptr && scene) {
+            for (auto &entity: entities) {
+                updateReferences(entity);
+            }
+        }
+        render();
+    }
+
+    /**
+     * Import the resources of the scene through the scheduler before they are rendered.
+     * Until the import of a file has finished the components which reference it are left out of the rendered scene
+     * so that the render thread does not wait for the import.
+     *
+     * @param scheduler The scheduler or null to render the scene with the resources loaded by the render thread
+     * @param bundleDirectories The asset bundle directories by scheme, used to resolve the resource uris
+     */
+    void setImportScheduler(ImportScheduler *scheduler, std::map<std::string, std::filesystem::path> bundleDirectories) {
+        for (auto &pair: imports) {
+            pair.second.request.cancel();
+        }
+        imports.clear();
+        importScheduler = scheduler;
+        archives = std::move(bundleDirectories);
+        updateReferences();
+        render();
+    }
+
+    /**
+     * Render the components which were waiting for the import of the file.
+     *
+     * @param file
+     */
+    void importFinished(const std::filesystem::path &file) {
+        auto it = imports.find(file);
+        if (it == imports.end() || !it->second.request.isReady())
+            return;
+        auto changed = false;
+        for (auto &component: it->second.components) {
+            if (placeholders.find(component) != placeholders.end() && isReady(component)) {
+                placeholders.erase(component);
+                changed = true;
+            }
+        }
+        if (changed)
+            render();
+    }
+
+    /**
+     * Import the files again before the components which reference them are rendered.
+     *
+     * @param files
+     */
+    void reimport(const std::set<std::filesystem::path> &files) {
+        auto changed = false;
+        for (auto &file: files) {
+            auto it = imports.find(file.lexically_normal());
+            if (it == imports.end())
+                continue;
+            it->second.request.cancel();
+            it->second.request = importScheduler->schedule(it->first, ImportScheduler::PRIORITY_VIEWPORT);
+            if (it->second.request.isReady())
+                continue;
+            for (auto &component: it->second.components) {
+                changed |= placeholders.insert(component).second;
+            }
+        }
+        if (changed)
+            render();
     }
 
     void shutdown() {
@@ -94,6 +192,146 @@ protected:
     }
 
 private:
+    typedef std::pair<EntityHandle, std::type_index> ComponentKey;
+
+    struct EntityReference {
+        std::type_index component;
+        std::string uri;
+        std::filesystem::path file;
+    };
+
+    struct FileImport {
+        ImportScheduler::Request request;
+        std::set<ComponentKey> components; // The components which reference the file
+    };
+
+    /**
+     * Render a copy of the scene without the components which are waiting for an import.
+     */
+    void render() {
+        if (!scene)
+            return;
+        auto renderScene = std::make_shared<EntityScene>(*scene);
+        for (auto &placeholder: placeholders) {
+            if (renderScene->checkComponent(placeholder.first, placeholder.second))
+                renderScene->destroyComponent(placeholder.first, placeholder.second);
+        }
+        ren.setScene(std::move(renderScene));
+    }
+
+    /**
+     * Collect the references of all entities of the scene, the imports of files which are still referenced are kept.
+     */
+    void updateReferences() {
+        auto previous = std::move(imports);
+        imports.clear();
+        entityReferences.clear();
+        placeholders.clear();
+        if (importScheduler != nullptr && scene) {
+            std::map<std::string, std::filesystem::path> resolved; // Many components reference the same uris
+            for (auto &reference: getResourceReferences(*scene)) {
+                auto resolvedIt = resolved.find(reference.uri);
+                if (resolvedIt == resolved.end()) {
+                    resolvedIt = resolved.emplace(reference.uri,
+                                                  resolveResourceUri(reference.uri, archives, false)).first;
+                }
+                auto &file = resolvedIt->second;
+                if (file.empty())
+                    continue;
+                entityReferences[reference.entity].push_back({reference.component, reference.uri, file});
+                auto it = imports.find(file);
+                if (it == imports.end()) {
+                    auto previousImport = previous.find(file);
+                    if (previousImport != previous.end()) {
+                        it = imports.emplace(file, std::move(previousImport->second)).first;
+                        previous.erase(previousImport);
+                        it->second.components.clear();
+                    } else {
+                        it = imports.emplace(file, FileImport{
+                                importScheduler->schedule(file, ImportScheduler::PRIORITY_VIEWPORT), {}}).first;
+                    }
+                }
+                addReference(it->second, {reference.entity, reference.component});
+            }
+        }
+        // Imports of files which are no longer referenced by the scene
+        for (auto &pair: previous) {
+            pair.second.request.cancel();
+        }
+    }
+
+    /**
+     * Replace the references of the entity, only the uris which changed are resolved again.
+     */
+    void updateReferences(const EntityHandle &entity) {
+        std::vector<EntityReference> previous;
+        auto it = entityReferences.find(entity);
+        if (it != entityReferences.end()) {
+            previous = std::move(it->second);
+            entityReferences.erase(it);
+        }
+
+        std::vector<EntityReference> references;
+        for (auto &reference: getResourceReferences(*scene, entity)) {
+            auto match = std::find_if(previous.begin(), previous.end(), [&reference](const EntityReference &v) {
+                return v.component == reference.component && v.uri == reference.uri;
+            });
+            auto file = match != previous.end()
+                        ? match->file
+                        : resolveResourceUri(reference.uri, archives, false);
+            if (!file.empty())
+                references.push_back({reference.component, reference.uri, file});
+        }
+
+        // Drop the previous references before adding the new ones so that unchanged imports are not cancelled
+        for (auto &reference: previous) {
+            auto import = imports.find(reference.file);
+            if (import != imports.end())
+                import->second.components.erase({entity, reference.component});
+            placeholders.erase({entity, reference.component});
+        }
+        if (!references.empty())
+            entityReferences[entity] = references;
+        for (auto &reference: references) {
+            auto import = imports.find(reference.file);
+            if (import == imports.end()) {
+                import = imports.emplace(reference.file, FileImport{
+                        importScheduler->schedule(reference.file, ImportScheduler::PRIORITY_VIEWPORT), {}}).first;
+            }
+            addReference(import->second, {entity, reference.component});
+        }
+        for (auto &reference: previous) {
+            auto import = imports.find(reference.file);
+            if (import != imports.end() && import->second.components.empty()) {
+                import->second.request.cancel();
+                imports.erase(import);
+            }
+        }
+    }
+
+    void addReference(FileImport &import, const ComponentKey &component) {
+        import.components.insert(component);
+        if (!import.request.isReady())
+            placeholders.insert(component);
+    }
+
+    /**
+     * @return True if all files which are referenced by the component have been imported
+     */
+    bool isReady(const ComponentKey &component) const {
+        auto it = entityReferences.find(component.first);
+        if (it == entityReferences.end())
+            return true;
+        for (auto &reference: it->second) {
+            if (reference.component != component.second)
+                continue;
+            auto import = imports.find(reference.file);
+            if (import != imports.end() && !import->second.request.isReady())
+                return false;
+        }
+        return true;
+    }
+
     Vec2i getSize() {
         return convert(size());
     }
@@ -103,6 +341,15 @@ private:
     }
 
     OffscreenRenderer ren;
+
+    std::shared_ptr<const EntityScene> scene;
+
+    ImportScheduler *importScheduler = nullptr;
+    std::map<std::string, std::filesystem::path> archives;
+    std::map<std::filesystem::path, FileImport> imports; // The viewport requests by file
+    std::map<EntityHandle, std::vector<EntityReference>> entityReferences;
+    std::set<ComponentKey> placeholders; // The components which are left out of the rendered scene
+
     QScrollArea *scroll;
     QLabel *label;
 };
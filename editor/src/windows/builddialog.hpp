@@ -110,6 +110,13 @@ public:
         return project;
     }
 
+    /**
+     * Set the metadata of the generic components which is used to find the assets referenced by scenes when packaging.
+     */
+    void setComponentMetadata(const std::map<std::string, ComponentMetadata> &value) {
+        componentMetadata = value;
+    }
+
 signals:
 
     void pluginChanged(const std::filesystem::path &pluginFile);
@@ -168,9 +175,15 @@ private slots:
         getCurrentSettings().buildTarget(project.getProjectDirectory(), output, error);
         if (!error.empty()) {
             QMessageBox::warning(this, "Failed to build game", error.c_str());
-        } else {
-            QMessageBox::information(this, "Build successful", "Successfully built the game");
+            return;
+        }
+        try {
+            project.compile(getCurrentSettings(), componentMetadata);
+        } catch (const std::exception &e) {
+            QMessageBox::warning(this, "Failed to package asset bundles", e.what());
+            return;
         }
+        QMessageBox::information(this, "Build successful", "Successfully built the game");
     }
 
     void settingsChanged(const BuildSettings &settings) {
@@ -222,6 +235,7 @@ private:
     QPushButton *buildGameButton;
 
     Project project;
+    std::map<std::string, ComponentMetadata> componentMetadata;
     int currentSettingsIndex;
 };
 
@@ -27,6 +27,7 @@
 #include <QFileDialog>
 #include <QApplication>
 #include <QStatusBar>
+#include <QPushButton>
 
 #include <fstream>
 
@@ -34,16 +35,80 @@
 #include "windows/builddialog.hpp"
 
 #include "io/paths.hpp"
+#include "io/cachingimporter.hpp"
+#include "io/scenefile.hpp"
+#include "io/scenestreamreader.hpp"
+#include "io/lazyscene.hpp"
+
+#include "project/resourcereferences.hpp"
 
 #include "xng/driver/assimp/assimpimporter.hpp"
 #include "xng/driver/sndfile/sndfileimporter.hpp"
 
-#include "headertool/tokenizer.hpp"
-#include "headertool/headerparser.hpp"
-#include "headertool/headergenerator.hpp"
+#include "headertool/headerscanner.hpp"
+#include "headertool/metadatablob.hpp"
 
 using namespace xng;
 
+// Indexed by SceneFile::Format
+static const QStringList SCENE_SAVE_FILTERS = {"JSON Scene (*.json)", "Binary Scene (*.xscene)"};
+static const QStringList SCENE_OPEN_FILTERS = {"Scene Files (*.json *.xscene)", "All Files (*)"};
+
+static const char *ENTITIES_MEMBER = "entities";
+
+// The time spent materializing entities of a lazily loaded scene per event loop iteration
+static const std::chrono::milliseconds MATERIALIZE_BUDGET(8);
+// The number of materialized batches after which the render widget receives a copy of the scene
+static const size_t MATERIALIZE_RENDER_INTERVAL = 30;
+
+// The combined size of the prefetched source files is limited to this fraction of the derived data cache size
+static const uint64_t PREFETCH_CACHE_FRACTION = 4;
+
+/**
+ * @return The members of the scene message except the entities list
+ */
+static Message getSceneProperties(const Message &scene) {
+    std::map<std::string, Message> members;
+    if (scene.getType() == Message::DICTIONARY) {
+        members = scene.asDictionary();
+    }
+    members.erase(ENTITIES_MEMBER);
+    return Message(members);
+}
+
+static Message getDefaultSceneProperties() {
+    EntityScene scene;
+    Message msg;
+    scene >> msg;
+    return getSceneProperties(msg);
+}
+
+static std::vector<uint64_t> getEntityIds(const std::vector<EntityHandle> &entities) {
+    std::vector<uint64_t> ret;
+    ret.reserve(entities.size());
+    for (auto &entity: entities) {
+        ret.emplace_back(entity.id);
+    }
+    return ret;
+}
+
+/**
+ * @param format Set to the format of the selected extension or name filter
+ * @return The selected file of a scene save dialog with the extension of the format appended if it has none
+ */
+static std::filesystem::path getSelectedSceneFile(const QFileDialog &dialog, SceneFile::Format &format) {
+    auto path = std::filesystem::path(dialog.selectedFiles().at(0).toStdString());
+    if (path.has_extension()) {
+        format = SceneFile::getFormatFromExtension(path);
+    } else {
+        format = dialog.selectedNameFilter() == SCENE_SAVE_FILTERS.at(SceneFile::FORMAT_BINARY)
+                 ? SceneFile::FORMAT_BINARY
+                 : SceneFile::FORMAT_JSON;
+        path += SceneFile::getExtension(format);
+    }
+    return path;
+}
+
 EditorWindow::Actions::Actions(QWidget *parent) {
     settingsAction = new QAction("Settings...", parent);
     exitAction = new QAction("Exit", parent);
@@ -68,14 +133,19 @@ EditorWindow::Actions::Actions(QWidget *parent) {
 
     buildProjectAction = new QAction("Build Project...", parent);
 
+    buildAccessTraceAction = new QAction("Record Asset Access Trace", parent);
+    buildAccessTraceAction->setCheckable(true);
+
     buildMenu = new QMenu("Build", parent);
     buildMenu->addAction(buildProjectAction);
+    buildMenu->addAction(buildAccessTraceAction);
 
     sceneNewAction = new QAction("New Scene...", parent);
     sceneOpenAction = new QAction("Open Scene...", parent);
     sceneSaveAsAction = new QAction("Save Scene As...", parent);
     sceneSaveAction = new QAction("Save Scene", parent);
     sceneCloseAction = new QAction("Close Scene", parent);
+    sceneConvertAction = new QAction("Convert Scene File...", parent);
 
     sceneMenu = new QMenu("Scene", parent);
     sceneMenu->addAction(sceneNewAction);
@@ -83,6 +153,8 @@ EditorWindow::Actions::Actions(QWidget *parent) {
     sceneMenu->addAction(sceneSaveAsAction);
     sceneMenu->addAction(sceneSaveAction);
     sceneMenu->addAction(sceneCloseAction);
+    sceneMenu->addSeparator();
+    sceneMenu->addAction(sceneConvertAction);
 
     projectSaveAction->setShortcut(QKeySequence::Save);
     buildProjectAction->setShortcut(QKeySequence(Qt::CTRL + Qt::Key_B));
@@ -94,6 +166,7 @@ EditorWindow::EditorWindow() : QMainWindow(),
     buildDialog->setProject(project);
 
     scene = std::make_shared<EntityScene>();
+    sceneProperties = getDefaultSceneProperties();
 
     scene->addListener(*this);
 
@@ -178,6 +251,10 @@ EditorWindow::EditorWindow() : QMainWindow(),
             SIGNAL(destroyComponent(const Entity &, const std::string&)),
             this,
             SLOT(destroyComponent(const Entity &, const std::string&)));
+    connect(sceneEditWidget,
+            SIGNAL(entitySelected(const Entity &)),
+            this,
+            SLOT(entitySelected(const Entity &)));
 
     connect(actions.settingsAction,
             SIGNAL(triggered(bool)),
@@ -220,12 +297,20 @@ EditorWindow::EditorWindow() : QMainWindow(),
             SIGNAL(triggered(bool)),
             this,
             SLOT(saveSceneAs()));
+    connect(actions.sceneConvertAction,
+            SIGNAL(triggered(bool)),
+            this,
+            SLOT(convertSceneFile()));
 
 
     connect(actions.buildProjectAction,
             SIGNAL(triggered(bool)),
             this,
             SLOT(buildProject()));
+    connect(actions.buildAccessTraceAction,
+            SIGNAL(triggered(bool)),
+            this,
+            SLOT(recordAccessTrace(bool)));
 
     connect(fileBrowserWidget,
             SIGNAL(openPath(const std::filesystem::path &)),
@@ -255,15 +340,49 @@ EditorWindow::EditorWindow() : QMainWindow(),
 
     updateActions();
 
-    std::vector<std::unique_ptr<ResourceImporter>> importers;
-    importers.emplace_back(std::make_unique<StbiImporter>());
-    importers.emplace_back(std::make_unique<JsonImporter>());
-    importers.emplace_back(std::make_unique<AssImpImporter>());
-    importers.emplace_back(std::make_unique<SndFileImporter>());
-    ResourceRegistry::getDefaultRegistry().setImporters(std::move(importers));
+    derivedDataCache = std::make_shared<DerivedDataCache>();
+    ResourceRegistry::getDefaultRegistry().setImporters(createImporters());
+
+    // The workers of the scheduler share the importers like the loading threads of the registry
+    for (auto &importer: createImporters()) {
+        if (dynamic_cast<CachingImporter *>(importer.get()) != nullptr) {
+            const auto &formats = importer->getSupportedFormats();
+            scheduledFormats.insert(formats.begin(), formats.end());
+            scheduledImporters.emplace_back(std::move(importer));
+        }
+    }
+
+    importScheduler.start([this](const std::filesystem::path &file) {
+                              importFile(file);
+                          },
+                          [this](const std::filesystem::path &file) {
+                              QMetaObject::invokeMethod(this,
+                                                        [this, file]() {
+                                                            sceneRenderWidget->importFinished(file);
+                                                        },
+                                                        Qt::QueuedConnection);
+                          });
 
     statusBar()->show();
 
+    scanProgressTimer = new QTimer(this);
+    scanProgressTimer->setInterval(100);
+    connect(scanProgressTimer, SIGNAL(timeout()), this, SLOT(updateScanProgress()));
+
+    scanCancelButton = new QPushButton("Cancel Scan", this);
+    scanCancelButton->hide();
+    statusBar()->addPermanentWidget(scanCancelButton);
+    connect(scanCancelButton, SIGNAL(clicked(bool)), this, SLOT(cancelComponentScan()));
+
+    journalTimer = new QTimer(this);
+    journalTimer->setInterval(1000);
+    connect(journalTimer, SIGNAL(timeout()), this, SLOT(flushSceneJournal()));
+    journalTimer->start();
+
+    materializeTimer = new QTimer(this);
+    materializeTimer->setInterval(0);
+    connect(materializeTimer, SIGNAL(timeout()), this, SLOT(materializePendingEntities()));
+
     connect(QGuiApplication::instance(),
             SIGNAL(applicationStateChanged(Qt::ApplicationState)),
             this,
@@ -271,10 +390,19 @@ EditorWindow::EditorWindow() : QMainWindow(),
 }
 
 EditorWindow::~EditorWindow() {
+    fileWatcher.stop();
+    stopComponentScan();
+    sceneRenderWidget->setImportScheduler(nullptr, {});
+    importScheduler.stop();
+    if (saveThread.joinable())
+        saveThread.join();
+    flushSceneJournal();
+    resetSceneJournal();
+    resetLazyScene();
     // Wait for scene render widget shutdown and unset scene because there might be components in the current scene which's destructors are defined in the loaded plugin library and will be called after the library is unloaded.
     sceneRenderWidget->shutdown();
     scene = std::make_shared<EntityScene>();
-    sceneRenderWidget->setScene(*scene);
+    sceneRenderWidget->setScene(scene);
     sceneEditWidget->setScene(scene);
     unloadPlugin();
 }
@@ -483,11 +611,19 @@ void EditorWindow::newScene() {
     }
 
     scenePath = "";
+    sceneFormat = SceneFile::FORMAT_JSON;
+    resetSceneJournal();
+    resetLazyScene();
+    journalSuspended = true;
     scene->clear();
+    journalSuspended = false;
+    sceneProperties = getDefaultSceneProperties();
+    entityMessages.clear();
 
     setSceneSaved(true);
 
-    sceneRenderWidget->setScene(*scene);
+    sceneRenderWidget->setScene(scene);
+    prefetchImports();
 }
 
 void EditorWindow::openScene() {
@@ -501,7 +637,7 @@ void EditorWindow::openScene() {
     dialog.setAcceptMode(QFileDialog::AcceptOpen);
     dialog.setFileMode(QFileDialog::AnyFile);
     dialog.setDirectory(project.getProjectDirectory().string().c_str());
-    dialog.setMimeTypeFilters({"application/json"});
+    dialog.setNameFilters(SCENE_OPEN_FILTERS);
 
     if (dialog.exec() == QFileDialog::Accepted) {
         auto &file = dialog.selectedFiles().at(0);
@@ -516,46 +652,354 @@ bool EditorWindow::saveScene() {
         dialog.setAcceptMode(QFileDialog::AcceptSave);
         dialog.setFileMode(QFileDialog::AnyFile);
         dialog.setDirectory(project.getProjectDirectory().string().c_str());
-        dialog.setMimeTypeFilters({"application/json"});
+        dialog.setNameFilters(SCENE_SAVE_FILTERS);
+        dialog.selectNameFilter(SCENE_SAVE_FILTERS.at(sceneFormat));
 
         if (dialog.exec() == QFileDialog::Accepted) {
-            auto &file = dialog.selectedFiles().at(0);
-            scenePath = std::filesystem::path(file.toStdString());
+            scenePath = getSelectedSceneFile(dialog, sceneFormat);
         } else {
             return false;
         }
     }
-    if (!scenePath.has_extension()) {
-        scenePath = scenePath.parent_path().append(scenePath.filename().string() + ".json");
+    startSceneSave();
+    return true;
+}
+
+void EditorWindow::startSceneSave() {
+    if (saveThread.joinable()) {
+        sceneSaveQueued = true;
+        return;
+    }
+    sceneSaveQueued = false;
+
+    // The snapshot must contain the components which have not been read from the scene file yet
+    if (!materializeScene())
+        return;
+
+    // The journal records up to the snapshot are compacted into the saved file when the save finishes
+    flushSceneJournal();
+    if (!sceneJournal.isOpen()) {
+        journalCreated.clear();
+        journalModified.clear();
+        journalDestroyed.clear();
+    }
+    savingJournalMark = sceneJournal.getSize();
+
+    // The journal ids are taken from the list of the written entities so that they match the saved file
+    std::vector<EntityHandle> entities(sceneEntities.begin(), sceneEntities.end());
+    savingSceneEntities = getEntityIds(entities);
+
+    // Only the entities modified since they were last serialized are serialized here,
+    // the save thread shares the messages of the other entities
+    std::vector<std::shared_ptr<const Message>> snapshot;
+    snapshot.reserve(entities.size());
+    for (auto &entity: entities) {
+        auto &message = entityMessages[entity];
+        if (!message)
+            message = std::make_shared<const Message>(scene->serializeEntity(entity));
+        snapshot.emplace_back(message);
+    }
+    auto properties = sceneProperties;
+    auto path = scenePath;
+    auto format = sceneFormat;
+    auto generation = saveGeneration;
+    auto error = std::make_shared<std::string>();
+
+    savingScenePath = path;
+    savingSceneRevision = sceneRevision;
+    sceneSaveError = error;
+
+    statusBar()->showMessage("Saving scene to " + QString(path.string().c_str()));
+    saveThread = std::thread([this, snapshot, properties, path, format, generation, error]() {
+        try {
+            std::vector<Message> list;
+            list.reserve(snapshot.size());
+            for (auto &entity: snapshot) {
+                list.emplace_back(*entity);
+            }
+            auto members = properties.asDictionary();
+            members[ENTITIES_MEMBER] = Message(list);
+            SceneFile::write(path, Message(members), format);
+        } catch (const std::exception &e) {
+            *error = e.what();
+        }
+        QMetaObject::invokeMethod(this,
+                                  [this, generation]() {
+                                      finishSceneSave(generation);
+                                  },
+                                  Qt::QueuedConnection);
+    });
+}
+
+bool EditorWindow::finishSceneSave(size_t generation) {
+    if (generation != saveGeneration || !saveThread.joinable())
+        return true; // The save was already finished by waitForSceneSave()
+
+    saveThread.join();
+    saveGeneration++;
+
+    auto success = sceneSaveError->empty();
+    if (success) {
+        // Modifications made while the save was running are not contained in the saved file
+        if (savingScenePath == scenePath && savingSceneRevision == sceneRevision)
+            setSceneSaved(true);
+        statusBar()->showMessage("Saved scene at " + QString(savingScenePath.string().c_str()));
+        if (savingScenePath == scenePath) {
+            try {
+                if (sceneJournal.isOpen())
+                    sceneJournal.compact(savingScenePath, savingSceneEntities, savingJournalMark);
+                else
+                    sceneJournal.start(savingScenePath, savingSceneEntities);
+            } catch (const std::exception &e) {
+                resetSceneJournal();
+                QMessageBox::warning(this,
+                                     "Scene journal failed",
+                                     QString("Unsaved scene changes are not journaled. Error: ") + e.what());
+            }
+        }
+    } else {
+        statusBar()->clearMessage();
+        QMessageBox::warning(this,
+                             "Scene save failed",
+                             ("Failed to save scene at " + QString(savingScenePath.string().c_str())
+                              + " Error: " + sceneSaveError->c_str()));
+    }
+
+    if (sceneSaveQueued)
+        startSceneSave();
+
+    return success;
+}
+
+bool EditorWindow::waitForSceneSave() {
+    auto success = true;
+    while (saveThread.joinable()) {
+        success = finishSceneSave(saveGeneration);
+    }
+    return success;
+}
+
+void EditorWindow::flushSceneJournal() {
+    if (!sceneJournal.isOpen())
+        return;
+    // Update records contain the whole entity
+    auto modified = journalModified;
+    for (auto &entity: modified) {
+        if (!materializeEntity(entity))
+            return;
+    }
+    try {
+        for (auto &entity: journalDestroyed) {
+            sceneJournal.appendDestroy(entity.id);
+        }
+        // The messages are kept for the next save
+        for (auto &entity: journalCreated) {
+            auto message = std::make_shared<const Message>(scene->serializeEntity(entity));
+            sceneJournal.appendCreate(entity.id, *message);
+            entityMessages[entity] = message;
+        }
+        for (auto &entity: journalModified) {
+            auto message = std::make_shared<const Message>(scene->serializeEntity(entity));
+            sceneJournal.appendUpdate(entity.id, *message);
+            entityMessages[entity] = message;
+        }
+        journalCreated.clear();
+        journalModified.clear();
+        journalDestroyed.clear();
+        sceneJournal.sync();
+    } catch (const std::exception &e) {
+        resetSceneJournal();
+        QMessageBox::warning(this,
+                             "Scene journal failed",
+                             QString("Unsaved scene changes are no longer journaled. Error: ") + e.what());
+    }
+}
+
+void EditorWindow::resetSceneJournal() {
+    journalCreated.clear();
+    journalModified.clear();
+    journalDestroyed.clear();
+    try {
+        sceneJournal.close();
+    } catch (const std::exception &) {
+        // The records which could not be written are lost
+    }
+}
+
+void EditorWindow::journalEntityModified(const EntityHandle &entity) {
+    // Created entities are serialized with their current state when the journal is flushed
+    if (journalSuspended || journalCreated.find(entity) != journalCreated.end())
+        return;
+    journalModified.insert(entity);
+}
+
+bool EditorWindow::materializeEntity(const EntityHandle &entity) {
+    if (!lazyScene || lazyScene->isMaterialized(entity))
+        return true;
+    try {
+        materializing = true;
+        lazyScene->materialize(*scene, entity);
+        materializing = false;
+    } catch (const std::exception &e) {
+        materializing = false;
+        abortLazyScene(e);
+        return false;
     }
-    Message msg;
-    *scene >> msg;
-    auto p = JsonProtocol();
-    std::ofstream fs(scenePath.string());
-    p.serialize(fs, msg);
-    setSceneSaved(true);
     return true;
 }
 
+bool EditorWindow::materializeScene() {
+    if (!lazyScene)
+        return true;
+    try {
+        materializing = true;
+        lazyScene->materializeAll(*scene);
+        materializing = false;
+    } catch (const std::exception &e) {
+        materializing = false;
+        abortLazyScene(e);
+        return false;
+    }
+    resetLazyScene();
+    sceneRenderWidget->setScene(scene);
+    prefetchImports();
+    return true;
+}
+
+void EditorWindow::materializePendingEntities() {
+    if (!lazyScene) {
+        materializeTimer->stop();
+        return;
+    }
+    try {
+        materializing = true;
+        auto entities = lazyScene->materialize(*scene, MATERIALIZE_BUDGET);
+        materializing = false;
+        materializedEntities.insert(materializedEntities.end(), entities.begin(), entities.end());
+    } catch (const std::exception &e) {
+        materializing = false;
+        abortLazyScene(e);
+        return;
+    }
+    // Copying the scene for the render widget after every batch would take longer than materializing it
+    if (lazyScene->isComplete()) {
+        resetLazyScene();
+        sceneRenderWidget->setScene(scene);
+        prefetchImports();
+        statusBar()->showMessage("Loaded all entities of " + QString(scenePath.string().c_str()));
+    } else if (++materializeBatches % MATERIALIZE_RENDER_INTERVAL == 0) {
+        sceneRenderWidget->updateEntities(materializedEntities);
+        materializedEntities.clear();
+    }
+}
+
+void EditorWindow::resetLazyScene() {
+    materializeTimer->stop();
+    materializeBatches = 0;
+    materializedEntities.clear();
+    lazyScene.reset();
+}
+
+void EditorWindow::abortLazyScene(const std::exception &e) {
+    // The journal is closed without flushing, the flushed changes can be recovered when the scene is opened again
+    auto path = scenePath;
+    resetLazyScene();
+    resetSceneJournal();
+    journalSuspended = true;
+    scene->clear();
+    journalSuspended = false;
+    sceneProperties = getDefaultSceneProperties();
+    entityMessages.clear();
+    scenePath = "";
+    setSceneSaved(true);
+    sceneRenderWidget->setScene(scene);
+    prefetchImports();
+    QMessageBox::warning(this,
+                         "Scene load failed",
+                         "Failed to read the components of the scene at " + QString(path.string().c_str())
+                         + ", the scene was closed. Error: " + e.what());
+}
+
 void EditorWindow::saveSceneAs() {
     QFileDialog dialog;
     dialog.setWindowTitle("Select scene output file...");
     dialog.setAcceptMode(QFileDialog::AcceptSave);
     dialog.setFileMode(QFileDialog::AnyFile);
     dialog.setDirectory(project.getProjectDirectory().string().c_str());
-    dialog.setMimeTypeFilters({"application/json"});
+    dialog.setNameFilters(SCENE_SAVE_FILTERS);
+    dialog.selectNameFilter(SCENE_SAVE_FILTERS.at(sceneFormat));
 
     if (dialog.exec() == QFileDialog::Accepted) {
-        auto &file = dialog.selectedFiles().at(0);
-        scenePath = std::filesystem::path(file.toStdString());
+        scenePath = getSelectedSceneFile(dialog, sceneFormat);
         saveScene();
     }
 }
 
+void EditorWindow::convertSceneFile() {
+    QFileDialog inputDialog;
+    inputDialog.setWindowTitle("Select scene file to convert...");
+    inputDialog.setAcceptMode(QFileDialog::AcceptOpen);
+    inputDialog.setFileMode(QFileDialog::ExistingFile);
+    inputDialog.setDirectory(project.getProjectDirectory().string().c_str());
+    inputDialog.setNameFilters(SCENE_OPEN_FILTERS);
+    if (inputDialog.exec() != QFileDialog::Accepted)
+        return;
+
+    auto input = std::filesystem::path(inputDialog.selectedFiles().at(0).toStdString());
+
+#ifndef XEDITOR_DEBUGGING
+    try {
+#endif
+    auto format = SceneFile::detectFormat(input) == SceneFile::FORMAT_JSON
+                  ? SceneFile::FORMAT_BINARY
+                  : SceneFile::FORMAT_JSON;
+
+    QFileDialog outputDialog;
+    outputDialog.setWindowTitle("Select converted scene output file...");
+    outputDialog.setAcceptMode(QFileDialog::AcceptSave);
+    outputDialog.setFileMode(QFileDialog::AnyFile);
+    outputDialog.setDirectory(input.parent_path().string().c_str());
+    outputDialog.setNameFilters(SCENE_SAVE_FILTERS);
+    outputDialog.selectNameFilter(SCENE_SAVE_FILTERS.at(format));
+    outputDialog.selectFile((input.stem().string() + SceneFile::getExtension(format)).c_str());
+    if (outputDialog.exec() != QFileDialog::Accepted)
+        return;
+
+    auto output = getSelectedSceneFile(outputDialog, format);
+    SceneFile::convert(input, output, format);
+    statusBar()->showMessage("Converted scene " + QString(input.string().c_str())
+                             + " to " + QString(output.string().c_str()));
+#ifndef XEDITOR_DEBUGGING
+    } catch (const std::exception &e) {
+        QMessageBox::warning(this,
+                             "Scene conversion failed",
+                             ("Failed to convert scene at " + QString(input.string().c_str()) + " Error: " + e.what()));
+    }
+#endif
+}
+
 void EditorWindow::buildProject() {
     buildDialog->show();
 }
 
+void EditorWindow::recordAccessTrace(bool record) {
+    try {
+        if (record) {
+            project.startAccessTrace();
+            // The renderer receives a new copy of the scene so that the resources of the scene are opened while recording
+            sceneRenderWidget->setScene(scene);
+            statusBar()->showMessage("Recording asset access trace...");
+        } else {
+            auto count = project.stopAccessTrace();
+            statusBar()->showMessage("Recorded " + QString::number(count) + " asset accesses to "
+                                     + QString(project.getAccessTraceFilePath().string().c_str()));
+        }
+    } catch (const std::exception &e) {
+        QMessageBox::warning(this, "Asset access trace failed", e.what());
+    }
+    updateActions();
+}
+
 void EditorWindow::shutdown() {
     checkUnsavedSceneChanges();
     saveStateFile();
@@ -613,16 +1057,95 @@ void EditorWindow::loadScene(const std::filesystem::path &path) {
 #endif
     statusBar()->showMessage("Opening scene at " + QString(path.string().c_str()));
     QApplication::processEvents();
-    auto prot = JsonProtocol();
-    std::ifstream fs(path.string());
+
+    SceneJournal::Recovery recovery;
+    auto recovered = false;
+    if (SceneJournal::canRecover(path)
+        && QMessageBox::question(this,
+                                 "Recover Scene",
+                                 "The scene at " + QString(path.string().c_str())
+                                 + " contains unsaved changes from a previous session, do you want to recover them?")
+           == QMessageBox::Yes) {
+        try {
+            recovery = SceneJournal::recover(path);
+            recovered = true;
+        } catch (const std::exception &e) {
+            QMessageBox::warning(this,
+                                 "Scene recovery failed",
+                                 QString("Failed to recover the unsaved scene changes. Error: ") + e.what());
+        }
+    }
+
+    resetSceneJournal();
+    resetLazyScene();
+    journalSuspended = true;
     scene->clear();
-    *scene << prot.deserialize(fs);
+
+    std::unique_ptr<LazyScene> lazy;
+    if (!recovered && SceneFile::detectFormat(path) == SceneFile::FORMAT_BINARY) {
+        lazy = std::make_unique<LazyScene>(path);
+        if (!lazy->isSupported())
+            lazy.reset();
+    }
+
+    // The listener side effects are skipped while loading, the render widget receives the scene once afterwards
+    materializing = true;
+    Message properties;
+    std::vector<EntityHandle> entities; // The loaded entities in the order of the entities list of the file
+    if (recovered) {
+        properties = getSceneProperties(recovery.scene);
+        auto members = properties.asDictionary();
+        members[ENTITIES_MEMBER] = Message(std::vector<Message>());
+        *scene << Message(members);
+        for (auto &entity: recovery.scene[ENTITIES_MEMBER].asList()) {
+            entities.emplace_back(scene->deserializeEntity(entity));
+        }
+        sceneFormat = SceneFile::detectFormat(path);
+    } else if (lazy) {
+        // The hierarchy is created from the entity index, the other components are read when they are needed
+        properties = lazy->readProperties();
+        entities = lazy->populate(*scene);
+        sceneFormat = SceneFile::FORMAT_BINARY;
+        if (!lazy->isComplete()) {
+            lazyScene = std::move(lazy);
+            materializeTimer->start();
+        }
+    } else {
+        // The entities are inserted one at a time so that the message of the whole scene is never held in memory
+        SceneStreamReader reader(path);
+        properties = getSceneProperties(reader.getProperties());
+        *scene << reader.getProperties();
+        Message entity;
+        while (reader.next(entity)) {
+            entities.emplace_back(scene->deserializeEntity(entity));
+        }
+        sceneFormat = reader.getFormat();
+    }
+    materializing = false;
+    journalSuspended = false;
+    sceneProperties = properties;
+    entityMessages.clear();
     scenePath = path;
-    setSceneSaved(true);
-    sceneRenderWidget->setScene(*scene);
+    setSceneSaved(!recovered);
+    sceneRenderWidget->setScene(scene);
+    prefetchImports();
     statusBar()->showMessage("Opened scene at " + QString(path.string().c_str()));
+
+    try {
+        if (recovered)
+            sceneJournal.resume(path, recovery.entities, getEntityIds(entities));
+        else
+            sceneJournal.start(path, getEntityIds(entities));
+    } catch (const std::exception &e) {
+        resetSceneJournal();
+        QMessageBox::warning(this,
+                             "Scene journal failed",
+                             QString("Unsaved scene changes are not journaled. Error: ") + e.what());
+    }
 #ifndef XEDITOR_DEBUGGING
     } catch (const std::exception &e) {
+        journalSuspended = false;
+        materializing = false;
         QMessageBox::warning(this,
                              "Scene load failed",
                              ("Failed to load scene at " + QString(path.string().c_str()) + " Error: " + e.what()));
@@ -635,10 +1158,24 @@ void EditorWindow::loadProject(const std::filesystem::path &path) {
         QMessageBox::information(this, "Aborted", "The operation was cancelled.");
         return;
     }
+    fileWatcher.stop();
+    stopComponentScan();
+    headerIndexComplete = false;
+    pendingHeaderChanges = {};
+    resetSceneJournal();
+    resetLazyScene();
+    journalSuspended = true;
     scene->clear();
+    journalSuspended = false;
+    sceneProperties = getDefaultSceneProperties();
+    entityMessages.clear();
     setSceneSaved(true);
     try {
         project.load(path.parent_path());
+        derivedDataCache->setSizeLimit(getDerivedDataCacheSizeLimit());
+        derivedDataCache->open(project.getDerivedDataDirectory());
+        sceneRenderWidget->setImportScheduler(&importScheduler, project.getBundleDirectories());
+        prefetchImports();
         setWindowTitle(QString(project.getSettings().name.c_str()) + " - " + QString(path.string().c_str()));
         buildDialog->setProject(project);
         setProjectSaved(true);
@@ -649,7 +1186,9 @@ void EditorWindow::loadProject(const std::filesystem::path &path) {
             loadPlugin(pluginFile);
         }
         actions.buildProjectAction->setEnabled(true);
+        headerIndex.load(project.getHeaderIndexFilePath());
         scanComponentHeaders();
+        startFileWatcher();
         statusBar()->showMessage(("Opened project at " + path.string()).c_str());
     } catch (const std::exception &e) {
         QMessageBox::warning(this,
@@ -660,13 +1199,18 @@ void EditorWindow::loadProject(const std::filesystem::path &path) {
 }
 
 bool EditorWindow::checkUnsavedSceneChanges() {
+    // The scene is only discarded after the running save has finished, a failed save leaves the scene unsaved
+    waitForSceneSave();
     if (!sceneSaved) {
         if (QMessageBox::question(this,
                                   "Unsaved Scene Changes",
                                   "Your scene contains unsaved changes that are going to be discarded, do you want to save them now?")
             == QMessageBox::Yes) {
-            return saveScene();
+            return saveScene() && waitForSceneSave();
         }
+        // The discarded changes are not offered for recovery
+        sceneJournal.discard();
+        resetSceneJournal();
     }
     return true;
 }
@@ -753,6 +1297,8 @@ void EditorWindow::setProjectSaved(bool saved) {
 
 void EditorWindow::setSceneSaved(bool saved) {
     sceneSaved = saved;
+    if (!saved)
+        sceneRevision++;
     updateActions();
     updateTitle();
 }
@@ -778,64 +1324,175 @@ void EditorWindow::updateTitle() {
 void EditorWindow::updateActions() {
     actions.projectSaveAction->setEnabled(project.isLoaded() && (!sceneSaved || !projectSaved));
     actions.sceneSaveAction->setEnabled(!sceneSaved && !scenePath.empty());
+    actions.buildAccessTraceAction->setEnabled(project.isLoaded());
+    actions.buildAccessTraceAction->setChecked(project.isTracingAccess());
 }
 
 void EditorWindow::scanComponentHeaders() {
-    if (project.isLoaded()) {
-        for (auto &dir: project.getSourceDirectories()) {
-            auto scanCount = 0;
-            auto compCount = 0;
+    if (!project.isLoaded() || scanThread.joinable())
+        return;
+
+    statusBar()->showMessage("Scanning for components...");
+    scanCancelButton->show();
+    scanProgressTimer->start();
+
+    auto directories = project.getSourceDirectories();
+    auto indexPath = project.getHeaderIndexFilePath();
+    auto generation = scanGeneration;
+    auto metadata = pluginMetadata;
+    auto metadataTime = pluginWriteTime;
+    auto changes = std::make_shared<FileWatcher::Changes>(std::move(pendingHeaderChanges));
+    auto incremental = headerIndexComplete && !changes->overflow;
+    pendingHeaderChanges = {};
+    scanThread = std::thread([this, directories, indexPath, generation, metadata, metadataTime, changes, incremental]() {
+        // The metadata exported by the plugin is used as long as no source file was modified after the plugin was built
+        if (!incremental && metadata && !HeaderScanner::containsNewerFiles(directories, metadataTime)) {
+            auto result = std::make_shared<HeaderScanner::Result>();
+            for (auto &component: *metadata) {
+                result->metadata[component.typeName] = component;
+            }
+            result->componentCount = metadata->size();
+            QMetaObject::invokeMethod(this,
+                                      [this, generation, result]() {
+                                          finishComponentScan(generation, *result, true);
+                                      },
+                                      Qt::QueuedConnection);
+            return;
+        }
+        auto result = std::make_shared<HeaderScanner::Result>(
+                incremental
+                ? headerScanner.scanChanges(changes->modified, changes->removed, headerIndex)
+                : headerScanner.scan(directories, headerIndex));
+        if (!result->cancelled && headerIndex.isModified()) {
             try {
-                for (auto &dirEntry: std::filesystem::recursive_directory_iterator(dir)) {
-                    if (dirEntry.is_directory())
-                        continue;
-                    scanCount++;
-                    statusBar()->showMessage(("Scanning " + dirEntry.path().string() + " for components...").c_str());
-                    Tokenizer tokenizer;
-                    HeaderParser parser;
-                    HeaderGenerator generator;
-                    try {
-                        std::fstream stream;
-                        stream.exceptions(std::fstream::badbit);
-                        stream.open(dirEntry.path());
-                        auto tokens = tokenizer.tokenize(stream);
-                        auto metadataList = parser.parseTokens(
-                                dirEntry.path().filename().string(),
-                                tokens);
-                        if (!metadataList.empty()) {
-                            for (auto &metadata: metadataList) {
-                                availableMetadata[metadata.typeName] = metadata;
-                                auto generatedHeader = generator.generateHeader(metadata);
-                                if (!generatedHeader.empty()) {
-                                    auto generatedPath = dirEntry.path().parent_path()
-                                            .append(Paths::generatedHeaderFileName(
-                                                    dirEntry.path().filename()).string());
-                                    std::fstream ofs;
-                                    ofs.exceptions(std::fstream::badbit);
-                                    ofs.open(generatedPath, std::fstream::out);
-                                    ofs << generatedHeader.c_str();
-                                    ofs.flush();
-                                    ofs.close();
-                                }
-                                compCount++;
-                            }
-                            sceneEditWidget->setAvailableComponentMetadata(availableMetadata);
-                        }
-                    } catch (const std::exception &e) {
-                        QMessageBox::warning(this, "Failed to scan file", ("Failed to scan "
-                                                                           + dirEntry.path().string()
-                                                                           + " Error:\n"
-                                                                           + e.what()).c_str());
-                    }
-                }
-                statusBar()->showMessage(("Scanned "
-                                          + std::to_string(scanCount)
-                                          + " files for components, Found "
-                                          + std::to_string(compCount)
-                                          + " Components").c_str());
-            } catch (const std::exception &e) {}
+                headerIndex.save(indexPath);
+            } catch (const std::exception &e) {
+                result->errors.emplace_back(indexPath, e.what());
+            }
         }
+        QMetaObject::invokeMethod(this,
+                                  [this, generation, result]() {
+                                      finishComponentScan(generation, *result, false);
+                                  },
+                                  Qt::QueuedConnection);
+    });
+}
+
+void EditorWindow::cancelComponentScan() {
+    headerScanner.cancel();
+}
+
+void EditorWindow::updateScanProgress() {
+    statusBar()->showMessage(("Scanning for components... "
+                              + std::to_string(headerScanner.getProcessedFiles())
+                              + "/"
+                              + std::to_string(headerScanner.getTotalFiles())
+                              + " changed files").c_str());
+}
+
+void EditorWindow::stopComponentScan() {
+    if (scanThread.joinable()) {
+        headerScanner.cancel();
+        scanThread.join();
     }
+    scanGeneration++;
+    scanProgressTimer->stop();
+    scanCancelButton->hide();
+}
+
+void EditorWindow::finishComponentScan(size_t generation, const HeaderScanner::Result &result, bool fromPlugin) {
+    if (generation != scanGeneration)
+        return; // The scan was stopped and joined by stopComponentScan()
+
+    scanThread.join();
+    scanProgressTimer->stop();
+    scanCancelButton->hide();
+
+    if (result.cancelled) {
+        // The index may be missing changes of the cancelled scan, the next scan walks all source directories
+        headerIndexComplete = false;
+        statusBar()->showMessage("Component scan cancelled");
+        return;
+    }
+
+    if (!fromPlugin) {
+        headerIndexComplete = true;
+    }
+
+    availableMetadata = result.metadata;
+    sceneEditWidget->setAvailableComponentMetadata(availableMetadata);
+    buildDialog->setComponentMetadata(availableMetadata);
+
+    if (!result.errors.empty()) {
+        std::string text;
+        for (auto &error: result.errors) {
+            text += "Failed to scan " + error.first.string() + " Error:\n" + error.second + "\n";
+        }
+        QMessageBox::warning(this, "Failed to scan files", text.c_str());
+    }
+
+    if (fromPlugin) {
+        statusBar()->showMessage(("Loaded "
+                                  + std::to_string(result.componentCount)
+                                  + " Components from plugin").c_str());
+    } else {
+        statusBar()->showMessage(("Scanned "
+                                  + std::to_string(result.fileCount)
+                                  + " files for components ("
+                                  + std::to_string(result.parsedCount)
+                                  + " parsed), Found "
+                                  + std::to_string(result.componentCount)
+                                  + " Components").c_str());
+    }
+
+    if (!pendingHeaderChanges.empty()) {
+        // Headers were changed while the scan was running
+        scanComponentHeaders();
+    }
+}
+
+void EditorWindow::startFileWatcher() {
+    auto directories = project.getSourceDirectories();
+    auto assetDirectories = project.getAssetDirectories();
+    directories.insert(assetDirectories.begin(), assetDirectories.end());
+    auto generation = ++watchGeneration;
+    try {
+        fileWatcher.start(directories, [this, generation](const FileWatcher::Changes &changes) {
+            QMetaObject::invokeMethod(this,
+                                      [this, generation, changes]() {
+                                          projectFilesChanged(generation, changes);
+                                      },
+                                      Qt::QueuedConnection);
+        });
+    } catch (const std::exception &e) {
+        // Without the watcher the source directories are scanned when the editor window is activated
+        statusBar()->showMessage((std::string("Failed to watch project files: ") + e.what()).c_str());
+    }
+}
+
+void EditorWindow::projectFilesChanged(size_t generation, const FileWatcher::Changes &changes) {
+    if (generation != watchGeneration)
+        return; // Queued before the watcher was restarted
+
+    auto sourceChanges = changes.filter(project.getSourceDirectories());
+    if (!sourceChanges.empty()) {
+        pendingHeaderChanges.merge(sourceChanges);
+        scanComponentHeaders();
+    }
+
+    auto assetChanges = changes.filter(project.getAssetDirectories());
+    if (!assetChanges.empty()) {
+        projectAssetsChanged(assetChanges);
+    }
+}
+
+void EditorWindow::projectAssetsChanged(const FileWatcher::Changes &changes) {
+    // The renderer receives a new copy of the scene so that the resources of the scene are loaded again.
+    sceneRenderWidget->reimport(changes.modified);
+    sceneRenderWidget->setScene(scene);
+    statusBar()->showMessage(("Reloaded "
+                              + std::to_string(changes.modified.size() + changes.removed.size())
+                              + " changed assets").c_str());
 }
 
 void EditorWindow::closeEvent(QCloseEvent *event) {
@@ -864,6 +1521,12 @@ void EditorWindow::openPath(const std::filesystem::path &path) {
                 loadScene(path);
             }
         }
+    } else if (SceneFile::getFormatFromExtension(path) == SceneFile::FORMAT_BINARY) {
+        if (QMessageBox::question(this, "Open Scene",
+                                  "Do you want to open the scene at: " + QString(path.string().c_str()) + " ?")
+            == QMessageBox::Yes) {
+            loadScene(path);
+        }
     } else {
         QMessageBox::information(this, "Unrecognized file",
                                  "Could not determine how to open the file at " + QString(path.string().c_str()));
@@ -899,10 +1562,26 @@ void EditorWindow::loadPlugin(const std::filesystem::path &pluginFile) {
                                  "Function not found",
                                  "load() function was not found in the plugin library.");
         }
+        auto metadataFunc = pluginLibrary->getSymbol<MetadataBlob::ExportFunction>(MetadataBlob::SYMBOL_NAME);
+        if (metadataFunc) {
+            try {
+                size_t size = 0;
+                auto data = metadataFunc(&size);
+                pluginMetadata = std::make_shared<const std::vector<ComponentMetadata>>(
+                        MetadataBlob::deserialize(std::string_view(reinterpret_cast<const char *>(data), size)));
+                pluginWriteTime = std::filesystem::last_write_time(pluginFile);
+            } catch (const std::exception &e) {
+                // Plugins built by another version of the editor fall back to scanning the sources
+                pluginMetadata = nullptr;
+            }
+        }
     }
 }
 
 void EditorWindow::unloadPlugin() {
+    // The scene snapshot of a running save may contain components defined in the plugin library
+    waitForSceneSave();
+    pluginMetadata = nullptr;
     if (!pluginLibrary)
         return;
     void (*unloadFunc)() = pluginLibrary->getSymbol<void()>("unload");
@@ -918,6 +1597,105 @@ void EditorWindow::unloadPlugin() {
 void EditorWindow::buildDialogChanged(const Project &value) {
     setProjectSaved(false);
     project = value;
+    if (project.isLoaded()) {
+        derivedDataCache->setSizeLimit(getDerivedDataCacheSizeLimit());
+        sceneRenderWidget->setImportScheduler(&importScheduler, project.getBundleDirectories());
+        // The source or asset directories might have changed
+        pendingHeaderChanges.overflow = true;
+        scanComponentHeaders();
+        startFileWatcher();
+    }
+}
+
+std::vector<std::unique_ptr<ResourceImporter>> EditorWindow::createImporters() const {
+    // The json importer is not cached because scenes and json bundles are edited in the editor and cheap to parse
+    std::vector<std::unique_ptr<ResourceImporter>> ret;
+    ret.emplace_back(std::make_unique<CachingImporter>(std::make_unique<StbiImporter>(),
+                                                       "stbi",
+                                                       1,
+                                                       derivedDataCache));
+    ret.emplace_back(std::make_unique<JsonImporter>());
+    ret.emplace_back(std::make_unique<CachingImporter>(std::make_unique<AssImpImporter>(),
+                                                       "assimp",
+                                                       1,
+                                                       derivedDataCache));
+    ret.emplace_back(std::make_unique<CachingImporter>(std::make_unique<SndFileImporter>(),
+                                                       "sndfile",
+                                                       1,
+                                                       derivedDataCache));
+    return ret;
+}
+
+void EditorWindow::importFile(const std::filesystem::path &file) const {
+    auto hint = file.extension().string();
+    // Only the cached imports are worth running ahead of the render thread
+    for (auto &importer: scheduledImporters) {
+        const auto &formats = importer->getSupportedFormats();
+        if (formats.find(hint) == formats.end())
+            continue;
+        std::ifstream stream(file, std::ifstream::binary);
+        if (!stream)
+            throw std::runtime_error("Failed to open " + file.string());
+        importer->read(stream, hint, file.string(), nullptr);
+        return;
+    }
+}
+
+void EditorWindow::prefetchImports() {
+    for (auto &request: prefetchRequests) {
+        request.cancel();
+    }
+    prefetchRequests.clear();
+    if (!project.isLoaded())
+        return;
+
+    // The imported data is usually larger than the source files, the prefetched files are limited to a fraction
+    // of the cache so that they do not evict the entries which are used by the viewport
+    auto budget = getDerivedDataCacheSizeLimit() / PREFETCH_CACHE_FRACTION;
+    auto archives = project.getBundleDirectories();
+    std::set<std::filesystem::path> files;
+    uint64_t size = 0;
+    for (auto &reference: getResourceReferences(*scene)) {
+        auto file = resolveResourceUri(reference.uri, archives, false);
+        if (file.empty()
+            || scheduledFormats.find(file.extension().string()) == scheduledFormats.end()
+            || !files.insert(file).second)
+            continue;
+        std::error_code error;
+        auto fileSize = std::filesystem::file_size(file, error);
+        if (error)
+            continue;
+        if (size + fileSize > budget)
+            break;
+        size += fileSize;
+        prefetchRequests.emplace_back(importScheduler.schedule(file, ImportScheduler::PRIORITY_PREFETCH));
+    }
+}
+
+void EditorWindow::entitySelected(const Entity &entity) {
+    for (auto &request: inspectorRequests) {
+        request.cancel();
+    }
+    inspectorRequests.clear();
+    if (entity && lazyScene && !lazyScene->isMaterialized(entity.getHandle())) {
+        // The components of the entity are read from the scene file when it is selected for the first time
+        if (!materializeEntity(entity.getHandle()))
+            return;
+        sceneRenderWidget->updateEntity(entity.getHandle());
+    }
+    if (!entity || !project.isLoaded())
+        return;
+    auto archives = project.getBundleDirectories();
+    for (auto &reference: getResourceReferences(*scene, entity.getHandle())) {
+        auto file = resolveResourceUri(reference.uri, archives, false);
+        if (!file.empty())
+            inspectorRequests.emplace_back(importScheduler.schedule(file, ImportScheduler::PRIORITY_INSPECTOR));
+    }
+}
+
+uint64_t EditorWindow::getDerivedDataCacheSizeLimit() const {
+    auto megabytes = std::max(0, project.getSettings().derivedDataCacheSize);
+    return static_cast<uint64_t>(megabytes) * 1024 * 1024;
 }
 
 void EditorWindow::applicationStateChanged(Qt::ApplicationState state) {
@@ -929,42 +1707,73 @@ void EditorWindow::applicationStateChanged(Qt::ApplicationState state) {
         case Qt::ApplicationInactive:
             break;
         case Qt::ApplicationActive:
-            scanComponentHeaders();
+            // Changes are reported by the file watcher, only scan on activation if it could not be started
+            if (project.isLoaded() && !fileWatcher.isRunning())
+                scanComponentHeaders();
             break;
     }
 }
 
 void EditorWindow::onEntityCreate(const EntityHandle &entity) {
+    sceneEntities.insert(entity);
+    entityMessages.erase(entity);
+    if (materializing)
+        return;
+    if (!journalSuspended)
+        journalCreated.insert(entity);
     setSceneSaved(false);
-    sceneRenderWidget->setScene(*scene);
+    sceneRenderWidget->updateEntity(entity);
 }
 
 void EditorWindow::onEntityDestroy(const EntityHandle &entity) {
+    sceneEntities.erase(entity);
+    entityMessages.erase(entity);
+    if (lazyScene)
+        lazyScene->remove(entity);
+    if (!journalSuspended) {
+        journalModified.erase(entity);
+        if (journalCreated.erase(entity) == 0)
+            journalDestroyed.insert(entity);
+    }
     setSceneSaved(false);
-    sceneRenderWidget->setScene(*scene);
+    sceneRenderWidget->updateEntity(entity);
 }
 
 void EditorWindow::onEntityNameChanged(const EntityHandle &entity,
                                        const std::string &newName,
                                        const std::string &oldName) {
+    entityMessages.erase(entity);
+    if (materializing)
+        return;
+    journalEntityModified(entity);
     setSceneSaved(false);
-    sceneRenderWidget->setScene(*scene);
+    sceneRenderWidget->updateEntity(entity);
 }
 
 void EditorWindow::onComponentCreate(const EntityHandle &entity,
                                      const Component &component) {
+    entityMessages.erase(entity);
+    if (materializing)
+        return;
+    journalEntityModified(entity);
     setSceneSaved(false);
-    sceneRenderWidget->setScene(*scene);
+    sceneRenderWidget->updateEntity(entity);
 }
 
 void EditorWindow::onComponentDestroy(const EntityHandle &entity, const Component &component) {
+    entityMessages.erase(entity);
+    journalEntityModified(entity);
     setSceneSaved(false);
-    sceneRenderWidget->setScene(*scene);
+    sceneRenderWidget->updateEntity(entity);
 }
 
 void EditorWindow::onComponentUpdate(const EntityHandle &entity,
                                      const Component &oldComponent,
                                      const Component &newComponent) {
+    entityMessages.erase(entity);
+    if (materializing)
+        return;
+    journalEntityModified(entity);
     setSceneSaved(false);
-    sceneRenderWidget->setScene(*scene);
+    sceneRenderWidget->updateEntity(entity);
 }
@@ -26,6 +26,12 @@
 #include <QSplitter>
 #include <QTimer>
 #include <QTabWidget>
+#include <QPushButton>
+
+#include <map>
+#include <memory>
+#include <set>
+#include <thread>
 
 #include "xng/xng.hpp"
 
@@ -38,6 +44,16 @@
 
 #include "project/project.hpp"
 
+#include "io/filewatcher.hpp"
+#include "io/deriveddatacache.hpp"
+#include "io/importscheduler.hpp"
+#include "io/scenefile.hpp"
+#include "io/scenejournal.hpp"
+#include "io/lazyscene.hpp"
+
+#include "headertool/headerindex.hpp"
+#include "headertool/headerscanner.hpp"
+
 class EditorWindow : public QMainWindow, EntityScene::Listener {
 Q_OBJECT
 public:
@@ -54,6 +70,7 @@ public:
 
         QMenu *buildMenu;
         QAction *buildProjectAction;
+        QAction *buildAccessTraceAction;
 
         QMenu *sceneMenu;
         QAction *sceneNewAction;
@@ -61,6 +78,7 @@ public:
         QAction *sceneSaveAsAction;
         QAction *sceneSaveAction;
         QAction *sceneCloseAction;
+        QAction *sceneConvertAction;
 
         explicit Actions(QWidget *parent = nullptr);
     };
@@ -111,8 +129,14 @@ protected slots:
 
     void saveSceneAs();
 
+    void convertSceneFile();
+
     void buildProject();
 
+    void recordAccessTrace(bool record);
+
+    void entitySelected(const Entity &entity);
+
     void shutdown();
 
     void closeEvent(QCloseEvent *event) override;
@@ -131,6 +155,20 @@ protected slots:
 
     void applicationStateChanged(Qt::ApplicationState state);
 
+    void cancelComponentScan();
+
+    void updateScanProgress();
+
+    /**
+     * Append the entity modifications since the last flush to the scene journal and sync it to disk.
+     */
+    void flushSceneJournal();
+
+    /**
+     * Materialize the next batch of entities of a lazily loaded scene.
+     */
+    void materializePendingEntities();
+
 private:
     void onEntityCreate(const EntityHandle &entity) override;
 
@@ -173,12 +211,115 @@ private:
 
     void setSceneSaved(bool saved);
 
+    /**
+     * Write a copy of the scene to the scene path on a background thread, editing continues on the original scene.
+     *
+     * If a save is already running the scene is saved again when it finishes.
+     */
+    void startSceneSave();
+
+    /**
+     * Join the save thread and report its result, starts the queued save if there is one.
+     *
+     * @param generation The save generation at the start of the save, stale completions are ignored
+     * @return False if the save failed
+     */
+    bool finishSceneSave(size_t generation);
+
+    /**
+     * Block until the running and queued scene saves have finished.
+     *
+     * @return False if the last save failed
+     */
+    bool waitForSceneSave();
+
+    /**
+     * Close the scene journal and forget the modifications which were not flushed.
+     */
+    void resetSceneJournal();
+
+    /**
+     * Record an entity modification for the next journal flush.
+     */
+    void journalEntityModified(const EntityHandle &entity);
+
+    /**
+     * Create the remaining components of an entity of a lazily loaded scene.
+     *
+     * @return False if the components could not be read and the scene was closed
+     */
+    bool materializeEntity(const EntityHandle &entity);
+
+    /**
+     * Materialize all remaining entities of a lazily loaded scene.
+     *
+     * @return False if the components could not be read and the scene was closed
+     */
+    bool materializeScene();
+
+    void resetLazyScene();
+
+    /**
+     * Close a scene whose components could not be materialized, saving it would drop the missing components.
+     */
+    void abortLazyScene(const std::exception &e);
+
     void updateTitle();
 
     void updateActions();
 
+    /**
+     * Start scanning the source directories for components on a background thread.
+     *
+     * If the header index is complete only the pending changed headers are scanned.
+     * If a scan is already running the pending changes are scanned when it finishes.
+     */
     void scanComponentHeaders();
 
+    /**
+     * Cancel and join the running scan, its results are discarded.
+     */
+    void stopComponentScan();
+
+    /**
+     * @param fromPlugin True if the metadata was read from the plugin instead of scanning the sources
+     */
+    void finishComponentScan(size_t generation, const HeaderScanner::Result &result, bool fromPlugin);
+
+    /**
+     * Watch the source and asset directories of the project, replaces the previous watch.
+     */
+    void startFileWatcher();
+
+    /**
+     * Dispatch the changed paths reported by the file watcher to the header scanner and the viewport.
+     */
+    void projectFilesChanged(size_t generation, const FileWatcher::Changes &changes);
+
+    /**
+     * @return The size limit of the derived data cache in bytes from the project settings
+     */
+    uint64_t getDerivedDataCacheSizeLimit() const;
+
+    void projectAssetsChanged(const FileWatcher::Changes &changes);
+
+    /**
+     * @return The importers of the default registry, the imports of assets other than json files are cached
+     */
+    std::vector<std::unique_ptr<ResourceImporter>> createImporters() const;
+
+    /**
+     * Import the file with the cached importers to store the result in the derived data cache,
+     * called on the workers of the import scheduler.
+     */
+    void importFile(const std::filesystem::path &file) const;
+
+    /**
+     * Queue the import of the files referenced by the open scene in the background,
+     * replaces the previously queued imports.
+     */
+    void prefetchImports();
+
     QWidget *rootWidget;
     QHBoxLayout *rootLayout;
 
@@ -193,11 +334,39 @@ private:
     QTabWidget *tabWidget;
 
     std::filesystem::path scenePath;
+    SceneFile::Format sceneFormat = SceneFile::FORMAT_JSON;
 
     std::shared_ptr<xng::EntityScene> scene;
+    xng::Message sceneProperties; // The members of the scene message except the entities list, written when saving
 
     bool sceneSaved = true;
     bool projectSaved = true;
+    uint64_t sceneRevision = 0; // Incremented on every scene modification
+
+    std::thread saveThread;
+    size_t saveGeneration = 0;
+    bool sceneSaveQueued = false;
+    std::filesystem::path savingScenePath;
+    uint64_t savingSceneRevision = 0;
+    std::shared_ptr<std::string> sceneSaveError; // Written by the save thread, empty if the save succeeded
+    uint64_t savingJournalMark = 0;
+    std::vector<uint64_t> savingSceneEntities;
+    // The serialized entities shared with the save thread, an entity is removed when it is modified
+    std::map<EntityHandle, std::shared_ptr<const xng::Message>> entityMessages;
+
+    SceneJournal sceneJournal;
+    QTimer *journalTimer;
+    bool journalSuspended = false; // True while scenes are loaded or cleared
+    std::set<EntityHandle> sceneEntities;
+    std::set<EntityHandle> journalCreated;
+    std::set<EntityHandle> journalModified;
+    std::set<EntityHandle> journalDestroyed;
+
+    std::unique_ptr<LazyScene> lazyScene; // Set while not all entities of the loaded scene have been materialized
+    QTimer *materializeTimer;
+    bool materializing = false; // True while scenes are loaded or entities are materialized from the lazy scene
+    size_t materializeBatches = 0;
+    std::vector<EntityHandle> materializedEntities; // Materialized since the render widget was last updated
 
     Actions actions;
 
@@ -209,9 +378,34 @@ private:
 
     std::unique_ptr<Library> pluginLibrary;
 
+    // The component metadata exported by the loaded plugin or null if the plugin does not export metadata
+    std::shared_ptr<const std::vector<ComponentMetadata>> pluginMetadata;
+    std::filesystem::file_time_type pluginWriteTime;
+
     BuildDialog *buildDialog;
 
     std::map<std::string, ComponentMetadata> availableMetadata;
+
+    HeaderIndex headerIndex; // Only accessed by the scan thread while a scan is running
+    HeaderScanner headerScanner;
+    std::thread scanThread;
+    size_t scanGeneration = 0;
+    bool headerIndexComplete = false; // True if the header index contains all headers of the source directories
+    FileWatcher::Changes pendingHeaderChanges; // The changed headers which have not been scanned yet
+
+    FileWatcher fileWatcher;
+    size_t watchGeneration = 0;
+
+    std::shared_ptr<DerivedDataCache> derivedDataCache; // Shared with the caching importers of the default registry
+
+    ImportScheduler importScheduler;
+    std::vector<ImportScheduler::Request> inspectorRequests; // The imports of the resources of the selected entity
+    std::vector<ImportScheduler::Request> prefetchRequests;
+    std::vector<std::unique_ptr<ResourceImporter>> scheduledImporters; // The cached importers used by importFile
+    std::set<std::string> scheduledFormats;
+
+    QTimer *scanProgressTimer;
+    QPushButton *scanCancelButton;
 };
 
 #endif //XEDITOR_EDITORWINDOW_HPP